@@ -0,0 +1,158 @@
+/**
+ * @file bench_kernels.cpp
+ * @brief Throughput of the precision-templated kernels, float against double.
+ *
+ * Each kernel runs over the same column of points in both precisions; the best of several
+ * repetitions is reported as nanoseconds per point together with the float speedup.
+ * Build with -DBUILD_BENCHMARKS=ON in a Release configuration and run bench_kernels [points].
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+#include "mathieu_lib/characteristic.h"
+#include "mathieu_lib/mathieu.h"
+#include "mathieu_lib/pseudopotential.h"
+#include "mathieu_lib/space_charge.h"
+#include "mathieu_lib/stability.h"
+
+namespace {
+
+constexpr int REPEATS = 15;
+
+// Best-of-REPEATS wall time per point, in nanoseconds
+auto time_per_point(std::size_t points, const std::function<void()>& kernel) -> double {
+    double best = 1e300;
+    for (int r = 0; r < REPEATS; ++r) {
+        const auto start = std::chrono::steady_clock::now();
+        kernel();
+        const std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count() / static_cast<double>(points));
+    }
+    return best;
+}
+
+template <typename Real>
+struct Columns {
+    std::vector<Real> mz, q, a;
+    std::vector<std::uint8_t> stable;
+    std::vector<mathieu_lib::StabilityClass> classes;
+
+    explicit Columns(std::size_t n) : mz(n), q(n), a(n), stable(n), classes(n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            mz[i] = static_cast<Real>(50.0 + 4950.0 * static_cast<double>(i) / n);
+            q[i] = static_cast<Real>(0.95 * static_cast<double>((i * 7919) % n) / n);
+            a[i] = static_cast<Real>(0.25 * static_cast<double>((i * 104729) % n) / n);
+        }
+    }
+};
+
+void report(const char* name, double ns_double, double ns_float) {
+    std::printf("%-26s %10.3f %10.3f %8.2fx\n", name, ns_double, ns_float, ns_double / ns_float);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : (1u << 20);
+    if (n == 0) {
+        std::fprintf(stderr, "Usage: bench_kernels [points]\n");
+        return 1;
+    }
+    const mathieu_lib::QuadrupoleParams params(1.1e6, 0.005, 0.0);
+    Columns<double> d(n);
+    Columns<float> f(n);
+    volatile double sink = 0.0;  // keeps the scalar loops from being optimized away
+
+    std::printf("%zu points, ns/point (best of %d)\n", n, REPEATS);
+    std::printf("%-26s %10s %10s %9s\n", "kernel", "double", "float", "speedup");
+
+    report("mathieu_q_from_mz",
+           time_per_point(n, [&]() { mathieu_lib::mathieu_q_from_mz(750.0, params, d.mz.data(), n,
+                                                                    d.q.data()); }),
+           time_per_point(n, [&]() { mathieu_lib::mathieu_q_from_mz(750.0, params, f.mz.data(), n,
+                                                                    f.q.data()); }));
+
+    report("is_stable (batch)",
+           time_per_point(n, [&]() {
+               mathieu_lib::is_stable(d.q.data(), d.a.data(), n, d.stable.data());
+           }),
+           time_per_point(n, [&]() {
+               mathieu_lib::is_stable(f.q.data(), f.a.data(), n, f.stable.data());
+           }));
+
+    report("classify_stability (batch)",
+           time_per_point(n, [&]() {
+               mathieu_lib::classify_stability(d.q.data(), d.a.data(), n, d.classes.data());
+           }),
+           time_per_point(n, [&]() {
+               mathieu_lib::classify_stability(f.q.data(), f.a.data(), n, f.classes.data());
+           }));
+
+    report("is_stable (Paul trap)",
+           time_per_point(n, [&]() {
+               mathieu_lib::is_stable<double, mathieu_lib::PaulTrap3D>(d.q.data(), d.a.data(), n,
+                                                                       d.stable.data());
+           }),
+           time_per_point(n, [&]() {
+               mathieu_lib::is_stable<float, mathieu_lib::PaulTrap3D>(f.q.data(), f.a.data(), n,
+                                                                      f.stable.data());
+           }));
+
+    report("well_depth_from_mz",
+           time_per_point(n, [&]() {
+               mathieu_lib::well_depth_from_mz(750.0, 20.0, params, d.mz.data(), n, d.a.data());
+           }),
+           time_per_point(n, [&]() {
+               mathieu_lib::well_depth_from_mz(750.0, 20.0, params, f.mz.data(), n, f.a.data());
+           }));
+
+    mathieu_lib::IonCloud cloud;
+    cloud.ions = 1e7;
+    const mathieu_lib::SpaceChargeGradient gradient = mathieu_lib::space_charge_gradient(cloud);
+    report("classify_space_charge",
+           time_per_point(n, [&]() {
+               mathieu_lib::classify_space_charge_from_mz(750.0, 20.0, params, gradient,
+                                                          d.mz.data(), n, d.classes.data());
+           }),
+           time_per_point(n, [&]() {
+               mathieu_lib::classify_space_charge_from_mz(750.0, 20.0, params, gradient,
+                                                          f.mz.data(), n, f.classes.data());
+           }));
+
+    report("upper_boundary (scalar)",
+           time_per_point(n, [&]() {
+               double sum = 0.0;
+               for (std::size_t i = 0; i < n; ++i) sum += mathieu_lib::upper_boundary(d.q[i]);
+               sink = sink + sum;
+           }),
+           time_per_point(n, [&]() {
+               float sum = 0.0f;
+               for (std::size_t i = 0; i < n; ++i) sum += mathieu_lib::upper_boundary(f.q[i]);
+               sink = sink + sum;
+           }));
+
+    report("characteristic_b1 (batch)",
+           time_per_point(n, [&]() { mathieu_lib::characteristic_b1(d.q.data(), n, d.a.data()); }),
+           time_per_point(n, [&]() { mathieu_lib::characteristic_b1(f.q.data(), n, f.a.data()); }));
+
+    report("secular_frequency (scalar)",
+           time_per_point(n, [&]() {
+               double sum = 0.0;
+               for (std::size_t i = 0; i < n; ++i)
+                   sum += mathieu_lib::secular_frequency(1.1e6, d.q[i]);
+               sink = sink + sum;
+           }),
+           time_per_point(n, [&]() {
+               float sum = 0.0f;
+               for (std::size_t i = 0; i < n; ++i)
+                   sum += mathieu_lib::secular_frequency(1.1e6f, f.q[i]);
+               sink = sink + sum;
+           }));
+    return 0;
+}
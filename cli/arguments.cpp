@@ -0,0 +1,55 @@
+/**
+ * @file arguments.cpp
+ * @brief Strict number parsing shared by the trappable-cli commands.
+ */
+#include "arguments.h"
+
+#include <stdexcept>
+
+#include "mathieu_lib/thread_pool.h"
+
+namespace trappable::cli {
+
+auto to_number(const std::string& text) -> double {
+    try {
+        std::size_t used = 0;
+        const double value = std::stod(text, &used);
+        if (used == text.size())
+            return value;
+    } catch (const std::exception&) {  // NOLINT(bugprone-empty-catch) reported below
+    }
+    throw std::invalid_argument("Invalid number: " + text);
+}
+
+/**
+ * @brief Digits only, accumulated with an overflow check, so no double-to-integer cast can
+ *        wrap a negative, fractional or huge value into range.
+ */
+auto to_integer(const std::string& flag, const std::string& text, std::uint64_t min,
+                std::uint64_t max) -> std::uint64_t {
+    const auto invalid = [&]() {
+        return std::invalid_argument("Invalid value for " + flag + ": '" + text +
+                                     "' (expected an integer from " + std::to_string(min) +
+                                     " to " + std::to_string(max) + ")");
+    };
+    if (text.empty())
+        throw invalid();
+    std::uint64_t value = 0;
+    for (const char c : text) {
+        if (c < '0' || c > '9')
+            throw invalid();
+        const auto digit = static_cast<std::uint64_t>(c - '0');
+        if (digit > max || value > (max - digit) / 10)
+            throw invalid();
+        value = value * 10 + digit;
+    }
+    if (value < min)
+        throw invalid();
+    return value;
+}
+
+auto parse_thread_count(const std::string& flag, const std::string& text) -> unsigned {
+    return static_cast<unsigned>(to_integer(flag, text, 1, mathieu_lib::ThreadPool::MAX_THREADS));
+}
+
+}  // namespace trappable::cli
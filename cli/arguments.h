@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace trappable::cli {
+
+// The whole of `text` as a number; throws std::invalid_argument otherwise
+auto to_number(const std::string& text) -> double;
+
+// A decimal integer in [min, max] written with digits only, so "-1", "2.7", "1e3" and "4x" are
+// rejected; throws std::invalid_argument naming `flag` otherwise
+auto to_integer(const std::string& flag, const std::string& text, std::uint64_t min,
+                std::uint64_t max) -> std::uint64_t;
+
+// --threads N: a positive integer no larger than the pool accepts
+auto parse_thread_count(const std::string& flag, const std::string& text) -> unsigned;
+
+}  // namespace trappable::cli
@@ -0,0 +1,219 @@
+/**
+ * @file batch.cpp
+ * @brief Parallel q/a/m/z/LMCO/margin evaluation for (configuration, ion) pairs with ordered,
+ *        streaming CSV or binary result output.
+ */
+#include "batch.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#include "mathieu_lib/mathieu.h"
+#include "mathieu_lib/stability.h"
+#include "mathieu_lib/thread_pool.h"
+
+namespace trappable::cli {
+
+namespace {
+
+void append_number(std::string& out, double value) {
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+/**
+ * @brief Evaluates ions [begin, end) under one configuration into a columnar block.
+ */
+auto compute_block(std::size_t config_index, const InstrumentConfig& config,
+                   const mathieu_lib::MassList& ions, std::size_t begin, std::size_t end)
+    -> BatchBlock {
+    const mathieu_lib::QuadrupoleParams params(config.frequency, config.quad_radius, 0.0);
+    const std::size_t count = end - begin;
+    BatchBlock block;
+    block.config.assign(count, static_cast<std::int32_t>(config_index));
+    block.mz.assign(ions.mz.begin() + begin, ions.mz.begin() + end);
+    block.charge.assign(ions.charge_state.begin() + begin, ions.charge_state.begin() + end);
+    block.q.resize(count);
+    block.a.resize(count);
+    mathieu_lib::mathieu_q_from_mz(config.voltage_rf, params, block.mz.data(), count,
+                                   block.q.data());
+    mathieu_lib::mathieu_a_from_mz(config.voltage_dc, params, block.mz.data(), count,
+                                   block.a.data());
+    block.lmco.assign(count, mathieu_lib::lmco(config.voltage_rf, 1, params, mathieu_lib::MAX_Q));
+    block.beta.resize(count);
+    block.secular_khz.resize(count);
+    block.stable.resize(count);
+    block.delta_a.resize(count);
+    block.delta_q.resize(count);
+    block.delta_e.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const mathieu_lib::BoundaryMargins margins =
+            mathieu_lib::boundary_margins(block.q[i], block.a[i]);
+        block.beta[i] = mathieu_lib::beta(block.q[i]);
+        block.secular_khz[i] = mathieu_lib::secular_frequency(config.frequency, block.q[i]);
+        block.stable[i] = margins.stable ? 1 : 0;
+        block.delta_a[i] = margins.delta_a;
+        block.delta_q[i] = margins.delta_q;
+        block.delta_e[i] = margins.delta_e;
+    }
+    return block;
+}
+
+void format_block(BatchBlock& block) {
+    std::string& out = block.text;
+    out.reserve(block.mz.size() * 160);
+    for (std::size_t i = 0; i < block.mz.size(); ++i) {
+        out += std::to_string(block.config[i]);
+        out += ',';
+        append_number(out, block.mz[i]);
+        out += ',';
+        out += std::to_string(block.charge[i]);
+        for (double value : {block.q[i], block.a[i], block.beta[i], block.secular_khz[i],
+                             block.lmco[i]}) {
+            out += ',';
+            append_number(out, value);
+        }
+        out += block.stable[i] ? ",1" : ",0";
+        for (double value : {block.delta_a[i], block.delta_q[i], block.delta_e[i]}) {
+            out += ',';
+            append_number(out, value);
+        }
+        out += '\n';
+    }
+}
+
+/**
+ * @brief Evaluates every (configuration, ion) pair on the shared thread pool and hands the
+ *        blocks to consume() strictly in order on the calling thread.
+ *
+ * Work is split into blocks of options.block_size ions. Pool tasks compute (and, for CSV,
+ * format) blocks independently; the calling thread consumes each as soon as it is next in
+ * line and keeps only a bounded number of blocks in flight so memory stays flat.
+ */
+template <typename Consume>
+void run_ordered(const std::vector<InstrumentConfig>& configs, const mathieu_lib::MassList& ions,
+                 const BatchOptions& options, Consume consume) {
+    const std::size_t block_size = std::max<std::size_t>(options.block_size, 1);
+    const std::size_t blocks_per_config = (ions.size() + block_size - 1) / block_size;
+    const std::size_t total_blocks = blocks_per_config * configs.size();
+    mathieu_lib::ThreadPool& pool = mathieu_lib::ThreadPool::global();
+    const std::size_t window = 4 * static_cast<std::size_t>(pool.thread_count());
+
+    std::deque<std::future<BatchBlock>> in_flight;
+    std::size_t next_block = 0;
+    auto launch = [&]() {
+        const std::size_t b = next_block++;
+        in_flight.push_back(pool.async([&configs, &ions, &options, b, block_size,
+                                        blocks_per_config]() {
+            const std::size_t config_index = b / blocks_per_config;
+            const std::size_t begin = (b % blocks_per_config) * block_size;
+            const std::size_t end = std::min(begin + block_size, ions.size());
+            BatchBlock block = compute_block(config_index, configs[config_index], ions, begin, end);
+            if (options.format == OutputFormat::Csv)
+                format_block(block);
+            return block;
+        }));
+    };
+    while (next_block < total_blocks && in_flight.size() < window) launch();
+    while (!in_flight.empty()) {
+        BatchBlock block = in_flight.front().get();
+        in_flight.pop_front();
+        if (next_block < total_blocks)
+            launch();
+        consume(block);
+    }
+}
+
+auto parse_number(const char*& p, const char* end, double& value) -> bool {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == ',' || *p == ';')) ++p;
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc())
+        return false;
+    p = result.ptr;
+    return true;
+}
+
+}  // namespace
+
+/**
+ * @brief Parses instrument configurations, one per line:
+ *        frequency_hz, radius_m, voltage_rf, voltage_dc. Other lines are skipped.
+ */
+auto parse_configurations(const std::string& text) -> std::vector<InstrumentConfig> {
+    std::vector<InstrumentConfig> configs;
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        const char* p = line.data();
+        const char* end = p + line.size();
+        InstrumentConfig config{};
+        if (parse_number(p, end, config.frequency) && parse_number(p, end, config.quad_radius) &&
+            parse_number(p, end, config.voltage_rf) && parse_number(p, end, config.voltage_dc))
+            configs.push_back(config);
+    }
+    return configs;
+}
+
+/**
+ * @brief Reads a whole file, or stdin when path is "-".
+ */
+auto read_input(const std::string& path) -> std::string {
+    if (path == "-") {
+        std::ios::sync_with_stdio(false);
+        return std::string(std::istreambuf_iterator<char>(std::cin),
+                           std::istreambuf_iterator<char>());
+    }
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("Cannot open file: " + path);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void write_batch_header(std::ostream& out) {
+    out << "config,mz,charge,q,a,beta,secular_khz,lmco,stable,delta_a,delta_q,delta_e\n";
+}
+
+auto batch_result_columns() -> std::vector<mathieu_lib::ColumnSpec> {
+    using mathieu_lib::ColumnType;
+    return {{"config", ColumnType::Int32},    {"mz", ColumnType::Float64},
+            {"charge", ColumnType::Int32},    {"q", ColumnType::Float64},
+            {"a", ColumnType::Float64},       {"beta", ColumnType::Float64},
+            {"secular_khz", ColumnType::Float64}, {"lmco", ColumnType::Float64},
+            {"stable", ColumnType::UInt8},    {"delta_a", ColumnType::Float64},
+            {"delta_q", ColumnType::Float64}, {"delta_e", ColumnType::Float64}};
+}
+
+void run_batch(const std::vector<InstrumentConfig>& configs, const mathieu_lib::MassList& ions,
+               const BatchOptions& options, std::ostream& out) {
+    BatchOptions csv = options;
+    csv.format = OutputFormat::Csv;
+    run_ordered(configs, ions, csv, [&out](const BatchBlock& block) {
+        out.write(block.text.data(), static_cast<std::streamsize>(block.text.size()));
+    });
+    out.flush();
+}
+
+void run_batch(const std::vector<InstrumentConfig>& configs, const mathieu_lib::MassList& ions,
+               const BatchOptions& options, mathieu_lib::ResultFileWriter& writer) {
+    BatchOptions binary = options;
+    binary.format = OutputFormat::Binary;
+    run_ordered(configs, ions, binary, [&writer](const BatchBlock& block) {
+        writer.write_chunk({block.config.data(), block.mz.data(), block.charge.data(),
+                            block.q.data(), block.a.data(), block.beta.data(),
+                            block.secular_khz.data(), block.lmco.data(), block.stable.data(),
+                            block.delta_a.data(), block.delta_q.data(), block.delta_e.data()},
+                           block.mz.size());
+    });
+    writer.close();
+}
+
+}  // namespace trappable::cli
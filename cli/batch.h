@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "mathieu_lib/mass_list.h"
+#include "mathieu_lib/result_file.h"
+
+namespace trappable::cli {
+
+// One instrument setting: the geometry and voltages applied to every ion in the list
+struct InstrumentConfig {
+    double frequency;   // Hz
+    double quad_radius;  // m
+    double voltage_rf;  // V
+    double voltage_dc;  // V
+};
+
+enum class OutputFormat { Csv, Binary };
+
+struct BatchOptions {
+    std::size_t block_size = 16384;  // ions per work item / output block
+    OutputFormat format = OutputFormat::Csv;
+};
+
+// Columnar results for one block of ions under one configuration
+struct BatchBlock {
+    std::vector<std::int32_t> config;
+    std::vector<double> mz;
+    std::vector<std::int32_t> charge;
+    std::vector<double> q, a, beta, secular_khz, lmco;
+    std::vector<std::uint8_t> stable;
+    std::vector<double> delta_a, delta_q, delta_e;
+    std::string text;  // CSV rows, filled only for OutputFormat::Csv
+};
+
+auto parse_configurations(const std::string& text) -> std::vector<InstrumentConfig>;
+auto read_input(const std::string& path) -> std::string;
+
+auto batch_result_columns() -> std::vector<mathieu_lib::ColumnSpec>;
+void write_batch_header(std::ostream& out);
+
+// CSV to a stream
+void run_batch(const std::vector<InstrumentConfig>& configs, const mathieu_lib::MassList& ions,
+               const BatchOptions& options, std::ostream& out);
+// Binary result file (one chunk per block)
+void run_batch(const std::vector<InstrumentConfig>& configs, const mathieu_lib::MassList& ions,
+               const BatchOptions& options, mathieu_lib::ResultFileWriter& writer);
+
+}  // namespace trappable::cli
@@ -0,0 +1,168 @@
+/**
+ * @file main.cpp
+ * @brief trappable-cli: headless batch front end over mathieu_lib (no Qt, no display).
+ */
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "arguments.h"
+#include "batch.h"
+#include "map_command.h"
+#include "shard_command.h"
+#include "sweep_command.h"
+#include "mathieu_lib/mass_list.h"
+#include "mathieu_lib/thread_pool.h"
+
+namespace {
+
+void print_usage(std::ostream& out) {
+    out << "Usage: trappable-cli batch [options]\n"
+           "       trappable-cli sweep --out DIR [options]   (see trappable-cli sweep --help)\n"
+           "       trappable-cli shard --output FILE.trb [options]   (see shard --help)\n"
+           "       trappable-cli stability-map [options]   (see stability-map --help)\n"
+           "\n"
+           "Computes q, a, beta, secular frequency, LMCO and stability margins for every\n"
+           "(configuration, ion) pair and streams CSV rows.\n"
+           "\n"
+           "Options:\n"
+           "  --config FILE     Configurations, one per line: frequency_hz,radius_m,v_rf,v_dc\n"
+           "                    ('-' reads stdin)\n"
+           "  --frequency HZ    Single configuration: drive frequency (instead of --config)\n"
+           "  --radius M        Single configuration: quadrupole radius r0\n"
+           "  --vrf V           Single configuration: RF voltage\n"
+           "  --vdc V           Single configuration: DC voltage (default 0)\n"
+           "  --ions FILE       Ion list: m/z[,charge[,intensity]] per line (default '-', stdin)\n"
+           "  --output FILE     Output file (default stdout)\n"
+           "  --format FMT      csv (default) or binary (columnar .trb result file,\n"
+           "                    needs --output)\n"
+           "  --threads N       Worker threads (default: all cores)\n"
+           "  --help            Show this message\n";
+}
+
+auto parse_double(const std::string& flag, const char* value) -> double {
+    try {
+        return std::stod(value);
+    } catch (const std::exception&) {
+        throw std::invalid_argument("Invalid number for " + flag + ": " + value);
+    }
+}
+
+auto run_batch_command(int argc, char* argv[]) -> int {
+    using namespace trappable::cli;
+    std::string config_path, ions_path = "-", output_path;
+    InstrumentConfig single{0.0, 0.0, 0.0, 0.0};
+    bool has_single = false;
+    BatchOptions options;
+    for (int i = 0; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            print_usage(std::cout);
+            return 0;
+        }
+        if (i + 1 >= argc)
+            throw std::invalid_argument("Missing value for " + arg);
+        const char* value = argv[++i];
+        if (arg == "--config") {
+            config_path = value;
+        } else if (arg == "--ions") {
+            ions_path = value;
+        } else if (arg == "--output") {
+            output_path = value;
+        } else if (arg == "--format") {
+            const std::string format = value;
+            if (format == "csv")
+                options.format = OutputFormat::Csv;
+            else if (format == "binary")
+                options.format = OutputFormat::Binary;
+            else
+                throw std::invalid_argument("Unknown format: " + format);
+        } else if (arg == "--threads") {
+            mathieu_lib::ThreadPool::set_global_thread_count(parse_thread_count(arg, value));
+        } else if (arg == "--frequency") {
+            single.frequency = parse_double(arg, value);
+            has_single = true;
+        } else if (arg == "--radius") {
+            single.quad_radius = parse_double(arg, value);
+            has_single = true;
+        } else if (arg == "--vrf") {
+            single.voltage_rf = parse_double(arg, value);
+            has_single = true;
+        } else if (arg == "--vdc") {
+            single.voltage_dc = parse_double(arg, value);
+            has_single = true;
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+    if (options.format == OutputFormat::Binary && output_path.empty())
+        throw std::invalid_argument("--format binary needs --output");
+    if (config_path == "-" && ions_path == "-")
+        throw std::invalid_argument("--config and --ions cannot both read stdin");
+
+    std::vector<InstrumentConfig> configs;
+    if (!config_path.empty())
+        configs = parse_configurations(read_input(config_path));
+    if (has_single) {
+        // --vdc alone would leave the other three at 0 and every row inf or NaN
+        if (!(single.frequency > 0.0) || !(single.quad_radius > 0.0) || !(single.voltage_rf > 0.0))
+            throw std::invalid_argument(
+                "A single configuration needs --frequency, --radius and --vrf, all > 0");
+        configs.push_back(single);
+    }
+    if (configs.empty())
+        throw std::invalid_argument("No instrument configuration given (--config or --frequency)");
+
+    mathieu_lib::MassList ions;
+    if (ions_path == "-") {
+        const std::string text = read_input(ions_path);
+        ions = mathieu_lib::parse_mass_list(text.data(), text.size());
+    } else {
+        ions = mathieu_lib::import_mass_list(ions_path);
+    }
+
+    if (options.format == OutputFormat::Binary) {
+        mathieu_lib::ResultFileWriter writer(output_path, batch_result_columns());
+        run_batch(configs, ions, options, writer);
+        return 0;
+    }
+    std::ofstream file;
+    if (!output_path.empty()) {
+        file.open(output_path, std::ios::binary);
+        if (!file)
+            throw std::runtime_error("Cannot open output file: " + output_path);
+    }
+    std::ostream& out = output_path.empty() ? std::cout : file;
+    write_batch_header(out);
+    run_batch(configs, ions, options, out);
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || std::strcmp(argv[1], "--help") == 0 || std::strcmp(argv[1], "-h") == 0) {
+        print_usage(argc < 2 ? std::cerr : std::cout);
+        return argc < 2 ? 1 : 0;
+    }
+    try {
+        if (std::strcmp(argv[1], "batch") == 0)
+            return run_batch_command(argc - 2, argv + 2);
+        if (std::strcmp(argv[1], "sweep") == 0)
+            return trappable::cli::run_sweep_command(argc - 2, argv + 2);
+        if (std::strcmp(argv[1], "shard") == 0)
+            return trappable::cli::run_shard_command(argc - 2, argv + 2, argv[0]);
+        if (std::strcmp(argv[1], "stability-map") == 0)
+            return trappable::cli::run_map_command(argc - 2, argv + 2);
+        if (std::strcmp(argv[1], "shard-worker") == 0)
+            return trappable::cli::run_shard_worker_command(argc - 2, argv + 2);
+        std::cerr << "Unknown command: " << argv[1] << "\n";
+        print_usage(std::cerr);
+        return 1;
+    } catch (const std::exception& ex) {
+        std::cerr << "trappable-cli: " << ex.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,140 @@
+/**
+ * @file map_command.cpp
+ * @brief `trappable-cli stability-map`: stability margin over a (q, a) grid as streamed CSV.
+ *
+ * Bands of rows finish out of order on the thread pool; they are held back only until every
+ * earlier row has been written, so output starts long before the map is complete and is
+ * identical for any thread count.
+ */
+#include "map_command.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "mathieu_lib/stability_map.h"
+#include "mathieu_lib/thread_pool.h"
+#include "arguments.h"
+#include "sweep_command.h"
+
+namespace trappable::cli {
+
+namespace {
+
+constexpr std::uint64_t MAX_BAND_ROWS = 1u << 20;
+
+// "start:stop:count" -> (min, max, cells)
+void parse_grid_axis(const std::string& text, double& min, double& max, std::size_t& cells) {
+    if (text.find(':') == std::string::npos)
+        throw std::invalid_argument("Grid axis must be start:stop:count: " + text);
+    const std::vector<double> values = parse_axis(text);
+    min = values.front();
+    max = values.back();
+    cells = values.size();
+}
+
+}  // namespace
+
+void print_map_usage(std::ostream& out) {
+    out << "Usage: trappable-cli stability-map [options]\n"
+           "\n"
+           "Writes CSV rows q,a,margin,stable for every cell of a regular (q, a) grid, where\n"
+           "margin is the distance to the upper boundary of the first stability region\n"
+           "(negative outside). Rows are streamed in order while the map is computed.\n"
+           "\n"
+           "Options:\n"
+           "  --q START:STOP:COUNT   q axis (default 0:0.908:400)\n"
+           "  --a START:STOP:COUNT   a axis (default 0:0.25:200)\n"
+           "  --band-rows N          a-rows per work item (default 8)\n"
+           "  --output FILE          Output file (default stdout)\n"
+           "  --progress             Report finished rows on stderr\n"
+           "  --threads N            Worker threads (default: all cores)\n";
+}
+
+auto run_map_command(int argc, char* argv[]) -> int {
+    mathieu_lib::StabilityMapSpec spec{0.0, 0.908, 400, 0.0, 0.25, 200};
+    mathieu_lib::StabilityMapOptions options;
+    std::string output_path;
+    bool show_progress = false;
+    for (int i = 0; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            print_map_usage(std::cout);
+            return 0;
+        }
+        if (arg == "--progress") {
+            show_progress = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+            throw std::invalid_argument("Missing value for " + arg);
+        const std::string value = argv[++i];
+        if (arg == "--q") {
+            parse_grid_axis(value, spec.q_min, spec.q_max, spec.q_cells);
+        } else if (arg == "--a") {
+            parse_grid_axis(value, spec.a_min, spec.a_max, spec.a_cells);
+        } else if (arg == "--band-rows") {
+            options.band_rows = static_cast<std::size_t>(to_integer(arg, value, 1, MAX_BAND_ROWS));
+        } else if (arg == "--output") {
+            output_path = value;
+        } else if (arg == "--threads") {
+            mathieu_lib::ThreadPool::set_global_thread_count(parse_thread_count(arg, value));
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+
+    std::ofstream file;
+    if (!output_path.empty()) {
+        file.open(output_path, std::ios::binary);
+        if (!file)
+            throw std::runtime_error("Cannot open output file: " + output_path);
+    }
+    std::ostream& out = output_path.empty() ? std::cout : file;
+    out << "q,a,margin,stable\n";
+
+    // Finished bands waiting for an earlier one, keyed by first row
+    std::map<std::size_t, std::vector<double>> pending;
+    std::size_t next_row = 0;
+    std::string text;
+    char cell[96];
+    options.on_rows = [&](std::size_t first_row, std::size_t rows, const double* margins) {
+        pending.emplace(first_row, std::vector<double>(margins, margins + rows * spec.q_cells));
+        while (!pending.empty() && pending.begin()->first == next_row) {
+            const std::vector<double>& band = pending.begin()->second;
+            const std::size_t band_rows = band.size() / spec.q_cells;
+            text.clear();
+            for (std::size_t row = 0; row < band_rows; ++row) {
+                const double a = spec.cell_a(next_row + row);
+                for (std::size_t column = 0; column < spec.q_cells; ++column) {
+                    const double margin = band[row * spec.q_cells + column];
+                    std::snprintf(cell, sizeof(cell), "%.6g,%.6g,%.6g,%d\n", spec.cell_q(column),
+                                  a, margin, std::signbit(margin) ? 0 : 1);
+                    text += cell;
+                }
+            }
+            out << text << std::flush;
+            next_row += band_rows;
+            pending.erase(pending.begin());
+        }
+    };
+    if (show_progress) {
+        options.progress = [](std::uint64_t done, std::uint64_t total) {
+            std::cerr << "\rrows " << done << "/" << total << std::flush;
+        };
+    }
+    mathieu_lib::rasterize_stability(spec, options);
+    if (show_progress)
+        std::cerr << "\n";
+    if (!out)
+        throw std::runtime_error("Failed writing stability map output");
+    return 0;
+}
+
+}  // namespace trappable::cli
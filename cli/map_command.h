@@ -0,0 +1,11 @@
+#pragma once
+
+#include <ostream>
+
+namespace trappable::cli {
+
+void print_map_usage(std::ostream& out);
+// Rasterizes the stability margin over a (q, a) grid, streaming CSV rows as bands finish
+auto run_map_command(int argc, char* argv[]) -> int;
+
+}  // namespace trappable::cli
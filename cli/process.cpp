@@ -0,0 +1,126 @@
+/**
+ * @file process.cpp
+ * @brief Minimal portable child-process spawning for the shard coordinator.
+ */
+#include "process.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <climits>
+extern char** environ;
+#endif
+
+namespace trappable::cli {
+
+#ifdef _WIN32
+namespace {
+
+// Quoting rules understood by CommandLineToArgvW and the MSVC runtime
+auto quote_argument(const std::string& arg) -> std::string {
+    if (!arg.empty() && arg.find_first_of(" \t\"") == std::string::npos)
+        return arg;
+    std::string out = "\"";
+    std::size_t backslashes = 0;
+    for (char c : arg) {
+        if (c == '\\') {
+            ++backslashes;
+            continue;
+        }
+        if (c == '"')
+            out.append(backslashes * 2 + 1, '\\');
+        else
+            out.append(backslashes, '\\');
+        backslashes = 0;
+        out += c;
+    }
+    out.append(backslashes * 2, '\\');
+    return out + "\"";
+}
+
+}  // namespace
+
+auto current_executable(const char* argv0) -> std::string {
+    char buffer[MAX_PATH];
+    const DWORD length = GetModuleFileNameA(nullptr, buffer, MAX_PATH);
+    if (length == 0 || length == MAX_PATH)
+        return argv0;
+    return std::string(buffer, length);
+}
+
+auto spawn_process(const std::string& executable, const std::vector<std::string>& args)
+    -> ChildProcess {
+    std::string command_line = quote_argument(executable);
+    for (const std::string& arg : args) command_line += " " + quote_argument(arg);
+    STARTUPINFOA startup{};
+    startup.cb = sizeof(startup);
+    PROCESS_INFORMATION info{};
+    if (!CreateProcessA(executable.c_str(), command_line.data(), nullptr, nullptr, TRUE, 0,
+                        nullptr, nullptr, &startup, &info))
+        throw std::runtime_error("Cannot start process: " + executable);
+    CloseHandle(info.hThread);
+    ChildProcess child;
+    child.handle = info.hProcess;
+    return child;
+}
+
+auto poll_process(ChildProcess& child) -> std::optional<int> {
+    if (!child.handle)
+        throw std::invalid_argument("Process already reaped");
+    if (WaitForSingleObject(child.handle, 0) == WAIT_TIMEOUT)
+        return std::nullopt;
+    DWORD code = 1;
+    GetExitCodeProcess(child.handle, &code);
+    CloseHandle(child.handle);
+    child.handle = nullptr;
+    return static_cast<int>(code);
+}
+#else
+auto current_executable(const char* argv0) -> std::string {
+#ifdef __linux__
+    char buffer[PATH_MAX];
+    const ssize_t length = ::readlink("/proc/self/exe", buffer, sizeof(buffer));
+    if (length > 0 && static_cast<std::size_t>(length) < sizeof(buffer))
+        return std::string(buffer, static_cast<std::size_t>(length));
+#endif
+    return argv0;
+}
+
+auto spawn_process(const std::string& executable, const std::vector<std::string>& args)
+    -> ChildProcess {
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(executable.c_str()));
+    for (const std::string& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+    ChildProcess child;
+    if (::posix_spawn(&child.pid, executable.c_str(), nullptr, nullptr, argv.data(), environ) !=
+        0)
+        throw std::runtime_error("Cannot start process: " + executable);
+    return child;
+}
+
+auto poll_process(ChildProcess& child) -> std::optional<int> {
+    if (child.pid < 0)
+        throw std::invalid_argument("Process already reaped");
+    int status = 0;
+    const pid_t result = ::waitpid(child.pid, &status, WNOHANG);
+    if (result == 0)
+        return std::nullopt;
+    child.pid = -1;
+    if (result < 0)
+        return 1;
+    if (WIFEXITED(status))
+        return WEXITSTATUS(status);
+    return 128 + (WIFSIGNALED(status) ? WTERMSIG(status) : 0);
+}
+#endif
+
+}  // namespace trappable::cli
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace trappable::cli {
+
+// A spawned child process; release with wait_process() until it reports an exit code
+struct ChildProcess {
+#ifdef _WIN32
+    void* handle = nullptr;
+#else
+    int pid = -1;
+#endif
+};
+
+auto current_executable(const char* argv0) -> std::string;
+auto spawn_process(const std::string& executable, const std::vector<std::string>& args)
+    -> ChildProcess;
+// Exit code once the child has finished, std::nullopt while it is still running
+auto poll_process(ChildProcess& child) -> std::optional<int>;
+
+}  // namespace trappable::cli
@@ -0,0 +1,242 @@
+/**
+ * @file shard_command.cpp
+ * @brief `trappable-cli shard`: one sweep fanned out over local worker processes.
+ *
+ * The coordinator creates the complete result file up front (as OUTPUT.partial) with every
+ * column at a known offset, plus a small OUTPUT.progress file holding one slot per worker.
+ * Each worker maps both, computes its contiguous slice of the sweep and stores it straight
+ * into the shared mapping; slices never overlap, so no locking is involved. A crashed worker
+ * only loses its own slice, which the coordinator re-runs. When every slice is done the
+ * partial file is renamed to OUTPUT.
+ */
+#include "shard_command.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "mathieu_lib/mapped_file.h"
+#include "mathieu_lib/result_file.h"
+#include "mathieu_lib/sweep.h"
+#include "arguments.h"
+#include "process.h"
+#include "sweep_command.h"
+
+namespace trappable::cli {
+
+namespace {
+
+// One progress slot per worker in the OUTPUT.progress side file
+struct ShardSlot {
+    std::atomic<std::uint64_t> rows_done;
+    std::atomic<std::uint64_t> state;  // ShardState
+};
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "progress slots are shared between processes");
+
+enum ShardState : std::uint64_t { SHARD_RUNNING = 0, SHARD_DONE = 1 };
+
+// Bounds of --workers (and so of the shard count) and --retries
+constexpr std::uint64_t MAX_WORKERS = 1024;
+constexpr std::uint64_t MAX_RETRIES = 1000;
+
+auto progress_slots(mathieu_lib::MappedFile& file) -> ShardSlot* {
+    return reinterpret_cast<ShardSlot*>(file.mutable_data());
+}
+
+// INDEX/COUNT with 0 <= INDEX < COUNT <= MAX_WORKERS, both plain integers
+void parse_shard(const std::string& flag, const std::string& text, unsigned& shard,
+                 unsigned& shards) {
+    const std::size_t slash = text.find('/');
+    if (slash == std::string::npos)
+        throw std::invalid_argument(flag + " must be INDEX/COUNT: " + text);
+    shards = static_cast<unsigned>(to_integer(flag, text.substr(slash + 1), 1, MAX_WORKERS));
+    shard = static_cast<unsigned>(to_integer(flag, text.substr(0, slash), 0, shards - 1));
+}
+
+}  // namespace
+
+void print_shard_usage(std::ostream& out) {
+    out << "Usage: trappable-cli shard --output FILE.trb [options] [sweep axes]\n"
+           "\n"
+           "Runs one sweep across several local worker processes that write disjoint slices\n"
+           "of a single preallocated .trb result file. Accepts the sweep axis options\n"
+           "(--frequency, --radius, --vrf, --vdc, --charge, --mass; see sweep --help).\n"
+           "\n"
+           "Options:\n"
+           "  --workers N       Worker processes (default: all cores)\n"
+           "  --retries N       Re-runs allowed per failed slice (default 1)\n";
+}
+
+auto run_shard_command(int argc, char* argv[], const char* argv0) -> int {
+    mathieu_lib::SweepSpec spec;
+    spec.voltage_dc = {0.0};
+    spec.charge_state = {1};
+    std::vector<std::string> forwarded;
+    std::string output;
+    unsigned workers = std::min(std::max(std::thread::hardware_concurrency(), 1u),
+                                static_cast<unsigned>(MAX_WORKERS));
+    unsigned retries = 1;
+    for (int i = 0; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            print_shard_usage(std::cout);
+            return 0;
+        }
+        if (i + 1 >= argc)
+            throw std::invalid_argument("Missing value for " + arg);
+        const std::string value = argv[++i];
+        if (apply_sweep_axis(arg, value, spec)) {
+            forwarded.push_back(arg);
+            forwarded.push_back(value);
+            continue;
+        }
+        if (arg == "--output")
+            output = value;
+        else if (arg == "--workers")
+            workers = static_cast<unsigned>(to_integer(arg, value, 1, MAX_WORKERS));
+        else if (arg == "--retries")
+            retries = static_cast<unsigned>(to_integer(arg, value, 0, MAX_RETRIES));
+        else
+            throw std::invalid_argument("Unknown option: " + arg);
+    }
+    if (output.empty())
+        throw std::invalid_argument("shard needs --output FILE");
+    const std::uint64_t total = spec.point_count();
+    if (total == 0)
+        throw std::invalid_argument("shard needs --frequency, --radius, --vrf and --mass");
+    workers = static_cast<unsigned>(std::min<std::uint64_t>(workers, total));
+
+    const std::string partial = output + ".partial";
+    const std::string progress_path = output + ".progress";
+    mathieu_lib::create_preallocated_result_file(partial, mathieu_lib::sweep_result_columns(),
+                                                 total);
+    {
+        std::FILE* file = std::fopen(progress_path.c_str(), "wb");
+        if (!file)
+            throw std::runtime_error("Cannot create " + progress_path);
+        std::fclose(file);
+        std::filesystem::resize_file(progress_path, sizeof(ShardSlot) * workers);
+    }
+    bool failed = false;
+    {  // the progress mapping must be released before the file is removed
+        mathieu_lib::MappedFile progress_file(progress_path,
+                                              mathieu_lib::MappedFile::Access::ReadWrite);
+        ShardSlot* slots = progress_slots(progress_file);
+
+        const std::string executable = current_executable(argv0);
+        auto launch = [&](unsigned shard) {
+            slots[shard].rows_done = 0;
+            slots[shard].state = SHARD_RUNNING;
+            std::vector<std::string> args = {"shard-worker", "--shard",
+                                             std::to_string(shard) + "/" + std::to_string(workers),
+                                             "--output", partial, "--progress", progress_path};
+            args.insert(args.end(), forwarded.begin(), forwarded.end());
+            return spawn_process(executable, args);
+        };
+        std::vector<ChildProcess> children;
+        std::vector<unsigned> attempts(workers, 1);
+        std::vector<bool> finished(workers, false);
+        for (unsigned shard = 0; shard < workers; ++shard) children.push_back(launch(shard));
+
+        unsigned remaining = workers;
+        while (remaining > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            std::uint64_t done = 0;
+            for (unsigned shard = 0; shard < workers; ++shard) {
+                done += slots[shard].rows_done.load(std::memory_order_relaxed);
+                if (finished[shard])
+                    continue;
+                const std::optional<int> code = poll_process(children[shard]);
+                if (!code)
+                    continue;
+                if (*code == 0 && slots[shard].state == SHARD_DONE) {
+                    finished[shard] = true;
+                    --remaining;
+                } else if (attempts[shard] <= retries) {
+                    std::cerr << "\nshard " << shard << " exited with code " << *code
+                              << ", restarting\n";
+                    ++attempts[shard];
+                    children[shard] = launch(shard);
+                } else {
+                    std::cerr << "\nshard " << shard << " failed with code " << *code << "\n";
+                    finished[shard] = true;
+                    failed = true;
+                    --remaining;
+                }
+            }
+            std::cerr << "\rpoints " << done << "/" << total << std::flush;
+        }
+    }
+    std::cerr << "\n";
+    std::filesystem::remove(progress_path);
+    if (failed) {
+        std::filesystem::remove(partial);
+        throw std::runtime_error("Sweep shards failed; no output written");
+    }
+    std::filesystem::rename(partial, output);
+    std::cerr << total << " points from " << workers << " workers written to " << output
+              << "\n";
+    return 0;
+}
+
+auto run_shard_worker_command(int argc, char* argv[]) -> int {
+    mathieu_lib::SweepSpec spec;
+    spec.voltage_dc = {0.0};
+    spec.charge_state = {1};
+    std::string output, progress_path;
+    unsigned shard = 0, shards = 0;
+    for (int i = 0; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        const std::string value = argv[i + 1];
+        if (apply_sweep_axis(arg, value, spec))
+            continue;
+        if (arg == "--output")
+            output = value;
+        else if (arg == "--progress")
+            progress_path = value;
+        else if (arg == "--shard")
+            parse_shard(arg, value, shard, shards);
+        else
+            throw std::invalid_argument("Unknown option: " + arg);
+    }
+    if (output.empty() || progress_path.empty() || shards == 0)
+        throw std::invalid_argument("shard-worker needs --shard, --output and --progress");
+
+    mathieu_lib::MappedFile file(output, mathieu_lib::MappedFile::Access::ReadWrite);
+    mathieu_lib::MappedFile progress_file(progress_path,
+                                          mathieu_lib::MappedFile::Access::ReadWrite);
+    if (progress_file.size() < sizeof(ShardSlot) * shards)
+        throw std::invalid_argument("Progress file too small for " + std::to_string(shards) +
+                                    " shards");
+    ShardSlot& slot = progress_slots(progress_file)[shard];
+    const mathieu_lib::SweepShard slice =
+        mathieu_lib::sweep_shard(spec.point_count(), shard, shards);
+    const auto report = [&slot](std::uint64_t done) {
+        slot.rows_done.store(done, std::memory_order_relaxed);
+    };
+    // Test hook: the one worker that gets to delete the file named by TRAPPABLE_SHARD_FAULT
+    // stops halfway through its slice and fails, as a crashed worker would
+    const char* fault = std::getenv("TRAPPABLE_SHARD_FAULT");
+    std::error_code ignored;
+    if (fault && *fault && std::filesystem::remove(fault, ignored)) {
+        mathieu_lib::write_sweep_range(spec, slice.first, slice.count / 2, file, report);
+        std::cerr << "\nshard " << shard << ": injected failure\n";
+        return 3;
+    }
+    mathieu_lib::write_sweep_range(spec, slice.first, slice.count, file, report);
+    slot.state = SHARD_DONE;
+    return 0;
+}
+
+}  // namespace trappable::cli
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <ostream>
+
+namespace trappable::cli {
+
+void print_shard_usage(std::ostream& out);
+// Coordinator: preallocates the output, spawns and supervises `shard-worker` processes
+auto run_shard_command(int argc, char* argv[], const char* argv0) -> int;
+// Worker: fills its slice of the preallocated output in place
+auto run_shard_worker_command(int argc, char* argv[]) -> int;
+
+}  // namespace trappable::cli
@@ -0,0 +1,131 @@
+/**
+ * @file sweep_command.cpp
+ * @brief `trappable-cli sweep`: resumable cartesian sweeps written as chunked result files.
+ */
+#include "sweep_command.h"
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include "arguments.h"
+#include "mathieu_lib/sweep.h"
+#include "mathieu_lib/thread_pool.h"
+
+namespace trappable::cli {
+
+auto parse_axis(const std::string& text) -> std::vector<double> {
+    std::vector<double> values;
+    const std::size_t first_colon = text.find(':');
+    if (first_colon != std::string::npos) {
+        const std::size_t second_colon = text.find(':', first_colon + 1);
+        if (second_colon == std::string::npos)
+            throw std::invalid_argument("Range must be start:stop:count: " + text);
+        const double start = to_number(text.substr(0, first_colon));
+        const double stop = to_number(text.substr(first_colon + 1, second_colon - first_colon - 1));
+        const double count = to_number(text.substr(second_colon + 1));
+        if (count < 1 || count != std::floor(count))
+            throw std::invalid_argument("Range count must be a positive integer: " + text);
+        const auto n = static_cast<std::size_t>(count);
+        for (std::size_t i = 0; i < n; ++i)
+            values.push_back(n == 1 ? start : start + (stop - start) * i / (n - 1));
+        return values;
+    }
+    std::istringstream items(text);
+    std::string item;
+    while (std::getline(items, item, ',')) values.push_back(to_number(item));
+    if (values.empty())
+        throw std::invalid_argument("Empty axis");
+    return values;
+}
+
+auto apply_sweep_axis(const std::string& flag, const std::string& value,
+                      mathieu_lib::SweepSpec& spec) -> bool {
+    if (flag == "--frequency") {
+        spec.frequency = parse_axis(value);
+    } else if (flag == "--radius") {
+        spec.quad_radius = parse_axis(value);
+    } else if (flag == "--vrf") {
+        spec.voltage_rf = parse_axis(value);
+    } else if (flag == "--vdc") {
+        spec.voltage_dc = parse_axis(value);
+    } else if (flag == "--mass") {
+        spec.mass = parse_axis(value);
+    } else if (flag == "--charge") {
+        spec.charge_state.clear();
+        for (double charge : parse_axis(value)) {
+            if (charge < 1 || charge != std::floor(charge))
+                throw std::invalid_argument("Charge states must be positive integers");
+            spec.charge_state.push_back(static_cast<int>(charge));
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void print_sweep_usage(std::ostream& out) {
+    out << "Usage: trappable-cli sweep --out DIR [options]\n"
+           "\n"
+           "Evaluates every combination of the axes below and writes one .trb result file per\n"
+           "chunk into DIR. Re-running the same command resumes an interrupted sweep.\n"
+           "Axis values are a list (a,b,c) or a linear range (start:stop:count).\n"
+           "\n"
+           "Options:\n"
+           "  --frequency AXIS     Drive frequency in Hz\n"
+           "  --radius AXIS        Quadrupole radius r0 in m\n"
+           "  --vrf AXIS           RF voltage in V\n"
+           "  --vdc AXIS           DC voltage in V (default 0)\n"
+           "  --charge AXIS        Charge states (default 1)\n"
+           "  --mass AXIS          Ion mass in Da\n"
+           "  --chunk-points N     Points per chunk file (default 65536)\n"
+           "  --threads N          Worker threads (default: all cores)\n";
+}
+
+auto run_sweep_command(int argc, char* argv[]) -> int {
+    mathieu_lib::SweepSpec spec;
+    spec.voltage_dc = {0.0};
+    spec.charge_state = {1};
+    mathieu_lib::SweepOptions options;
+    std::string directory;
+    for (int i = 0; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            print_sweep_usage(std::cout);
+            return 0;
+        }
+        if (i + 1 >= argc)
+            throw std::invalid_argument("Missing value for " + arg);
+        const std::string value = argv[++i];
+        if (apply_sweep_axis(arg, value, spec))
+            continue;
+        if (arg == "--out") {
+            directory = value;
+        } else if (arg == "--chunk-points") {
+            options.chunk_points =
+                to_integer(arg, value, 1, std::numeric_limits<std::uint64_t>::max());
+        } else if (arg == "--threads") {
+            mathieu_lib::ThreadPool::set_global_thread_count(parse_thread_count(arg, value));
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+    if (directory.empty())
+        throw std::invalid_argument("sweep needs --out DIR");
+    if (spec.point_count() == 0)
+        throw std::invalid_argument("sweep needs --frequency, --radius, --vrf and --mass");
+
+    options.progress = [](std::size_t done, std::size_t total) {
+        std::cerr << "\rchunks " << done << "/" << total << std::flush;
+    };
+    const mathieu_lib::SweepSummary summary = mathieu_lib::run_sweep(spec, directory, options);
+    std::cerr << "\n"
+              << spec.point_count() << " points in " << summary.total_chunks << " chunks ("
+              << summary.skipped_chunks << " already done, " << summary.computed_chunks
+              << " computed)\n";
+    return 0;
+}
+
+}  // namespace trappable::cli
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "mathieu_lib/sweep.h"
+
+namespace trappable::cli {
+
+// Axis values: comma-separated list ("1e6,1.1e6") or linear range "start:stop:count"
+auto parse_axis(const std::string& text) -> std::vector<double>;
+
+// Applies one sweep axis flag (--frequency, --radius, --vrf, --vdc, --charge, --mass);
+// returns false when `flag` is not an axis flag
+auto apply_sweep_axis(const std::string& flag, const std::string& value,
+                      mathieu_lib::SweepSpec& spec) -> bool;
+
+void print_sweep_usage(std::ostream& out);
+auto run_sweep_command(int argc, char* argv[]) -> int;
+
+}  // namespace trappable::cli
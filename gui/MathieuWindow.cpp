@@ -1,17 +1,30 @@
 #include "MathieuWindow.h"
 
+#include <QComboBox>
 #include <QDir>
 #include <QDoubleValidator>
+#include <QFileDialog>
 #include <QFormLayout>
+#include <QHeaderView>
 #include <QIntValidator>
 #include <QLabel>
 #include <QLineEdit>
+#include <QProgressDialog>
 #include <QPushButton>
+#include <QToolTip>
 #include <QVBoxLayout>
+#include <algorithm>
+#include <atomic>
+#include <memory>
 
 #include "Inputs.h"
 #include "Outputs.h"
+#include "mathieu_lib/mass_list.h"
 #include "mathieu_lib/mathieu.h"
+#include "mathieu_lib/pseudopotential.h"
+#include "mathieu_lib/result_file.h"
+#include "mathieu_lib/stability_map.h"
+#include "mathieu_lib/thread_pool.h"
 #include "stability/StabilityCalculator.h"
 #include "stability/StabilityOutputs.h"
 
@@ -74,12 +87,45 @@ trappable::MathieuWindow::MathieuWindow(QWidget* parent) : QWidget(parent) {
     calcButton->setObjectName(QStringLiteral("calcButton"));
     calcButton->setEnabled(false);
     leftLayout->addWidget(calcButton);
+
+    // Ion list overlay controls
+    auto* ionRow = new QWidget(leftWidget);
+    auto* ionRowLayout = new QHBoxLayout(ionRow);
+    ionRowLayout->setContentsMargins(0, 0, 0, 0);
+    loadIonsButton = new QPushButton(QStringLiteral("Load ions..."), ionRow);
+    loadIonsButton->setObjectName(QStringLiteral("loadIonsButton"));
+    ionColorCombo = new QComboBox(ionRow);
+    ionColorCombo->setObjectName(QStringLiteral("ionColorCombo"));
+    ionColorCombo->addItems(
+        {QStringLiteral("Color by stability"), QStringLiteral("Color by margin")});
+    heatmapCheck = new QCheckBox(QStringLiteral("Margin heatmap"), ionRow);
+    heatmapCheck->setObjectName(QStringLiteral("heatmapCheck"));
+    ionRowLayout->addWidget(loadIonsButton);
+    ionRowLayout->addWidget(ionColorCombo);
+    higherRegionsCheck = new QCheckBox(QStringLiteral("Higher regions"), ionRow);
+    higherRegionsCheck->setObjectName(QStringLiteral("higherRegionsCheck"));
+    ionRowLayout->addWidget(heatmapCheck);
+    ionRowLayout->addWidget(higherRegionsCheck);
+    ionRow->setLayout(ionRowLayout);
+    leftLayout->addWidget(ionRow);
     auto* separator = new QFrame;
     separator->setFrameShape(QFrame::HLine);
     separator->setFrameShadow(QFrame::Sunken);
     leftLayout->addWidget(separator);
     outputs = new Outputs(leftWidget);
     leftLayout->addWidget(outputs);
+    ionTableModel = new IonTableModel(this);
+    ionTable = new QTableView(leftWidget);
+    ionTable->setObjectName(QStringLiteral("ionTable"));
+    ionTable->setModel(ionTableModel);
+    ionTable->setSortingEnabled(true);
+    ionTable->sortByColumn(-1, Qt::AscendingOrder);
+    // Fixed row heights keep scrolling O(visible rows) for very long lists
+    ionTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    ionTable->verticalHeader()->setDefaultSectionSize(fontMetrics().height() + 6);
+    ionTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    ionTable->setMinimumHeight(180);
+    leftLayout->addWidget(ionTable);
     miniCalculator = new MiniCalculator(leftWidget);
     leftLayout->addWidget(miniCalculator);
     // Update mini calculator parameters when main inputs change
@@ -111,6 +157,12 @@ trappable::MathieuWindow::MathieuWindow(QWidget* parent) : QWidget(parent) {
         topAxis->setTickLabels(false);
 
         stabilityPlotter = new StabilityRegionPlotter(stabilityPlotWidget);
+        ionOverlay = new IonOverlayPlotter(stabilityPlotWidget);
+
+        // Hover probe: report boundary metrics for whatever point is under the cursor
+        stabilityPlotWidget->setMouseTracking(true);
+        connect(stabilityPlotWidget, &QCustomPlot::mouseMove, this,
+                [this](QMouseEvent* event) { this->handlePlotHover(event); });
 
         QCPItemText* stableLabel = new QCPItemText(stabilityPlotWidget);
         stableLabel->setPositionAlignment(Qt::AlignCenter);
@@ -146,6 +198,17 @@ trappable::MathieuWindow::MathieuWindow(QWidget* parent) : QWidget(parent) {
     mainLayout->addLayout(contentLayout);
     this->show();
 
+    connect(loadIonsButton, &QPushButton::clicked, this, [this]() { this->loadIonList(); });
+    connect(ionColorCombo, &QComboBox::currentIndexChanged, this, [this](int index) {
+        ionOverlay->setColorMode(index == 0 ? IonOverlayPlotter::ColorMode::StabilityState
+                                            : IonOverlayPlotter::ColorMode::Margin);
+    });
+
+    connect(heatmapCheck, &QCheckBox::toggled, this,
+            [this](bool checked) { this->showHeatmap(checked); });
+    connect(higherRegionsCheck, &QCheckBox::toggled, this,
+            [this](bool checked) { this->showHigherRegions(checked); });
+
     connect(
         calcButton, &QPushButton::clicked, this, [this]() { this->handleCalculation(); },
         Qt::QueuedConnection);
@@ -192,7 +255,15 @@ void MathieuWindow::triggerMiniCalculator() {
 }
 
 trappable::MathieuWindow::~MathieuWindow() {
+    // Stop background work before its queued updates can outlive the plotter
+    *m_heatmapCancel = true;
+    *m_regionCancel = true;
+    if (m_heatmapTask.valid())
+        m_heatmapTask.wait();
+    if (m_regionTask.valid())
+        m_regionTask.wait();
     // All child widgets are deleted by Qt's parent-child mechanism
+    delete ionOverlay;
 }
 
 // --- Private methods for organization ---
@@ -234,13 +305,21 @@ void trappable::MathieuWindow::handleCalculation() {
                                               params, ::mathieu_lib::MAX_Q);
     outputs->setValues(omega_val, particle_mass_val, mathieu_q_val, mathieu_a_val, beta_val,
                        secular_freq_val, mz_val, lmco_val, max_mz_val);
+    if (calcInputs.charge_state != 0) {
+        const auto well = ::mathieu_lib::pseudopotential(
+            calcInputs.voltage_rf, calcInputs.voltage_dc, calcInputs.charge_state, params);
+        outputs->setPseudopotential(std::min(well.depth_x, well.depth_y), well.adiabaticity,
+                                    well.max_energy);
+    } else {
+        outputs->clearPseudopotential();
+    }
     stabilityPlotter->plotPoint(mathieu_q_val, mathieu_a_val);
+    updateIonViews();
 
     // Check if point is inside the stable region
-    bool isStable =
-        (mathieu_a_val >= 0.0 && mathieu_q_val >= 0.0 && mathieu_q_val <= mathieu_lib::MAX_Q &&
-         mathieu_a_val <= StabilityCalculator::calculateUpperBoundary(mathieu_q_val));
-    if (!isStable) {
+    StabilityCalculator::PointMetrics metrics =
+        StabilityCalculator::evaluatePoint(mathieu_q_val, mathieu_a_val);
+    if (!metrics.stable) {
         stabilityOutputs->setWarning(
             "Warning: The operating point is OUTSIDE the stable region! No stability metrics are "
             "calculated.");
@@ -249,11 +328,11 @@ void trappable::MathieuWindow::handleCalculation() {
     }
 
     // Calculate and update stability outputs using nearest boundary point
-    auto [q_b, a_b] = StabilityCalculator::findNearestBoundaryPoint(mathieu_q_val, mathieu_a_val);
-    double delta_a = a_b - mathieu_a_val;
-    double delta_q = std::abs(q_b - mathieu_q_val);
-    double delta_e = qSqrt((mathieu_q_val - q_b) * (mathieu_q_val - q_b) +
-                           (mathieu_a_val - a_b) * (mathieu_a_val - a_b));
+    double q_b = metrics.q_boundary;
+    double a_b = metrics.a_boundary;
+    double delta_a = metrics.delta_a;
+    double delta_q = metrics.delta_q;
+    double delta_e = metrics.delta_e;
     double theta = StabilityCalculator::angularOffset(mathieu_a_val, a_b, mathieu_q_val, q_b);
     double s_norm = delta_e / qSqrt(a_b * a_b + q_b * q_b);
     double delta_min = delta_e;
@@ -279,6 +358,192 @@ void trappable::MathieuWindow::handleCalculation() {
     stabilityPlotter->drawNearestPointTriangle(mathieu_q_val, mathieu_a_val, q_b, a_b);
 }
 
+/**
+ * @brief Show q, a, stability state, boundary distances and the m/z that would sit at the
+ *        hovered point for the current voltages.
+ * @param event Mouse-move event from the stability plot.
+ */
+void trappable::MathieuWindow::handlePlotHover(QMouseEvent* event) {
+    const QPointF pos = event->position();
+    if (!stabilityPlotWidget->axisRect()->rect().contains(pos.toPoint())) {
+        QToolTip::hideText();
+        return;
+    }
+    double q = stabilityPlotWidget->xAxis->pixelToCoord(pos.x());
+    double a = stabilityPlotWidget->yAxis->pixelToCoord(pos.y());
+    StabilityCalculator::PointMetrics metrics = StabilityCalculator::evaluatePoint(q, a);
+
+    QString mzText = QStringLiteral("-");
+    Inputs::CalculationInputs calcInputs;
+    if (q > 0.0 && inputs->getCalculationInputs(calcInputs)) {
+        ::mathieu_lib::QuadrupoleParams params(calcInputs.freq, calcInputs.radius,
+                                               calcInputs.mass);
+        double mz_val =
+            ::mathieu_lib::mz(calcInputs.voltage_rf, calcInputs.charge_state, params, q);
+        mzText = QString::number(mz_val, 'f', 2) + QStringLiteral(" Da");
+    }
+
+    QString state = QStringLiteral("Unstable");
+    if (metrics.stable_x && metrics.stable_y)
+        state = QStringLiteral("Stable");
+    else if (metrics.stable_x)
+        state = QStringLiteral("Stable in x only");
+    else if (metrics.stable_y)
+        state = QStringLiteral("Stable in y only");
+
+    QString text = QString("q = %1\na = %2\n%3\nΔa = %4\nΔq = %5\nΔₑ = %6\nm/z = %7")
+                       .arg(QString::number(q, 'f', 4), QString::number(a, 'f', 4), state,
+                            QString::number(metrics.delta_a, 'f', 4),
+                            QString::number(metrics.delta_q, 'f', 4),
+                            QString::number(metrics.delta_e, 'f', 4), mzText);
+    QToolTip::showText(event->globalPosition().toPoint(), text, stabilityPlotWidget);
+}
+
+/**
+ * @brief Import an ion list (m/z, charge, intensity per line; comma/tab/space separated) on a
+ *        worker thread with a cancellable progress dialog, then show it on the stability
+ *        diagram and in the ion table.
+ */
+void trappable::MathieuWindow::loadIonList() {
+    QString path =
+        QFileDialog::getOpenFileName(this, QStringLiteral("Load ion list"), QString(),
+                                     QStringLiteral("Ion lists (*.csv *.tsv *.txt *.trb)"));
+    if (path.isEmpty())
+        return;
+
+    auto* progressDialog = new QProgressDialog(QStringLiteral("Importing ion list..."),
+                                               QStringLiteral("Cancel"), 0, 100, this);
+    progressDialog->setWindowModality(Qt::WindowModal);
+    progressDialog->setMinimumDuration(300);
+    auto cancel = std::make_shared<std::atomic<bool>>(false);
+    auto result = std::make_shared<::mathieu_lib::MassList>();
+    auto error = std::make_shared<QString>();
+    connect(progressDialog, &QProgressDialog::canceled, this, [cancel]() { *cancel = true; });
+
+    // Runs on mathieu_lib's shared pool; the parser's own parallel loop nests inside it
+    ::mathieu_lib::ThreadPool::global().submit([this, path, cancel, result, error,
+                                                progressDialog]() {
+        ::mathieu_lib::MassListImportOptions options;
+        options.cancel = cancel.get();
+        int lastPercent = -1;
+        options.progress = [progressDialog, &lastPercent](std::size_t done, std::size_t total) {
+            int percent = total ? static_cast<int>(100 * done / total) : 100;
+            if (percent == lastPercent)
+                return;
+            lastPercent = percent;
+            QMetaObject::invokeMethod(
+                progressDialog, [progressDialog, percent]() { progressDialog->setValue(percent); },
+                Qt::QueuedConnection);
+        };
+        try {
+            if (path.endsWith(QStringLiteral(".trb"), Qt::CaseInsensitive)) {
+                // Binary result file: columns are copied straight out of the mapping
+                ::mathieu_lib::ResultFileReader reader(path.toStdString());
+                result->mz = reader.read_f64("mz");
+                result->charge_state = reader.read_i32("charge");
+            } else {
+                *result = ::mathieu_lib::import_mass_list(path.toStdString(), options);
+            }
+        } catch (const ::mathieu_lib::ImportCancelled&) {
+            result->mz.clear();
+        } catch (const std::exception& ex) {
+            *error = QString::fromUtf8(ex.what());
+        }
+        QMetaObject::invokeMethod(
+            this,
+            [this, progressDialog, cancel, result, error]() {
+                progressDialog->deleteLater();
+                if (!error->isEmpty()) {
+                    qWarning() << "MathieuWindow: Could not import ion list:" << *error;
+                    return;
+                }
+                if (*cancel)
+                    return;
+                ionOverlay->setIons(result->mz, result->charge_state);
+                ionTableModel->setIons(std::move(result->mz), std::move(result->charge_state));
+                updateIonViews();
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+/**
+ * @brief Show or hide the stability-margin heatmap. The first time it is shown the map is
+ *        rasterized on the shared pool and painted band by band as rows finish, so the plot
+ *        stays responsive and fills in progressively.
+ */
+void trappable::MathieuWindow::showHeatmap(bool visible) {
+    if (stabilityPlotter->hasHeatmap()) {
+        stabilityPlotter->setHeatmapVisible(visible);
+        return;
+    }
+    if (!visible)
+        return;
+    const ::mathieu_lib::StabilityMapSpec spec{0.0, ::mathieu_lib::MAX_Q, 360, 0.0, 0.25, 160};
+    stabilityPlotter->beginHeatmap(static_cast<int>(spec.q_cells),
+                                   static_cast<int>(spec.a_cells), spec.q_min, spec.q_max,
+                                   spec.a_min, spec.a_max);
+    m_heatmapTask = ::mathieu_lib::ThreadPool::global().async([this, spec,
+                                                               cancel = m_heatmapCancel]() {
+        ::mathieu_lib::StabilityMapOptions options;
+        options.cancel = cancel.get();
+        options.on_rows = [this, &spec](std::size_t firstRow, std::size_t rows,
+                                        const double* margins) {
+            // The band buffer belongs to the rasterizer; hand the GUI thread a copy
+            std::vector<double> band(margins, margins + rows * spec.q_cells);
+            QMetaObject::invokeMethod(
+                this,
+                [this, firstRow, rows, band = std::move(band)]() {
+                    stabilityPlotter->setHeatmapRows(static_cast<int>(firstRow),
+                                                     static_cast<int>(rows), band.data());
+                },
+                Qt::QueuedConnection);
+        };
+        ::mathieu_lib::rasterize_stability(spec, options);
+    });
+}
+
+/**
+ * @brief Show or hide the higher stability regions up to order 2 in each direction. The first
+ *        time they are shown the boundaries are computed on the shared pool and drawn once
+ *        complete; later toggles reuse the outlines.
+ */
+void trappable::MathieuWindow::showHigherRegions(bool visible) {
+    if (stabilityPlotter->hasHigherRegions()) {
+        stabilityPlotter->setHigherRegionsVisible(visible);
+        return;
+    }
+    if (!visible || m_regionTask.valid())
+        return;
+    m_regionTask = ::mathieu_lib::ThreadPool::global().async([this, cache = m_regionCache,
+                                                              cancel = m_regionCancel]() {
+        ::mathieu_lib::StabilityRegionOptions options;
+        options.cancel = cancel.get();
+        auto regions = cache->regions(2, options);
+        if (*cancel)
+            return;
+        QMetaObject::invokeMethod(
+            this,
+            [this, regions = std::move(regions), qMax = cache->q_max()]() {
+                stabilityPlotter->setHigherRegions(regions, qMax);
+                stabilityPlotter->setHigherRegionsVisible(higherRegionsCheck->isChecked());
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+/**
+ * @brief Recompute the ion overlay and ion table for the current RF/DC voltages and geometry.
+ */
+void trappable::MathieuWindow::updateIonViews() {
+    Inputs::CalculationInputs calcInputs;
+    if (ionOverlay->ionCount() == 0 || !inputs->getCalculationInputs(calcInputs))
+        return;
+    ::mathieu_lib::QuadrupoleParams params(calcInputs.freq, calcInputs.radius, calcInputs.mass);
+    ionOverlay->updateVoltages(calcInputs.voltage_rf, calcInputs.voltage_dc, params);
+    ionTableModel->setOperatingPoint(calcInputs.voltage_rf, calcInputs.voltage_dc, params);
+}
+
 /**
  * @brief Set all output fields to "Invalid" when input validation fails.
  */
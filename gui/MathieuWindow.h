@@ -1,15 +1,22 @@
 #pragma once
 
+#include <QCheckBox>
 #include <QLabel>
 #include <QLineEdit>
 #include <QPushButton>
 #include <QRadioButton>
+#include <QTableView>
 #include <QWidget>
+#include <atomic>
+#include <future>
 #include <memory>
 
 #include "Inputs.h"
 #include "MiniCalculator.h"
 #include "Outputs.h"
+#include "ions/IonTableModel.h"
+#include "mathieu_lib/stability_regions.h"
+#include "plot/IonOverlayPlotter.h"
 #include "plot/StabilityRegionPlotter.h"
 #include "stability/StabilityOutputs.h"
 
@@ -29,6 +36,17 @@ class MathieuWindow : public QWidget {
     QCustomPlot* stabilityPlotWidget;
     StabilityRegionPlotter* stabilityPlotter;
 
+    // Multi-ion overlay on the stability diagram
+    IonOverlayPlotter* ionOverlay = nullptr;
+    QPushButton* loadIonsButton;
+    QComboBox* ionColorCombo;
+    QCheckBox* heatmapCheck;
+    QCheckBox* higherRegionsCheck;
+
+    // Per-ion table for the loaded ion list
+    QTableView* ionTable;
+    IonTableModel* ionTableModel;
+
     // Stability outputs component
     StabilityOutputs* stabilityOutputs;
 
@@ -38,10 +56,25 @@ class MathieuWindow : public QWidget {
    private:
     void validateInputs();
     void handleCalculation();
+    void handlePlotHover(QMouseEvent* event);
+    void loadIonList();
+    void showHeatmap(bool visible);
+    void showHigherRegions(bool visible);
+    void updateIonViews();
     void setOutputInvalid();
     void setOutputValues(double omega_val, double particle_mass_val, double mathieu_q_val,
                          double mathieu_a_val, double beta_val, double secular_freq_val,
                          double mz_val, double lmco_val, double max_mz_val);
+
+    // Background rasterization of the margin heatmap; cancelled and awaited on destruction
+    std::shared_ptr<std::atomic<bool>> m_heatmapCancel = std::make_shared<std::atomic<bool>>(false);
+    std::future<void> m_heatmapTask;
+
+    // Higher stability regions, computed in the background on first use and cached per region
+    std::shared_ptr<::mathieu_lib::StabilityRegionCache> m_regionCache =
+        std::make_shared<::mathieu_lib::StabilityRegionCache>(10.0, 2001);
+    std::shared_ptr<std::atomic<bool>> m_regionCancel = std::make_shared<std::atomic<bool>>(false);
+    std::future<void> m_regionTask;
 };
 
 }  // namespace trappable
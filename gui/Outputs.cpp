@@ -79,6 +79,32 @@ Outputs::Outputs(QWidget* parent) : QWidget(parent) {
     layout->addWidget(maxMzValueLabel, row, 1);
     layout->addWidget(maxMzUnitLabel, row++, 2);
 
+    wellDepthValueLabel = new QLabel("-", this);
+    wellDepthValueLabel->setAlignment(Qt::AlignRight);
+    wellDepthUnitLabel = new QLabel("V", this);
+    auto* wellDepthLabel = new QLabel("Well depth:");
+    wellDepthLabel->setToolTip("Dehmelt pseudopotential depth of the shallower direction");
+    layout->addWidget(wellDepthLabel, row, 0);
+    layout->addWidget(wellDepthValueLabel, row, 1);
+    layout->addWidget(wellDepthUnitLabel, row++, 2);
+
+    adiabaticityValueLabel = new QLabel("-", this);
+    adiabaticityValueLabel->setAlignment(Qt::AlignRight);
+    adiabaticityUnitLabel = new QLabel("", this);
+    auto* adiabaticityLabel = new QLabel("Adiabaticity:");
+    adiabaticityLabel->setToolTip("The pseudopotential holds for adiabaticity below about 0.3");
+    layout->addWidget(adiabaticityLabel, row, 0);
+    layout->addWidget(adiabaticityValueLabel, row, 1);
+    layout->addWidget(adiabaticityUnitLabel, row++, 2);
+
+    maxEnergyValueLabel = new QLabel("-", this);
+    maxEnergyValueLabel->setAlignment(Qt::AlignRight);
+    maxEnergyUnitLabel = new QLabel("eV", this);
+    auto* maxEnergyLabel = new QLabel("Max energy:");
+    layout->addWidget(maxEnergyLabel, row, 0);
+    layout->addWidget(maxEnergyValueLabel, row, 1);
+    layout->addWidget(maxEnergyUnitLabel, row++, 2);
+
     setLayout(layout);
 }
 
@@ -94,19 +120,25 @@ void Outputs::setInvalid() {
     mzValueLabel->setText("-");
     lmcoValueLabel->setText("-");
     maxMzValueLabel->setText("-");
+    clearPseudopotential();
+}
+
+namespace {
+
+QString formatValue(double val) {
+    double absVal = std::abs(val);
+    if ((absVal > 0 && (absVal < 0.001 || absVal >= 10000))) {
+        return QString::number(val, 'e', 3);  // scientific notation, 3 decimals
+    } else {
+        return QString::number(val, 'f', 3);  // fixed, 3 decimals
+    }
 }
 
+}  // namespace
+
 void Outputs::setValues(double omega_val, double particle_mass_val, double mathieu_q_val,
                         double mathieu_a_val, double beta_val, double secular_freq_val,
                         double mz_val, double lmco_val, double max_mz_val) {
-    auto formatValue = [](double val) {
-        double absVal = std::abs(val);
-        if ((absVal > 0 && (absVal < 0.001 || absVal >= 10000))) {
-            return QString::number(val, 'e', 3);  // scientific notation, 3 decimals
-        } else {
-            return QString::number(val, 'f', 3);  // fixed, 3 decimals
-        }
-    };
     omegaValueLabel->setText(formatValue(omega_val));
     particleMassValueLabel->setText(formatValue(particle_mass_val));
     mathieuQValueLabel->setText(formatValue(mathieu_q_val));
@@ -117,3 +149,16 @@ void Outputs::setValues(double omega_val, double particle_mass_val, double mathi
     lmcoValueLabel->setText(formatValue(lmco_val));
     maxMzValueLabel->setText(formatValue(max_mz_val));
 }
+
+void Outputs::setPseudopotential(double depth_val, double adiabaticity_val,
+                                 double max_energy_val) {
+    wellDepthValueLabel->setText(formatValue(depth_val));
+    adiabaticityValueLabel->setText(formatValue(adiabaticity_val));
+    maxEnergyValueLabel->setText(formatValue(max_energy_val));
+}
+
+void Outputs::clearPseudopotential() {
+    wellDepthValueLabel->setText("-");
+    adiabaticityValueLabel->setText("-");
+    maxEnergyValueLabel->setText("-");
+}
@@ -15,6 +15,8 @@ class Outputs : public QWidget {
     void setValues(double omega_val, double particle_mass_val, double mathieu_q_val,
                    double mathieu_a_val, double beta_val, double secular_freq_val, double mz_val,
                    double lmco_val, double max_mz_val);
+    void setPseudopotential(double depth_val, double adiabaticity_val, double max_energy_val);
+    void clearPseudopotential();
     QLabel* omegaValueLabel;
     QLabel* omegaUnitLabel;
     QLabel* particleMassValueLabel;
@@ -33,6 +35,12 @@ class Outputs : public QWidget {
     QLabel* lmcoUnitLabel;
     QLabel* maxMzValueLabel;
     QLabel* maxMzUnitLabel;
+    QLabel* wellDepthValueLabel;
+    QLabel* wellDepthUnitLabel;
+    QLabel* adiabaticityValueLabel;
+    QLabel* adiabaticityUnitLabel;
+    QLabel* maxEnergyValueLabel;
+    QLabel* maxEnergyUnitLabel;
 };
 
 #endif  // OUTPUTS_H
@@ -0,0 +1,315 @@
+#include "IonTableModel.h"
+
+#include <QString>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include "mathieu_lib/thread_pool.h"
+#include "stability/StabilityCalculator.h"
+
+namespace {
+
+QString formatValue(double val) {
+    if (std::isnan(val))
+        return QStringLiteral("-");
+    double absVal = std::abs(val);
+    if ((absVal > 0 && (absVal < 0.001 || absVal >= 10000))) {
+        return QString::number(val, 'e', 3);  // scientific notation, 3 decimals
+    } else {
+        return QString::number(val, 'f', 3);  // fixed, 3 decimals
+    }
+}
+
+// Sort keys with NaN (e.g. no stable window) always placed last
+bool keyLess(double l, double r) {
+    if (std::isnan(l))
+        return false;
+    if (std::isnan(r))
+        return true;
+    return l < r;
+}
+
+}  // namespace
+
+IonTableModel::IonTableModel(QObject* parent) : QAbstractTableModel(parent) {}
+
+IonTableModel::~IonTableModel() {
+    // Sort tasks capture `this`; let them finish before the object goes away
+    for (auto& task : m_sortTasks) task.wait();
+}
+
+void IonTableModel::setIons(std::vector<double> mzs, std::vector<int> charge_states) {
+    beginResetModel();
+    charge_states.resize(mzs.size(), 1);
+    m_mz = std::move(mzs);
+    m_chargeStates = std::move(charge_states);
+    m_order.resize(m_mz.size());
+    std::iota(m_order.begin(), m_order.end(), 0);
+    m_cache.resize(m_mz.size());
+    ++m_generation;
+    m_sorting = false;
+    invalidateCache();
+    endResetModel();
+    if (m_sortColumn >= 0)
+        sort(m_sortColumn, m_sortOrder);
+}
+
+void IonTableModel::setOperatingPoint(double voltage_rf, double voltage_dc,
+                                      const mathieu_lib::QuadrupoleParams& params) {
+    OperatingPoint point;
+    point.frequency = params.frequency;
+    // The broadcast kernels evaluated at m/z = 1 give the per-ion scale factors
+    const double unit_mz = 1.0;
+    mathieu_lib::mathieu_q_from_mz(voltage_rf, params, &unit_mz, 1, &point.q_per_inverse_mz);
+    mathieu_lib::mathieu_a_from_mz(voltage_dc, params, &unit_mz, 1, &point.a_per_inverse_mz);
+    point.valid = std::isfinite(point.q_per_inverse_mz) && std::isfinite(point.a_per_inverse_mz);
+
+    // Every ion sits on the scan line a = (a/q) q; find where that line is stable
+    point.window_low = std::numeric_limits<double>::quiet_NaN();
+    point.window_high = std::numeric_limits<double>::quiet_NaN();
+    if (point.valid && point.q_per_inverse_mz > 0.0) {
+        const double slope = point.a_per_inverse_mz / point.q_per_inverse_mz;
+        constexpr int kSamples = 2048;
+        auto stableAt = [slope](double q) { return StabilityCalculator::isStable(q, slope * q); };
+        auto refine = [&stableAt](double stable_q, double unstable_q) {
+            for (int i = 0; i < 50; ++i) {
+                double mid = 0.5 * (stable_q + unstable_q);
+                (stableAt(mid) ? stable_q : unstable_q) = mid;
+            }
+            return stable_q;
+        };
+        const double step = mathieu_lib::MAX_Q / kSamples;
+        int first = -1, last = -1;
+        for (int i = 1; i <= kSamples; ++i) {
+            if (stableAt(step * i)) {
+                if (first < 0)
+                    first = i;
+                last = i;
+            }
+        }
+        if (first > 0) {
+            double q_low = refine(step * first, step * (first - 1));
+            double q_high = last < kSamples ? refine(step * last, step * (last + 1))
+                                            : mathieu_lib::MAX_Q;
+            point.window_low = point.q_per_inverse_mz / q_high;
+            point.window_high = point.q_per_inverse_mz / q_low;
+        }
+    }
+
+    const bool wasSorting = m_sorting;
+    m_point = point;
+    ++m_generation;
+    m_sorting = false;
+    invalidateCache();
+    if (!m_mz.empty())
+        emit dataChanged(index(0, QColumn), index(rowCount() - 1, ColumnCount - 1));
+    // Derived columns change order with the operating point; an interrupted sort is restarted
+    if (m_sortColumn >= QColumn || (wasSorting && m_sortColumn >= 0))
+        sort(m_sortColumn, m_sortOrder);
+}
+
+int IonTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_order.size());
+}
+
+int IonTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant IonTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= rowCount())
+        return QVariant();
+    if (role == Qt::TextAlignmentRole)
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+    if (role != Qt::DisplayRole)
+        return QVariant();
+
+    const int ion = m_order[index.row()];
+    switch (index.column()) {
+        case MzColumn:
+            return formatValue(m_mz[ion]);
+        case ChargeColumn:
+            return m_chargeStates[ion];
+        default:
+            break;
+    }
+    if (!m_point.valid)
+        return QStringLiteral("-");
+    const RowValues& row = rowValues(ion);
+    if (index.column() == StableColumn)
+        return row.stable ? QStringLiteral("Yes") : QStringLiteral("No");
+    return formatValue(columnValue(row, m_mz[ion], m_chargeStates[ion], index.column()));
+}
+
+QVariant IonTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (role != Qt::DisplayRole)
+        return QVariant();
+    if (orientation == Qt::Vertical)
+        return section + 1;
+    switch (section) {
+        case MzColumn:
+            return QStringLiteral("m/z (Da)");
+        case ChargeColumn:
+            return QStringLiteral("z");
+        case QColumn:
+            return QStringLiteral("q");
+        case AColumn:
+            return QStringLiteral("a");
+        case BetaColumn:
+            return QStringLiteral("Beta");
+        case SecularFrequencyColumn:
+            return QStringLiteral("Secular freq. (kHz)");
+        case MzMarginColumn:
+            return QStringLiteral("m/z window margin (Da)");
+        case DeltaAColumn:
+            return QStringLiteral("Δa");
+        case DeltaEColumn:
+            return QStringLiteral("Δₑ");
+        case StableColumn:
+            return QStringLiteral("Stable");
+        default:
+            return QVariant();
+    }
+}
+
+void IonTableModel::sort(int column, Qt::SortOrder order) {
+    m_sortColumn = column;
+    m_sortOrder = order;
+    if (m_mz.empty() || column < 0 || column >= ColumnCount)
+        return;
+    const std::uint64_t ticket = ++m_generation;
+    m_sorting = true;
+    // Forget finished tasks; the rest are waited for on destruction
+    m_sortTasks.erase(std::remove_if(m_sortTasks.begin(), m_sortTasks.end(),
+                                     [](const std::future<void>& task) {
+                                         return task.wait_for(std::chrono::seconds(0)) ==
+                                                std::future_status::ready;
+                                     }),
+                      m_sortTasks.end());
+    // The task gets its own copies so the GUI thread can keep reading the live columns
+    auto& pool = mathieu_lib::ThreadPool::global();
+    m_sortTasks.push_back(pool.async([this, &pool, ticket, column, order, mzs = m_mz,
+                                      charges = m_chargeStates, point = m_point]() {
+        const std::size_t n = mzs.size();
+        std::vector<double> keys(n);
+        std::vector<RowValues> rows;
+        const bool needsRows = point.valid && column >= MzMarginColumn;
+        if (needsRows) {
+            // Margins are not monotone in m/z, so the full column has to be computed
+            rows.resize(n);
+            pool.parallel_for(0, n, [&](std::size_t first, std::size_t last) {
+                for (std::size_t i = first; i < last; ++i) {
+                    rows[i] = computeRow(point, mzs[i]);
+                    keys[i] = columnValue(rows[i], mzs[i], charges[i], column);
+                }
+            });
+        } else {
+            for (std::size_t i = 0; i < n; ++i) {
+                switch (column) {
+                    case MzColumn:
+                        keys[i] = mzs[i];
+                        break;
+                    case ChargeColumn:
+                        keys[i] = charges[i];
+                        break;
+                    case AColumn:
+                        keys[i] = point.a_per_inverse_mz / mzs[i];
+                        break;
+                    default:  // q, beta and secular frequency all grow with q
+                        keys[i] = point.q_per_inverse_mz / mzs[i];
+                        break;
+                }
+            }
+        }
+        std::vector<int> newOrder(n);
+        std::iota(newOrder.begin(), newOrder.end(), 0);
+        if (order == Qt::AscendingOrder) {
+            std::stable_sort(newOrder.begin(), newOrder.end(),
+                             [&keys](int l, int r) { return keyLess(keys[l], keys[r]); });
+        } else {
+            std::stable_sort(newOrder.begin(), newOrder.end(),
+                             [&keys](int l, int r) { return keyLess(-keys[l], -keys[r]); });
+        }
+        QMetaObject::invokeMethod(
+            this,
+            [this, ticket, newOrder = std::move(newOrder), rows = std::move(rows)]() mutable {
+                if (ticket != m_generation)
+                    return;  // superseded by newer inputs or another sort
+                emit layoutAboutToBeChanged();
+                // Keep selections and the current index on the same ions
+                std::vector<int> rowOfIon(newOrder.size());
+                for (std::size_t row = 0; row < newOrder.size(); ++row)
+                    rowOfIon[newOrder[row]] = static_cast<int>(row);
+                const QModelIndexList oldIndexes = persistentIndexList();
+                QModelIndexList newIndexes;
+                newIndexes.reserve(oldIndexes.size());
+                for (const QModelIndex& idx : oldIndexes)
+                    newIndexes.append(index(rowOfIon[m_order[idx.row()]], idx.column()));
+                changePersistentIndexList(oldIndexes, newIndexes);
+                m_order = std::move(newOrder);
+                if (!rows.empty()) {
+                    m_cache = std::move(rows);
+                    m_cached.assign(m_cache.size(), 1);
+                }
+                m_sorting = false;
+                emit layoutChanged();
+                emit sortingFinished();
+            },
+            Qt::QueuedConnection);
+    }));
+}
+
+IonTableModel::RowValues IonTableModel::computeRow(const OperatingPoint& point, double mz_val) {
+    RowValues row;
+    row.q = point.q_per_inverse_mz / mz_val;
+    row.a = point.a_per_inverse_mz / mz_val;
+    row.beta = mathieu_lib::beta(row.q);
+    row.secular_frequency = mathieu_lib::secular_frequency(point.frequency, row.q);
+    row.mz_margin = std::min(mz_val - point.window_low, point.window_high - mz_val);
+    StabilityCalculator::PointMetrics metrics = StabilityCalculator::evaluatePoint(row.q, row.a);
+    row.delta_a = metrics.delta_a;
+    row.delta_e = metrics.delta_e;
+    row.stable = metrics.stable;
+    return row;
+}
+
+double IonTableModel::columnValue(const RowValues& row, double mz_val, int charge_state,
+                                  int column) {
+    switch (column) {
+        case MzColumn:
+            return mz_val;
+        case ChargeColumn:
+            return charge_state;
+        case QColumn:
+            return row.q;
+        case AColumn:
+            return row.a;
+        case BetaColumn:
+            return row.beta;
+        case SecularFrequencyColumn:
+            return row.secular_frequency;
+        case MzMarginColumn:
+            return row.mz_margin;
+        case DeltaAColumn:
+            return row.delta_a;
+        case DeltaEColumn:
+            return row.delta_e;
+        case StableColumn:
+            return row.stable ? 1.0 : 0.0;
+        default:
+            return std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+const IonTableModel::RowValues& IonTableModel::rowValues(int ion) const {
+    if (!m_cached[ion]) {
+        m_cache[ion] = computeRow(m_point, m_mz[ion]);
+        m_cached[ion] = 1;
+    }
+    return m_cache[ion];
+}
+
+void IonTableModel::invalidateCache() { m_cached.assign(m_mz.size(), 0); }
@@ -0,0 +1,91 @@
+#ifndef IONTABLEMODEL_H
+#define IONTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <cstdint>
+#include <future>
+#include <vector>
+
+#include "mathieu_lib/mathieu.h"
+
+/**
+ * @brief Virtualized table model for very large ion lists.
+ *
+ * Ion inputs and derived values are stored column by column. Derived values are computed
+ * lazily the first time a row is displayed and cached until the operating point changes,
+ * so only visible rows ever cost anything. Sorting runs on mathieu_lib's shared thread pool
+ * over copies of the columns and swaps in the new row order when done.
+ */
+class IonTableModel : public QAbstractTableModel {
+    Q_OBJECT
+   public:
+    enum Column {
+        MzColumn,
+        ChargeColumn,
+        QColumn,
+        AColumn,
+        BetaColumn,
+        SecularFrequencyColumn,
+        MzMarginColumn,
+        DeltaAColumn,
+        DeltaEColumn,
+        StableColumn,
+        ColumnCount
+    };
+
+    explicit IonTableModel(QObject* parent = nullptr);
+    ~IonTableModel() override;
+
+    void setIons(std::vector<double> mzs, std::vector<int> charge_states);
+    void setOperatingPoint(double voltage_rf, double voltage_dc,
+                           const mathieu_lib::QuadrupoleParams& params);
+    bool isSorting() const { return m_sorting; }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+   signals:
+    void sortingFinished();
+
+   private:
+    // Everything needed to compute a row, copied by value into sort workers
+    struct OperatingPoint {
+        bool valid = false;
+        double frequency = 0.0;
+        double q_per_inverse_mz = 0.0;  // q = q_per_inverse_mz / (m/z)
+        double a_per_inverse_mz = 0.0;  // a = a_per_inverse_mz / (m/z)
+        double window_low = 0.0;        // stable m/z window along the scan line, in Da
+        double window_high = 0.0;
+    };
+    struct RowValues {
+        double q, a, beta, secular_frequency, mz_margin, delta_a, delta_e;
+        bool stable;
+    };
+
+    static RowValues computeRow(const OperatingPoint& point, double mz_val);
+    static double columnValue(const RowValues& row, double mz_val, int charge_state, int column);
+    const RowValues& rowValues(int ion) const;
+    void invalidateCache();
+
+    std::vector<double> m_mz;
+    std::vector<int> m_chargeStates;
+    std::vector<int> m_order;  // view row -> ion index
+    OperatingPoint m_point;
+
+    // Lazily filled per-ion cache
+    mutable std::vector<RowValues> m_cache;
+    mutable std::vector<std::uint8_t> m_cached;
+
+    // Bumped whenever inputs change or a new sort starts so stale sort results are dropped
+    std::uint64_t m_generation = 0;
+    bool m_sorting = false;
+    int m_sortColumn = -1;
+    Qt::SortOrder m_sortOrder = Qt::AscendingOrder;
+    std::vector<std::future<void>> m_sortTasks;  // running on mathieu_lib's shared pool
+};
+
+#endif  // IONTABLEMODEL_H
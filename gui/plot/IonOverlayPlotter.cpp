@@ -0,0 +1,138 @@
+#include "IonOverlayPlotter.h"
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+#include "stability/StabilityCalculator.h"
+
+namespace {
+// Above this many points per bucket, scatter skipping kicks in to keep replots smooth
+constexpr int kMaxDrawnScatters = 20000;
+
+// Vertical margin (Δa) band edges for ColorMode::Margin
+constexpr double kMarginBands[] = {0.01, 0.03, 0.06};
+
+const QColor kUnstableColor(220, 30, 30);
+const QColor kStableColor(20, 160, 60);
+const QColor kMarginColors[] = {QColor(255, 140, 0), QColor(230, 200, 0), QColor(120, 200, 60),
+                                QColor(20, 160, 60)};
+}  // namespace
+
+IonOverlayPlotter::IonOverlayPlotter(QCustomPlot* plot) : m_plot(plot) {}
+
+IonOverlayPlotter::~IonOverlayPlotter() {}
+
+void IonOverlayPlotter::setIons(const std::vector<double>& mzs,
+                                const std::vector<int>& charge_states) {
+    std::vector<std::size_t> order(mzs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](std::size_t l, std::size_t r) {
+        return mzs[l] > mzs[r];
+    });
+    m_mz.resize(mzs.size());
+    m_chargeStates.resize(mzs.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        m_mz[i] = mzs[order[i]];
+        m_chargeStates[i] = i < charge_states.size() ? charge_states[order[i]] : 1;
+    }
+    m_q.assign(m_mz.size(), 0.0);
+    m_a.assign(m_mz.size(), 0.0);
+    m_hasVoltages = false;
+    removeGraphs();
+}
+
+void IonOverlayPlotter::updateVoltages(double voltage_rf, double voltage_dc,
+                                       const mathieu_lib::QuadrupoleParams& params) {
+    if (!m_plot || m_mz.empty())
+        return;
+    bool geometryChanged = !m_hasVoltages || params.frequency != m_frequency ||
+                           params.quad_radius != m_quadRadius;
+    // Only the columns whose voltage (or the geometry) changed are recomputed
+    if (geometryChanged || voltage_rf != m_voltageRf)
+        mathieu_lib::mathieu_q_from_mz(voltage_rf, params, m_mz.data(), m_mz.size(), m_q.data());
+    if (geometryChanged || voltage_dc != m_voltageDc)
+        mathieu_lib::mathieu_a_from_mz(voltage_dc, params, m_mz.data(), m_mz.size(), m_a.data());
+    m_hasVoltages = true;
+    m_voltageRf = voltage_rf;
+    m_voltageDc = voltage_dc;
+    m_frequency = params.frequency;
+    m_quadRadius = params.quad_radius;
+    refreshGraphs();
+}
+
+void IonOverlayPlotter::setColorMode(ColorMode mode) {
+    if (mode == m_colorMode)
+        return;
+    m_colorMode = mode;
+    removeGraphs();
+    if (m_hasVoltages)
+        refreshGraphs();
+}
+
+void IonOverlayPlotter::clear() {
+    removeGraphs();
+    m_mz.clear();
+    m_chargeStates.clear();
+    m_q.clear();
+    m_a.clear();
+    m_hasVoltages = false;
+    if (m_plot)
+        m_plot->replot();
+}
+
+void IonOverlayPlotter::createGraphs() {
+    auto addBucket = [this](const QColor& color) {
+        QCPGraph* graph = m_plot->addGraph();
+        graph->setLineStyle(QCPGraph::lsNone);
+        graph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDisc, color, 4));
+        graph->setAdaptiveSampling(true);
+        graph->setAntialiasedScatters(false);
+        graph->setSelectable(QCP::stNone);
+        m_graphs.append(graph);
+    };
+    if (m_colorMode == ColorMode::StabilityState) {
+        addBucket(kUnstableColor);
+        addBucket(kStableColor);
+    } else {
+        addBucket(kUnstableColor);
+        for (const QColor& color : kMarginColors) addBucket(color);
+    }
+}
+
+void IonOverlayPlotter::removeGraphs() {
+    if (!m_plot)
+        return;
+    for (QCPGraph* graph : m_graphs) m_plot->removeGraph(graph);
+    m_graphs.clear();
+}
+
+void IonOverlayPlotter::refreshGraphs() {
+    if (m_graphs.isEmpty())
+        createGraphs();
+    QVector<QVector<QCPGraphData>> buckets(m_graphs.size());
+    for (auto& bucket : buckets) bucket.reserve(static_cast<int>(m_q.size() / buckets.size()));
+    for (std::size_t i = 0; i < m_q.size(); ++i) {
+        const double q = m_q[i];
+        const double a = m_a[i];
+        int bucket = 0;
+        if (StabilityCalculator::isStable(q, a)) {
+            if (m_colorMode == ColorMode::StabilityState) {
+                bucket = 1;
+            } else {
+                const double margin = StabilityCalculator::calculateUpperBoundary(q) - a;
+                bucket = 1 + static_cast<int>(std::upper_bound(std::begin(kMarginBands),
+                                                               std::end(kMarginBands), margin) -
+                                              std::begin(kMarginBands));
+            }
+        }
+        buckets[bucket].append(QCPGraphData(q, a));
+    }
+    // Ions are stored by descending m/z, so every bucket is already sorted by q
+    for (int i = 0; i < m_graphs.size(); ++i) {
+        const int count = buckets[i].size();
+        m_graphs[i]->setScatterSkip(std::max(0, count / kMaxDrawnScatters - 1));
+        m_graphs[i]->data()->set(buckets[i], true);
+    }
+    m_plot->replot();
+}
@@ -0,0 +1,55 @@
+#ifndef IONOVERLAYPLOTTER_H
+#define IONOVERLAYPLOTTER_H
+
+#include <QVector>
+#include <vector>
+
+#include "QCustomPlot/qcustomplot.h"
+#include "mathieu_lib/mathieu.h"
+
+/**
+ * @brief Scatter overlay of many ion species on the stability diagram.
+ *
+ * Holds the loaded ion list in columnar form, computes all (q, a) points with the mathieu_lib
+ * broadcast kernels and renders them as one logical scatter layer. QCPGraph only supports a
+ * single scatter colour, so the layer is split into a fixed set of colour buckets (stability
+ * state or margin band), each a scatter-only graph with adaptive sampling.
+ */
+class IonOverlayPlotter {
+   public:
+    enum class ColorMode { StabilityState, Margin };
+
+    explicit IonOverlayPlotter(QCustomPlot* plot);
+    ~IonOverlayPlotter();
+
+    void setIons(const std::vector<double>& mzs, const std::vector<int>& charge_states);
+    void updateVoltages(double voltage_rf, double voltage_dc,
+                        const mathieu_lib::QuadrupoleParams& params);
+    void setColorMode(ColorMode mode);
+    void clear();
+    std::size_t ionCount() const { return m_mz.size(); }
+
+   private:
+    void createGraphs();
+    void removeGraphs();
+    void refreshGraphs();
+
+    QCustomPlot* m_plot;
+    ColorMode m_colorMode = ColorMode::StabilityState;
+    QVector<QCPGraph*> m_graphs;
+
+    // Ion columns, sorted by descending m/z so q (and the graph key) is ascending
+    std::vector<double> m_mz;
+    std::vector<int> m_chargeStates;
+    std::vector<double> m_q;
+    std::vector<double> m_a;
+
+    // Last inputs, used to skip recomputing columns whose voltage did not change
+    bool m_hasVoltages = false;
+    double m_voltageRf = 0.0;
+    double m_voltageDc = 0.0;
+    double m_frequency = 0.0;
+    double m_quadRadius = 0.0;
+};
+
+#endif  // IONOVERLAYPLOTTER_H
@@ -3,6 +3,7 @@
 
 #include <QVector>
 #include <QtMath>
+#include <iterator>
 
 #include "QCustomPlot/qcustomplot.h"
 #include "mathieu_lib/mathieu.h"
@@ -166,4 +167,119 @@ void StabilityRegionPlotter::clearPlot() {
     m_plot->replot();
 }
 
+/**
+ * @brief Create (or reset) the margin heatmap for a qCells x aCells grid whose cell centers
+ *        span [qMin, qMax] x [aMin, aMax]. Cells stay transparent until their rows arrive.
+ */
+void StabilityRegionPlotter::beginHeatmap(int qCells, int aCells, double qMin, double qMax,
+                                          double aMin, double aMax) {
+    if (!m_plot)
+        return;
+    if (!m_heatmap) {
+        m_plot->addLayer(QStringLiteral("heatmap"), m_plot->layer(QStringLiteral("main")),
+                         QCustomPlot::limBelow);
+        m_heatmap = new QCPColorMap(m_plot->xAxis, m_plot->yAxis);
+        m_heatmap->setLayer(QStringLiteral("heatmap"));
+        m_heatmap->setInterpolate(true);
+        // Red outside the region, white on the boundary, green deep inside
+        QCPColorGradient gradient;
+        gradient.setColorStops(
+            {{0.0, QColor(200, 40, 40)}, {0.5, Qt::white}, {1.0, QColor(30, 150, 60)}});
+        gradient.setNanHandling(QCPColorGradient::nhTransparent);
+        m_heatmap->setGradient(gradient);
+        m_heatmap->setDataRange(QCPRange(-0.15, 0.15));
+    }
+    m_heatmap->data()->setSize(qCells, aCells);
+    m_heatmap->data()->setRange(QCPRange(qMin, qMax), QCPRange(aMin, aMax));
+    m_heatmap->data()->fill(qQNaN());
+    m_heatmap->setVisible(true);
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+/**
+ * @brief Copy finished rows (row-major, q fastest) into the heatmap and queue a repaint;
+ *        bursts of bands coalesce into one replot.
+ */
+void StabilityRegionPlotter::setHeatmapRows(int firstRow, int rows, const double* margins) {
+    if (!m_heatmap)
+        return;
+    QCPColorMapData* data = m_heatmap->data();
+    const int columns = data->keySize();
+    for (int row = 0; row < rows; ++row)
+        for (int column = 0; column < columns; ++column)
+            data->setCell(column, firstRow + row, margins[row * columns + column]);
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+void StabilityRegionPlotter::setHeatmapVisible(bool visible) {
+    if (!m_heatmap)
+        return;
+    m_heatmap->setVisible(visible);
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+/**
+ * @brief Replace the higher-region outlines. Each span is drawn as one closed curve, lower
+ *        bound out and upper bound back, coloured per region; the first region keeps its own
+ *        filled curve and is skipped here.
+ */
+void StabilityRegionPlotter::setHigherRegions(
+    const std::vector<std::shared_ptr<const mathieu_lib::StabilityRegion>>& regions, double qMax) {
+    if (!m_plot)
+        return;
+    for (QCPCurve* curve : m_higherRegions) m_plot->removePlottable(curve);
+    m_higherRegions.clear();
+    static const QColor kColors[] = {QColor(200, 90, 20), QColor(120, 60, 180),
+                                     QColor(20, 140, 140), QColor(180, 40, 110)};
+    double aMin = 0.0;
+    double aMax = 0.25;
+    int colorIndex = 0;
+    for (const auto& region : regions) {
+        if (region->id == mathieu_lib::RegionId{0, 0})
+            continue;
+        const QColor color = kColors[colorIndex++ % std::size(kColors)];
+        for (const mathieu_lib::RegionSpan& span : region->spans) {
+            QVector<double> q;
+            QVector<double> a;
+            for (std::size_t i = 0; i < span.q.size(); ++i) {
+                q.append(span.q[i]);
+                a.append(span.a_lower[i]);
+                aMin = qMin(aMin, span.a_lower[i]);
+            }
+            for (std::size_t i = span.q.size(); i-- > 0;) {
+                q.append(span.q[i]);
+                a.append(span.a_upper[i]);
+                aMax = qMax(aMax, span.a_upper[i]);
+            }
+            auto* curve = new QCPCurve(m_plot->xAxis, m_plot->yAxis);
+            curve->setData(q, a);
+            curve->setPen(QPen(color, 2));
+            QColor fill = color;
+            fill.setAlpha(80);
+            curve->setBrush(QBrush(fill));
+            curve->setName(QStringLiteral("Region (%1, %2)")
+                               .arg(region->id.x_order)
+                               .arg(region->id.y_order));
+            m_higherRegions.append(curve);
+        }
+    }
+    m_higherQRange = QCPRange(0.0, qMax);
+    m_higherARange = QCPRange(aMin, aMax);
+    setHigherRegionsVisible(true);
+}
+
+void StabilityRegionPlotter::setHigherRegionsVisible(bool visible) {
+    if (!m_plot)
+        return;
+    for (QCPCurve* curve : m_higherRegions) curve->setVisible(visible);
+    if (visible && !m_higherRegions.isEmpty()) {
+        m_plot->xAxis->setRange(m_higherQRange);
+        m_plot->yAxis->setRange(m_higherARange);
+    } else {
+        m_plot->xAxis->setRange(0, mathieu_lib::MAX_Q);
+        m_plot->yAxis->setRange(0, 0.25);
+    }
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
+
 StabilityRegionPlotter::~StabilityRegionPlotter() {}
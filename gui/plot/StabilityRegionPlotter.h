@@ -1,7 +1,11 @@
 #ifndef STABILITYREGIONPLOTTER_H
 #define STABILITYREGIONPLOTTER_H
 
+#include <memory>
+#include <vector>
+
 #include "QCustomPlot/qcustomplot.h"
+#include "mathieu_lib/stability_regions.h"
 
 class StabilityRegionPlotter {
    public:
@@ -14,9 +18,27 @@ class StabilityRegionPlotter {
     void drawUnstablePoint(double q, double a);
     double calculateUpperBoundary(double q);
 
+    // Stability-margin heatmap beneath the region outline, filled in band by band
+    void beginHeatmap(int qCells, int aCells, double qMin, double qMax, double aMin, double aMax);
+    void setHeatmapRows(int firstRow, int rows, const double* margins);
+    void setHeatmapVisible(bool visible);
+    bool hasHeatmap() const { return m_heatmap != nullptr; }
+
+    // Outlines of further stability regions; showing them zooms out to qMax, hiding them
+    // returns to the first region
+    void setHigherRegions(
+        const std::vector<std::shared_ptr<const mathieu_lib::StabilityRegion>>& regions,
+        double qMax);
+    void setHigherRegionsVisible(bool visible);
+    bool hasHigherRegions() const { return !m_higherRegions.isEmpty(); }
+
    private:
     QCustomPlot* m_plot;
     QCPGraph* m_pointGraph;
+    QCPColorMap* m_heatmap = nullptr;
+    QVector<QCPCurve*> m_higherRegions;
+    QCPRange m_higherQRange;
+    QCPRange m_higherARange;
     QCPItemLine* m_verticalLine = nullptr;
     QCPItemLine* m_leftHorizontalLine = nullptr;
     QCPItemLine* m_rightHorizontalLine = nullptr;
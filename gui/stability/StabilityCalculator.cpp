@@ -4,41 +4,12 @@
 #include <QVector>
 
 #include "mathieu_lib/mathieu.h"
+#include "mathieu_lib/stability.h"
 
 namespace StabilityCalculator {
 
 std::pair<double, double> findNearestBoundaryPoint(double q, double a) {
-    constexpr double min_q = 0.0;
-    constexpr double max_q = mathieu_lib::MAX_Q;
-    constexpr double coarse_step = 0.001;
-    constexpr double fine_window = 0.01;
-    constexpr double fine_step = 0.00001;
-    double min_dist = 1e9;
-    double best_q = q, best_a = a;
-    // Coarse search
-    for (double q_b = min_q; q_b <= max_q; q_b += coarse_step) {
-        double a_b = calculateUpperBoundary(q_b);
-        double dist = qSqrt((q - q_b) * (q - q_b) + (a - a_b) * (a - a_b));
-        if (dist < min_dist) {
-            min_dist = dist;
-            best_q = q_b;
-            best_a = a_b;
-        }
-    }
-    // Fine search around best_q
-    min_dist = 1e9;
-    double fine_min_q = std::max(min_q, best_q - fine_window);
-    double fine_max_q = std::min(max_q, best_q + fine_window);
-    for (double q_b = fine_min_q; q_b <= fine_max_q; q_b += fine_step) {
-        double a_b = calculateUpperBoundary(q_b);
-        double dist = qSqrt((q - q_b) * (q - q_b) + (a - a_b) * (a - a_b));
-        if (dist < min_dist) {
-            min_dist = dist;
-            best_q = q_b;
-            best_a = a_b;
-        }
-    }
-    return {best_q, best_a};
+    return mathieu_lib::nearest_boundary_point(q, a);
 }
 
 QVector2D boundaryTangent(double q_b) {
@@ -57,21 +28,7 @@ double angleBetweenVectors(const QVector2D& v1, const QVector2D& v2) {
     cos_theta = std::max(-1.0, std::min(1.0, cos_theta));
     return qRadiansToDegrees(qAcos(cos_theta));
 }
-double calculateUpperBoundary(double q) {
-    if (q <= 0.4) {
-        return (q * q / 2.0) - (7.0 * qPow(q, 4) / 128.0);
-    } else if (q <= 0.706) {
-        return (q * q / 2.0) - (7.0 * qPow(q, 4) / 128.0) + (29.0 * qPow(q, 6) / 2304.0) -
-               (68687.0 * qPow(q, 8) / 18874368.0);
-    } else if (q <= mathieu_lib::MAX_Q) {
-        double q0 = 0.706;
-        double a0 = (q0 * q0 / 2.0) - (7.0 * qPow(q0, 4) / 128.0) + (29.0 * qPow(q0, 6) / 2304.0) -
-                    (68687.0 * qPow(q0, 8) / 18874368.0);
-        double t = (q - q0) / (mathieu_lib::MAX_Q - q0);
-        return a0 * (1.0 - t);
-    }
-    return 0.0;
-}
+double calculateUpperBoundary(double q) { return mathieu_lib::upper_boundary(q); }
 
 double verticalDistance(double a, double q) {
     auto [q_b, a_b] = findNearestBoundaryPoint(q, a);
@@ -111,4 +68,23 @@ double normalizedStabilityMargin(double a, double a_boundary, double q, double q
     double a_max = a_boundary;  // For now, use a_boundary as max
     return de / qSqrt(a_max * a_max + q_boundary * q_boundary);
 }
+
+bool isStable(double q, double a) { return mathieu_lib::is_stable(q, a); }
+
+PointMetrics evaluatePoint(double q, double a) {
+    mathieu_lib::BoundaryMargins margins = mathieu_lib::boundary_margins(q, a);
+    PointMetrics metrics;
+    metrics.q = q;
+    metrics.a = a;
+    metrics.stable = margins.stable;
+    const auto directions = static_cast<unsigned>(mathieu_lib::classify_stability(q, a));
+    metrics.stable_x = (directions & static_cast<unsigned>(mathieu_lib::StabilityClass::X)) != 0;
+    metrics.stable_y = (directions & static_cast<unsigned>(mathieu_lib::StabilityClass::Y)) != 0;
+    metrics.q_boundary = margins.q_boundary;
+    metrics.a_boundary = margins.a_boundary;
+    metrics.delta_a = margins.delta_a;
+    metrics.delta_q = margins.delta_q;
+    metrics.delta_e = margins.delta_e;
+    return metrics;
+}
 }  // namespace StabilityCalculator
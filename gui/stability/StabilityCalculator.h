@@ -6,6 +6,21 @@
 #include <QtMath>
 
 namespace StabilityCalculator {
+
+// Boundary metrics for a single (q, a) point, cheap enough to evaluate per mouse-move.
+struct PointMetrics {
+    double q;
+    double a;
+    bool stable;
+    bool stable_x;  // confined in x / y, from the four first-region boundaries
+    bool stable_y;
+    double q_boundary;
+    double a_boundary;
+    double delta_a;
+    double delta_q;
+    double delta_e;
+};
+
 double calculateUpperBoundary(double q);
 double verticalDistance(double a, double a_boundary);
 double horizontalDistance(double q, double a);
@@ -13,6 +28,8 @@ double euclideanDistance(double a, double q);
 double angularOffset(double a, double a_boundary, double q, double q_boundary);
 double normalizedStabilityMargin(double a, double a_boundary, double q, double q_boundary);
 std::pair<double, double> findNearestBoundaryPoint(double q, double a);
+bool isStable(double q, double a);
+PointMetrics evaluatePoint(double q, double a);
 
 }  // namespace StabilityCalculator
 #endif  // STABILITYCALCULATOR_H
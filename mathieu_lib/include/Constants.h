@@ -3,6 +3,9 @@
 
 constexpr double E_CHARGE = 1.602176E-19;          // elementary charge in coulombs
 constexpr double AVOGADRO_NUMBER = 6.02214076E23;  // Avogadro's number in mol^-1
+constexpr double BOLTZMANN = 1.380649E-23;         // Boltzmann constant in J/K
+constexpr double EPSILON_0 = 8.8541878128E-12;     // vacuum permittivity in F/m
+constexpr double PROTON_MASS = 1.007276466812;     // proton mass in Da
 constexpr double MIN_Q = 0.25;                     // Minimum stable q value for quadrupole
 constexpr double MAX_Q = 0.908;                    // Maximum stable q value for quadrupole
 #ifndef M_PI
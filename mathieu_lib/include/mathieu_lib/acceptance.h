@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include "mathieu_lib/hill_equation.h"
+
+namespace mathieu_lib {
+
+/**
+ * Linear phase-space optics of a quadrupole filter.
+ *
+ * Each direction obeys Hill's equation, so a stable ion keeps the Courant-Snyder invariant
+ * gamma u^2 + 2 alpha u u' + beta u'^2 = eps, where alpha, beta, gamma follow the RF phase
+ * xi = Omega t / 2 with period pi. Coordinates are u (m) and u' = du/dxi (m; the velocity is
+ * Omega / 2 times u'), so beta is dimensionless and eps is in m^2. The ion clears the rods at
+ * r0 in that direction iff eps <= r0^2 / max beta, the acceptance.
+ */
+struct Twiss {
+    double alpha = 0.0;
+    double beta = 1.0;
+    double gamma = 1.0;  // (1 + alpha^2) / beta
+
+    auto invariant(double u, double du) const -> double {
+        return gamma * u * u + 2.0 * alpha * u * du + beta * du * du;
+    }
+};
+
+struct PhaseSpacePoint {
+    double u;
+    double du;
+};
+
+// One direction over a period: twiss[k] at xi = k pi / twiss.size()
+struct TwissTable {
+    double phase_advance = 0.0;  // radians per RF period, pi beta_u; 0 if unstable
+    double acceptance = 0.0;     // m^2; 0 if unstable
+    std::vector<Twiss> twiss;    // empty if unstable
+
+    auto stable() const -> bool { return !twiss.empty(); }
+};
+
+/**
+ * @brief Twiss parameters and acceptance of both directions of a linear quadrupole
+ *        (a_y = -a, q_y = -q) at every integration step of `hill`.
+ *
+ * The tables come from the one-period transfer matrix, carried from phase to phase by
+ * similarity with the step matrices, so building one costs a couple of monodromies.
+ */
+class AcceptanceTable {
+   public:
+    AcceptanceTable(const HillEquation& hill, double q, double a, double r0);
+
+    auto q() const -> double { return m_q; }
+    auto a() const -> double { return m_a; }
+    auto r0() const -> double { return m_r0; }
+    auto x() const -> const TwissTable& { return m_x; }
+    auto y() const -> const TwissTable& { return m_y; }
+    auto phases() const -> std::size_t { return m_phases; }
+    // Table row nearest to xi (any real; folded into one period)
+    auto index(double xi) const -> std::size_t;
+
+    // Whether a launch at table row `phase` is transmitted (both invariants within acceptance)
+    auto accepts(std::size_t phase, double x, double dx, double y, double dy) const -> bool;
+    // Batch form over launch columns: out[i] = 1 if transmitted, else 0
+    void accepts(const double* xi, const double* x, const double* dx, const double* y,
+                 const double* dy, std::size_t count, std::uint8_t* out) const;
+
+    // Point uniformly distributed over the acceptance ellipse of `table` at row `phase`, from
+    // two uniform deviates in [0, 1). Drawing launches this way and weighting each by the beam
+    // density there times the ellipse area (pi acceptance) estimates transmission without
+    // rejecting lost ions.
+    static auto launch(const TwissTable& table, std::size_t phase, double s1, double s2)
+        -> PhaseSpacePoint;
+
+   private:
+    double m_q;
+    double m_a;
+    double m_r0;
+    std::size_t m_phases;
+    TwissTable m_x;
+    TwissTable m_y;
+};
+
+// rms emittance and Twiss parameters of a sampled beam (one direction)
+struct BeamEllipse {
+    double emittance = 0.0;  // m^2
+    Twiss twiss;
+};
+auto rms_ellipse(const double* u, const double* du, std::size_t count) -> BeamEllipse;
+auto rms_ellipse(const std::vector<double>& u, const std::vector<double>& du) -> BeamEllipse;
+
+// Largest invariant on the boundary of `beam` under the `machine` optics:
+// eps (R + sqrt(R^2 - 1)), R = (beta gamma_b + beta_b gamma - 2 alpha alpha_b) / 2. The beam
+// ellipse fits inside the acceptance iff this is at most the acceptance; R = 1 when matched.
+auto max_invariant(const BeamEllipse& beam, const Twiss& machine) -> double;
+
+/**
+ * @brief AcceptanceTable per operating point (q, a, r0) for one drive, built on first request.
+ *        Safe to share between threads.
+ */
+class AcceptanceCache {
+   public:
+    explicit AcceptanceCache(HillEquation hill);
+
+    auto hill() const -> const HillEquation& { return m_hill; }
+    auto cached_count() const -> std::size_t;
+    auto table(double q, double a, double r0) -> std::shared_ptr<const AcceptanceTable>;
+    void clear();
+
+   private:
+    HillEquation m_hill;
+    mutable std::mutex m_mutex;
+    std::map<std::tuple<double, double, double>, std::shared_ptr<const AcceptanceTable>> m_tables;
+};
+
+}  // namespace mathieu_lib
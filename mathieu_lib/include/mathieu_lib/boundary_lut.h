@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+
+#include "mathieu_lib/characteristic.h"
+#include "mathieu_lib/mathieu.h"  // MAX_Q
+
+namespace mathieu_lib {
+
+/**
+ * Dense lookup tables of the two curves bounding the first stability region from above,
+ * -a_0(q) and b_1(q), with their q-derivatives, on a uniform grid over [0, MAX_Q].
+ *
+ * Everything here is built by the compiler from the constexpr Chebyshev tables, so hot loops
+ * get cubic Hermite interpolation (within ~4e-15 of the exact curves at this spacing) with no
+ * runtime setup.
+ */
+
+constexpr int BOUNDARY_LUT_SEGMENTS = 4096;
+constexpr double BOUNDARY_LUT_STEP = MAX_Q / BOUNDARY_LUT_SEGMENTS;
+constexpr double BOUNDARY_LUT_INV_STEP = BOUNDARY_LUT_SEGMENTS / MAX_Q;
+
+// Chebyshev series in the layout of characteristic_tables.h
+struct ChebyshevTable {
+    double c[CHEBYSHEV_PIECES][CHEBYSHEV_DEGREE + 1];
+};
+
+// Coefficients of d/dq of a CHEBYSHEV_* table, for chebyshev_table_eval
+constexpr auto chebyshev_derivative(const double (&table)[CHEBYSHEV_PIECES][CHEBYSHEV_DEGREE + 1])
+    -> ChebyshevTable {
+    constexpr double dt_dq = 2.0 * CHEBYSHEV_PIECES / CHEBYSHEV_Q_MAX;
+    ChebyshevTable derivative{};
+    for (int p = 0; p < CHEBYSHEV_PIECES; ++p) {
+        double (&d)[CHEBYSHEV_DEGREE + 1] = derivative.c[p];
+        // d_{k-1} = d_{k+1} + 2k c_k, with the k = 0 term halved
+        for (int k = CHEBYSHEV_DEGREE; k >= 1; --k)
+            d[k - 1] = (k + 1 <= CHEBYSHEV_DEGREE ? d[k + 1] : 0.0) + 2.0 * k * table[p][k];
+        d[0] *= 0.5;
+        for (double& value : d) value *= dt_dq;
+    }
+    return derivative;
+}
+
+// Value and q-derivative of both curves at q = i * BOUNDARY_LUT_STEP
+struct BoundaryNode {
+    double minus_a0, minus_a0_dq;
+    double b1, b1_dq;
+};
+using BoundaryLut = std::array<BoundaryNode, BOUNDARY_LUT_SEGMENTS + 1>;
+
+constexpr auto make_boundary_lut() -> BoundaryLut {
+    constexpr ChebyshevTable a0_dq = chebyshev_derivative(CHEBYSHEV_A0);
+    constexpr ChebyshevTable b1_dq = chebyshev_derivative(CHEBYSHEV_B1);
+    BoundaryLut lut{};
+    for (int i = 0; i <= BOUNDARY_LUT_SEGMENTS; ++i) {
+        const double q = BOUNDARY_LUT_STEP * i;
+        lut[i].minus_a0 = -chebyshev_table_eval(CHEBYSHEV_A0, q);
+        lut[i].minus_a0_dq = -chebyshev_table_eval(a0_dq.c, q);
+        lut[i].b1 = chebyshev_table_eval(CHEBYSHEV_B1, q);
+        lut[i].b1_dq = chebyshev_table_eval(b1_dq.c, q);
+    }
+    return lut;
+}
+
+// Built at compile time; MSVC and Clang need a raised constexpr step limit (mathieu_lib/CMakeLists)
+inline constexpr BoundaryLut BOUNDARY_LUT = make_boundary_lut();
+
+// Cubic Hermite interpolant of both curves on each segment, in powers of the local coordinate
+// t in [0, 1]: c[0] + t (c[1] + t (c[2] + t c[3])). Derived from BOUNDARY_LUT at compile time,
+// once per precision, so that evaluation is one table row and two Horner chains.
+template <typename Real>
+struct alignas(8 * sizeof(Real)) BoundarySegment {
+    Real minus_a0[4];
+    Real b1[4];
+};
+template <typename Real>
+using BoundarySegments = std::array<BoundarySegment<Real>, BOUNDARY_LUT_SEGMENTS>;
+
+template <typename Real>
+constexpr void hermite_coefficients(double f0, double df0, double f1, double df1, Real (&c)[4]) {
+    const double m0 = df0 * BOUNDARY_LUT_STEP;
+    const double m1 = df1 * BOUNDARY_LUT_STEP;
+    c[0] = Real(f0);
+    c[1] = Real(m0);
+    c[2] = Real(3.0 * (f1 - f0) - 2.0 * m0 - m1);
+    c[3] = Real(2.0 * (f0 - f1) + m0 + m1);
+}
+
+template <typename Real>
+constexpr auto make_boundary_segments() -> BoundarySegments<Real> {
+    BoundarySegments<Real> segments{};
+    for (int i = 0; i < BOUNDARY_LUT_SEGMENTS; ++i) {
+        const BoundaryNode& lo = BOUNDARY_LUT[i];
+        const BoundaryNode& hi = BOUNDARY_LUT[i + 1];
+        hermite_coefficients(lo.minus_a0, lo.minus_a0_dq, hi.minus_a0, hi.minus_a0_dq,
+                             segments[i].minus_a0);
+        hermite_coefficients(lo.b1, lo.b1_dq, hi.b1, hi.b1_dq, segments[i].b1);
+    }
+    return segments;
+}
+
+template <typename Real>
+inline constexpr BoundarySegments<Real> BOUNDARY_SEGMENTS = make_boundary_segments<Real>();
+
+// -a_0(q) and b_1(q) interpolated from BOUNDARY_SEGMENTS; q is clamped into [0, MAX_Q], with
+// NaN mapped to 0 so that the segment index stays in range (std::clamp passes NaN through)
+template <typename Real>
+constexpr void boundary_lut_curves(Real q, Real& minus_a0, Real& b1) {
+    const Real x =
+        q > Real(0) ? std::min(q, Real(MAX_Q)) * Real(BOUNDARY_LUT_INV_STEP) : Real(0);
+    const int i = std::min(static_cast<int>(x), BOUNDARY_LUT_SEGMENTS - 1);
+    const Real t = x - Real(i);
+    const Real(&a)[4] = BOUNDARY_SEGMENTS<Real>[i].minus_a0;
+    const Real(&b)[4] = BOUNDARY_SEGMENTS<Real>[i].b1;
+    minus_a0 = a[0] + t * (a[1] + t * (a[2] + t * a[3]));
+    b1 = b[0] + t * (b[1] + t * (b[2] + t * b[3]));
+}
+
+// min(-a_0, b_1) clamped at 0, i.e. upper_boundary() for 0 <= q <= MAX_Q
+template <typename Real>
+constexpr auto boundary_lut_upper(Real q) -> Real {
+    Real minus_a0 = 0;
+    Real b1 = 0;
+    boundary_lut_curves(q, minus_a0, b1);
+    return std::max(std::min(minus_a0, b1), Real(0));
+}
+
+}  // namespace mathieu_lib
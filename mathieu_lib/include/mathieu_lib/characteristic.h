@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+
+#include "mathieu_lib/characteristic_tables.h"
+
+namespace mathieu_lib {
+
+/**
+ * Characteristic values of Mathieu's equation y'' + (a - 2q cos 2t) y = 0.
+ *
+ * a_r(q) belongs to the even (cosine-type) and b_r(q) to the odd (sine-type) periodic
+ * solutions of order r. For q > 0 they interlace as a_0 < b_1 < a_1 < b_2 < a_2 < ..., and a
+ * one-dimensional motion is stable exactly for a_r(q) < a < b_{r+1}(q). The first stability
+ * region of a linear quadrupole is bounded by a_0 and b_1 (x) and their mirror images -a_0 and
+ * -b_1 (y).
+ */
+
+// Largest |q| and order the exact solver accepts: its matrix grows as order + 2 sqrt(|q|)
+constexpr double EXACT_SOLVER_Q_MAX = 1e8;
+constexpr int EXACT_SOLVER_ORDER_MAX = 10000;
+
+// Exact values from Sturm-sequence bisection of the truncated recurrence matrix, for finite
+// |q| <= EXACT_SOLVER_Q_MAX; std::invalid_argument otherwise
+auto characteristic_a(int order, double q) -> double;  // 0 <= order <= EXACT_SOLVER_ORDER_MAX
+auto characteristic_b(int order, double q) -> double;  // 1 <= order <= EXACT_SOLVER_ORDER_MAX
+
+// Clenshaw evaluation of a CHEBYSHEV_* table for 0 <= q <= CHEBYSHEV_Q_MAX (the end pieces
+// extrapolate outside). Branch-free apart from the piece lookup, and constexpr so that derived
+// tables can be built at compile time.
+template <typename Real>
+constexpr auto chebyshev_table_eval(const double (&table)[CHEBYSHEV_PIECES][CHEBYSHEV_DEGREE + 1],
+                                    Real q) -> Real {
+    constexpr Real width = Real(CHEBYSHEV_Q_MAX / CHEBYSHEV_PIECES);
+    int piece = 0;
+    if constexpr (CHEBYSHEV_PIECES > 1) {
+        const Real x = q / width;  // NaN lands in piece 0 instead of an out-of-range index
+        if (x >= Real(CHEBYSHEV_PIECES - 1))
+            piece = CHEBYSHEV_PIECES - 1;
+        else if (x > Real(0))
+            piece = static_cast<int>(x);
+    }
+    const Real t = Real(2) * (q - width * Real(piece)) / width - Real(1);
+    const Real two_t = Real(2) * t;
+    Real b1 = 0;
+    Real b2 = 0;
+    for (int j = CHEBYSHEV_DEGREE; j >= 1; --j) {
+        // c_j - b2 is off the dependency chain, leaving one multiply-add per step on it
+        const Real b0 = (Real(table[piece][j]) - b2) + two_t * b1;
+        b2 = b1;
+        b1 = b0;
+    }
+    return t * b1 - b2 + Real(table[piece][0]);
+}
+
+// a_0 and b_1 from the Chebyshev tables in characteristic_tables.h for |q| <= CHEBYSHEV_Q_MAX,
+// from the exact solver beyond. Instantiated for float and double.
+template <typename Real>
+auto characteristic_a0(Real q) -> Real;
+template <typename Real>
+auto characteristic_b1(Real q) -> Real;
+// Batch forms for 0 <= q <= CHEBYSHEV_Q_MAX; the loops have no data-dependent branches
+template <typename Real>
+void characteristic_a0(const Real* qs, std::size_t count, Real* out);
+template <typename Real>
+void characteristic_b1(const Real* qs, std::size_t count, Real* out);
+
+}  // namespace mathieu_lib
@@ -0,0 +1,215 @@
+#pragma once
+
+// Generated by tools/gen_characteristic_tables from the exact Sturm-bisection
+// solver (characteristic_a/characteristic_b); do not edit by hand.
+//
+// Piecewise Chebyshev series of a_0(q) and b_1(q) on [0, CHEBYSHEV_Q_MAX], one
+// row per piece of equal width, evaluated on t in [-1, 1] across the piece.
+// Max abs error over 200001 points: a_0 6.8e-14, b_1 6.4e-14 (bound 1e-13).
+
+namespace mathieu_lib {
+
+constexpr double CHEBYSHEV_Q_MAX = 16;
+constexpr int CHEBYSHEV_PIECES = 16;
+constexpr int CHEBYSHEV_DEGREE = 15;
+constexpr double CHEBYSHEV_ERROR_BOUND = 1e-13;
+
+constexpr double CHEBYSHEV_A0[CHEBYSHEV_PIECES][CHEBYSHEV_DEGREE + 1] = {
+    {-0.17482945689528126, -0.22995800997025001, -0.052902426104057272,
+     0.002423116030087174, 0.00016207776322840937, -3.4857119735152127e-05,
+     5.4645011889869897e-07, 4.5294453237432864e-07, -4.4346644887309733e-08,
+     -3.9190523258793831e-09, 1.0974355917301921e-09, -2.1250042208794206e-11,
+     -1.8698108423007878e-11, 2.0171537954920611e-12, 1.9099856000892203e-13,
+     -5.7907624597112095e-14},
+    {-0.96057539118044843, -0.53118396580526606, -0.023865026111568433,
+     0.0017720541333903078, -0.0001077350020832063, 2.8474592117938569e-06,
+     4.0091625116978058e-07, -7.6031663492903689e-08, 6.8304549724618191e-09,
+     -2.3760948070217225e-10, -3.3856618897321056e-11, 7.3569414449359272e-12,
+     -7.2023637054385858e-13, 2.6867397195928788e-14, 4.2067044292437572e-15,
+     -6.4358240958739543e-16},
+    {-2.1635866948052489, -0.66084408535604877, -0.010547909703130298,
+     0.00062425115998426817, -3.9670089344606696e-05, 2.3285319482591049e-06,
+     -1.130196722320953e-07, 3.2734069344009242e-09, 1.335036525773603e-10,
+     -3.2921901316207425e-11, 3.463104802925443e-12, -2.6600943670018751e-13,
+     1.5792922525292852e-14, -2.5673907444456745e-16, 5.7592819402429996e-16,
+     1.0061396160665481e-16},
+    {-3.5517249563723556, -0.72331083876493341, -0.0057176116215010286,
+     0.00024669718931502604, -1.2751584914094671e-05, 6.7575127110641731e-07,
+     -3.4457910635943279e-08, 1.623200573952488e-09, -6.6727456893289627e-11,
+     2.0428658764615193e-12, -8.1046280797636427e-15, -6.6613381477509392e-15,
+     1.8873791418627661e-15, 1.6653345369377348e-16, 1.3877787807814457e-15,
+     2.9143354396410359e-16},
+    {-5.0366301764931132, -0.75988158330736721, -0.0036474220908041532,
+     0.00011776876392266544, -4.8114555526446168e-06, 2.1285171558638183e-07,
+     -9.5200470284773075e-09, 4.1654529825407849e-10, -1.7470636048955157e-11,
+     6.8550720655480291e-13, -2.4757973449140991e-14, -8.8817841970012523e-16,
+     2.1649348980190553e-15, 6.9388939039072284e-16, 1.7208456881689926e-15,
+     -1.3877787807814457e-16},
+    {-6.5818490771855451, -0.7844579782614034, -0.002587202051427151,
+     6.5493955132001069e-05, -2.1441927711141062e-06, 7.8602972131136539e-08,
+     -3.0050215649168877e-09, 1.15492171381959e-10, -4.3761660961649795e-12,
+     1.5804024755539103e-13, -6.4392935428259079e-15, -2.2204460492503131e-15,
+     2.7200464103316335e-15, 4.4408920985006262e-16, 1.9984014443252818e-15,
+     1.1102230246251565e-16},
+    {-8.1693200830931509, -0.80249658598012918, -0.0019654895809211315,
+     4.0715547411140918e-05, -1.0950649176333371e-06, 3.3584761860439016e-08,
+     -1.0977049269556005e-09, 3.6770253508677797e-11, -1.2350120925930241e-12,
+     3.652633751016765e-14, -1.8873791418627661e-15, -2.3869795029440866e-15,
+     2.886579864025407e-15, 1.1102230246251565e-15, 2.6645352591003757e-15,
+     4.7184478546569153e-16},
+    {-9.7886715433772409, -0.81652080200093802, -0.0015637049556169735,
+     2.7420836788305536e-05, -6.2181152293838693e-07, 1.6198994257088373e-08,
+     -4.5607839727068722e-10, 1.3355316852425858e-11, -3.979039320256561e-13,
+     5.9952043329758453e-15, -9.9920072216264089e-16, -2.6645352591003757e-15,
+     3.9412917374193057e-15, 4.4408920985006262e-16, 3.6082248300317588e-15,
+     -1.3877787807814457e-16},
+    {-11.433286054141316, -0.82786207439650217, -0.0012852894265220627,
+     1.9574497604590846e-05, -3.8304791294407892e-07, 8.6189828607530217e-09,
+     -2.1121082660613411e-10, 5.4420912221075923e-12, -1.4388490399142029e-13,
+     -3.6637359812630166e-15, -9.9920072216264089e-16, -4.2188474935755949e-15,
+     4.1078251911130792e-15, 8.3266726846886741e-16, 3.219646771412954e-15,
+     -1.1102230246251565e-15},
+    {-13.098614586405873, -0.8372974674235163, -0.0010822496140141524,
+     1.4593180255317861e-05, -2.5125324776276159e-07, 4.9621311504211008e-09,
+     -1.0705103470343147e-10, 2.4455992786442948e-12, -5.773159728050814e-14,
+     -6.6613381477509392e-15, -1.1102230246251565e-15, -4.5519144009631418e-15,
+     5.5511151231257827e-15, -1.27675647831893e-15, 4.7184478546569153e-15,
+     -1.6653345369377348e-16},
+    {-14.781356754714214, -0.84531659501302725, -0.00092837328641492967,
+     1.1247495856236966e-05, -1.7307204580596647e-07, 3.0437099507452103e-09,
+     -5.8471227859513419e-11, 1.1950440637065185e-12, -2.5091040356528538e-14,
+     -8.659739592076221e-15, -1.6653345369377348e-15, -4.4408920985006262e-15,
+     6.106226635438361e-15, -2.2204460492503131e-16, 5.1070259132757201e-15,
+     -3.6082248300317588e-16},
+    {-16.479019987428053, -0.85224659563985927, -0.00080822888209586274,
+     8.899001391338146e-06, -1.2393203197014202e-07, 1.9650856497577252e-09,
+     -3.3979929980887391e-11, 6.2638783049351332e-13, -1.0436096431476471e-14,
+     -7.7715611723760958e-15, -6.6613381477509392e-16, -6.4392935428259079e-15,
+     7.6605388699135801e-15, 5.5511151231257827e-16, 5.2735593669694936e-15,
+     -1.5543122344752192e-15},
+    {-18.189662838677965, -0.85831625844068471, -0.00071217035755744007,
+     7.191446102172705e-06, -9.156400082588334e-08, 1.3228256268149607e-09,
+     -2.0789814314525756e-11, 3.4838798512737412e-13, -6.2172489379008766e-15,
+     -1.0880185641326534e-14, -1.9984014443252818e-15, -4.6629367034256575e-15,
+     8.3266726846886741e-15, 2.2204460492503131e-16, 6.3282712403633923e-15,
+     -1.0269562977782698e-15},
+    {-19.9117358001028, -0.86369148781049443, -0.0006338697419616679,
+     5.9139122425833079e-06, -6.9409997305314164e-08, 9.2170360233012616e-10,
+     -1.3279377597541497e-11, 2.0583534876550402e-13, -1.7763568394002505e-15,
+     -1.2656542480726785e-14, -8.8817841970012523e-16, -7.9936057773011271e-15,
+     7.7715611723760958e-15, -3.3306690738754696e-16, 7.9380946260698693e-15,
+     -1.9984014443252818e-15},
+    {-21.643977473666066, -0.86849616021650533, -0.0005690091220373894,
+     4.9352455935292028e-06, -5.3757282181265964e-08, 6.609690572645377e-10,
+     -8.7903018197721394e-12, 1.2612133559741778e-13, -1.7763568394002505e-15,
+     -1.1990408665951691e-14, -1.9984014443252818e-15, -6.6613381477509392e-15,
+     9.6589403142388619e-15, -4.4408920985006262e-16, 6.6613381477509392e-15,
+     -2.2204460492503131e-15},
+    {-23.385344030493176, -0.87282502784091687, -0.00051454483829704856,
+     4.1704826498900616e-06, -4.239899631386379e-08, 4.8568082888778008e-10,
+     -6.0018656711235963e-12, 8.1712414612411521e-14, -4.4408920985006262e-16,
+     -1.3100631690576847e-14, -1.1102230246251565e-15, -7.3274719625260332e-15,
+     9.7699626167013776e-15, -1.1102230246251565e-16, 8.4376949871511897e-15,
+     -1.8318679906315083e-15},
+};
+
+constexpr double CHEBYSHEV_B1[CHEBYSHEV_PIECES][CHEBYSHEV_DEGREE + 1] = {
+    {0.45777355344427006, -0.55555358802409516, -0.012889407901842981,
+     0.00042936535986615176, -8.5802303679410885e-06, -1.8471697632582718e-07,
+     2.6187069804284313e-08, -1.1173604957948058e-09, 4.9931586643126025e-12,
+     2.5154878180444484e-12, -1.7076617897515689e-13, 4.2466030691912238e-15,
+     -1.1796119636642288e-16, 1.1796119636642288e-16, -2.7061686225238191e-16,
+     2.7929047963226594e-16},
+    {-0.74185569064688872, -0.64050102316759638, -0.0085987565850984913,
+     0.00028704872293119389, -8.2155497786295245e-06, 1.3276001899382994e-07,
+     3.6524859334946536e-09, -4.3145563510815776e-10, 2.0577367934593305e-11,
+     -5.1383550192518612e-13, -6.8868521996279242e-15, 1.4519635493925875e-15,
+     1.0842021724855044e-16, 1.8041124150158794e-16, 1.470178145890344e-16,
+     3.0379344873043834e-16},
+    {-2.0821744532177537, -0.69753034862416585, -0.0058482954545511223,
+     0.00017861635041993562, -5.349965130685419e-06, 1.3301963400214056e-07,
+     -1.8943049628905584e-09, -4.6800868735985546e-11, 5.2415571882846734e-12,
+     -2.5775215295453791e-13, 8.2295281700339729e-15, -6.2450045135165055e-16,
+     7.2164496600635175e-16, -6.9388939039072284e-18, 5.2735593669694936e-16,
+     2.3245294578089215e-16},
+    {-3.5181388186568547, -0.7370133208487708, -0.0041392984603361715,
+     0.00011163621557763737, -3.1812182286761193e-06, 8.424181474619985e-08,
+     -1.8593221962071027e-09, 2.4785229424395538e-11, 4.4000914023456517e-13,
+     -5.2791104820926193e-14, 1.9428902930940239e-15, -1.2490009027033011e-15,
+     1.4432899320127035e-15, 1.1102230246251565e-16, 1.0963452368173421e-15,
+     7.6327832942979512e-17},
+    {-5.0215732275690579, -0.76552093666359777, -0.0030566375083325159,
+     7.2039228501630248e-05, -1.8833791018413315e-06, 4.8373891115005563e-08,
+     -1.1425675405796198e-09, 2.2791935005983532e-11, -2.9343194540842887e-13,
+     -5.4956039718945249e-15, 5.5511151231257827e-17, -1.27675647831893e-15,
+     2.1926904736346842e-15, 4.7184478546569153e-16, 1.6237011735142914e-15,
+     -3.4694469519536142e-17},
+    {-6.5746493357132092, -0.78696358662227472, -0.0023453248347296007,
+     4.83524939003388e-05, -1.1440396275874676e-06, 2.7527423118733907e-08,
+     -6.373185312824603e-10, 1.358135826023954e-11, -2.4813484600372249e-13,
+     -3.3306690738754696e-16, -3.8857805861880479e-16, -2.3869795029440866e-15,
+     2.4424906541753444e-15, 1.1102230246251565e-16, 2.1094237467877974e-15,
+     2.6367796834847468e-16},
+    {-8.1656968317407159, -0.80367942114684099, -0.0018591293607900239,
+     3.373565262509981e-05, -7.1984540095382243e-07, 1.6000715974406887e-08,
+     -3.5155323097058044e-10, 7.3884232065779543e-12, -1.4332979247910771e-13,
+     -2.2204460492503131e-15, -9.9920072216264089e-16, -2.6090241078691179e-15,
+     2.8310687127941492e-15, 7.7715611723760958e-16, 2.9143354396410359e-15,
+     4.3021142204224816e-16},
+    {-9.7867706153648726, -0.8171072853645196, -0.0015141594074605802,
+     2.4381757284475114e-05, -4.6981883472518859e-07, 9.5992610527062538e-09,
+     -1.9746004831233677e-10, 3.9727110490161976e-12, -7.6161299489285739e-14,
+     -3.6637359812630166e-15, -4.4408920985006262e-16, -3.219646771412954e-15,
+     4.1078251911130792e-15, 1.0547118733938987e-15, 3.5527136788005009e-15,
+     2.7755575615628914e-17},
+    {-11.432253491469861, -0.82816493962352733, -0.0012610869829932092,
+     1.8176417600823669e-05, -3.1747086359779075e-07, 5.9585629763603265e-09,
+     -1.1413003875304639e-10, 2.170263968537256e-12, -3.985700658404312e-14,
+     -5.1070259132757201e-15, -9.9920072216264089e-16, -3.1086244689504383e-15,
+     5.2180482157382357e-15, -5.5511151231257827e-17, 3.7747582837255322e-15,
+     -4.163336342344337e-16},
+    {-13.098036898890337, -0.83745933654752491, -0.0010699458761489478,
+     1.39197389437129e-05, -2.2143197919710644e-07, 3.8238523458744567e-09,
+     -6.8093086724729801e-11, 1.2179146580137967e-12, -2.1094237467877974e-14,
+     -6.3282712403633923e-15, -7.7715611723760958e-16, -4.5519144009631418e-15,
+     5.5511151231257827e-15, -1.6653345369377348e-16, 4.7184478546569153e-15,
+     -9.1593399531575415e-16},
+    {-14.781025203740207, -0.84540569790746334, -0.000921901775174927,
+     1.091017491483548e-05, -1.5889305582383884e-07, 2.5315376461776395e-09,
+     -4.1930681149437987e-11, 7.049916206369744e-13, -1.1324274851176597e-14,
+     -7.9936057773011271e-15, -5.5511151231257827e-16, -4.7739590058881731e-15,
+     5.6621374255882984e-15, -7.7715611723760958e-16, 4.7184478546569153e-15,
+     2.2204460492503131e-16},
+    {-16.478825403180995, -0.85229691958043285, -0.00080472312026058646,
+     8.7242507822438142e-06, -1.1692755386150111e-07, 1.7244774497271464e-09,
+     -2.6608493186586202e-11, 4.2010839251815923e-13, -5.9952043329758453e-15,
+     -9.7699626167013776e-15, -8.8817841970012523e-16, -5.8841820305133297e-15,
+     7.1054273576010019e-15, 1.7763568394002505e-15, 5.9396931817445875e-15,
+     -1.8318679906315083e-15},
+    {-18.189546358851054, -0.8583453308978175, -0.00071022148214039404,
+     7.0982148994147565e-06, -8.7986768093628598e-08, 1.2054872655653526e-09,
+     -1.7364110149742373e-11, 2.5801583092288638e-13, -3.3306690738754696e-15,
+     -1.1102230246251565e-14, -1.5543122344752192e-15, -5.5511151231257827e-15,
+     8.8817841970012523e-15, 2.2204460492503131e-15, 6.4948046940571658e-15,
+     -1.4432899320127035e-15},
+    {-19.911664831761172, -0.86370862448617558, -0.00063276127004296967,
+     5.8628661578907781e-06, -6.7528915348447072e-08, 8.6257578857384942e-10,
+     -1.162936413834359e-11, 1.6431300764452317e-13, -2.4424906541753444e-15,
+     -1.2212453270876722e-14, -2.4424906541753444e-15, -6.8833827526759706e-15,
+     9.4368957093138306e-15, 0, 6.4392935428259079e-15,
+     -1.6653345369377348e-16},
+    {-21.64393354099688, -0.86850644532210541, -0.0005683656292432282,
+     4.9066444787193575e-06, -5.2742147538253903e-08, 6.3029714780782342e-10,
+     -7.9727335844381741e-12, 1.0613732115416497e-13, -1.5543122344752192e-15,
+     -1.3988810110276972e-14, -2.6645352591003757e-15, -5.1070259132757201e-15,
+     9.3258734068513149e-15, -5.5511151231257827e-16, 7.8825834748386114e-15,
+     -1.9984014443252818e-15},
+    {-23.385316438893405, -0.87283130224383321, -0.00051416433819229113,
+     4.1541223443353203e-06, -4.1838332354160457e-08, 4.6935300090922283e-10,
+     -5.5830895462349872e-12, 7.2386541205560206e-14, -2.2204460492503131e-16,
+     -1.4432899320127035e-14, -8.8817841970012523e-16, -8.2156503822261584e-15,
+     8.2156503822261584e-15, 1.2212453270876722e-15, 8.3266726846886741e-15,
+     -5.5511151231257827e-17},
+};
+
+}  // namespace mathieu_lib
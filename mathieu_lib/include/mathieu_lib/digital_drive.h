@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "mathieu_lib/geometry.h"
+#include "mathieu_lib/progress.h"
+#include "mathieu_lib/stability.h"
+#include "mathieu_lib/stability_map.h"
+#include "mathieu_lib/thread_pool.h"
+
+namespace mathieu_lib {
+
+/**
+ * Stability under piecewise-constant (digital, DIT-style) drives.
+ *
+ * The motion obeys u'' + (a - 2q w(xi)) u = 0 with xi = Omega t / 2, where w is the drive
+ * waveform in units of its amplitude with period pi in xi; w = cos 2xi gives Mathieu's
+ * equation, so q and a keep the meaning of mathieu_q() and mathieu_a(). On each constant
+ * stretch the solution is a closed-form rotation or boost, and the product of the stretch
+ * matrices over one period (the monodromy) decides stability: |trace| <= 2 is stable, with
+ * cos(pi beta) = trace / 2.
+ */
+
+// One constant stretch of the drive: `fraction` of the period at `level` (w in units of q)
+struct DriveSegment {
+    double fraction;
+    double level;
+};
+
+class PiecewiseWaveform {
+   public:
+    // Fractions are rescaled to sum to one
+    explicit PiecewiseWaveform(std::vector<DriveSegment> segments);
+
+    // +1 for `duty_cycle` of the period, -1 for the rest; a duty cycle other than 0.5 leaves a
+    // mean level of 2 duty_cycle - 1 that acts like an extra DC term
+    static auto rectangular(double duty_cycle) -> PiecewiseWaveform;
+
+    auto segments() const -> const std::vector<DriveSegment>& { return m_segments; }
+
+   private:
+    std::vector<DriveSegment> m_segments;
+};
+
+// Maps (u, du/dxi) at the start of a stretch to its end
+struct TransferMatrix {
+    double m11 = 1.0, m12 = 0.0;
+    double m21 = 0.0, m22 = 1.0;
+
+    auto trace() const -> double { return m11 + m22; }
+    // `later` applied after *this
+    auto then(const TransferMatrix& later) const -> TransferMatrix;
+};
+
+// beta in [0, 1] from cos(pi beta) = trace / 2 of a monodromy; NaN outside |trace| <= 2
+// (including NaN traces)
+auto beta_from_trace(double trace) -> double;
+
+// Monodromy of u'' + (a - 2q w) u = 0 over one period of `waveform`
+auto digital_monodromy(const PiecewiseWaveform& waveform, double q, double a) -> TransferMatrix;
+
+// beta in [0, 1] within its stability band, NaN where the motion is unstable
+auto digital_beta(const PiecewiseWaveform& waveform, double q, double a) -> double;
+
+// Stability of both directions of `Geometry` (see StabilityClass); the secondary direction is
+// driven with k q and k a, k = SECONDARY_RATIO. Instantiated for both geometries.
+template <typename Geometry = LinearQuadrupole>
+auto classify_digital_stability(const PiecewiseWaveform& waveform, double q, double a)
+    -> StabilityClass;
+
+struct DigitalStabilityMapOptions {
+    std::size_t band_rows = 8;                  // a-rows per work item and per on_rows call
+    ThreadPool* pool = nullptr;                 // nullptr = ThreadPool::global()
+    const std::atomic<bool>* cancel = nullptr;  // set to true from any thread to stop early
+    // Called after each finished band with (rows done, rows total); serialized, pool threads
+    ProgressCallback progress;
+    // Called with (first row, row count, classes of those rows) as each band finishes, in
+    // completion order and serialized with `progress`
+    std::function<void(std::size_t, std::size_t, const StabilityClass*)> on_rows;
+};
+
+// Stability class and beta of both directions in every cell of a StabilityMapSpec grid
+struct DigitalStabilityMap {
+    StabilityMapSpec spec;
+    std::vector<StabilityClass> classes;  // a_cells rows of q_cells values, row 0 at a_min
+    std::vector<double> beta_x;           // primary direction; NaN where unstable
+    std::vector<double> beta_y;           // secondary direction; NaN where unstable
+    bool complete = false;                // false if cancelled; unfinished bands hold None/NaN
+
+    auto at(std::size_t column, std::size_t row) const -> StabilityClass {
+        return classes[row * spec.q_cells + column];
+    }
+};
+
+template <typename Geometry = LinearQuadrupole>
+auto rasterize_digital_stability(
+    const PiecewiseWaveform& waveform, const StabilityMapSpec& spec,
+    const DigitalStabilityMapOptions& options = DigitalStabilityMapOptions())
+    -> DigitalStabilityMap;
+
+}  // namespace mathieu_lib
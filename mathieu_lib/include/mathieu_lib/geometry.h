@@ -0,0 +1,58 @@
+#pragma once
+
+#include <utility>
+
+#include "mathieu_lib/mathieu.h"  // QuadrupoleParams, PaulTrapParams, MAX_Q
+
+namespace mathieu_lib {
+
+/**
+ * Electrode geometries, used as compile-time policies by the stability kernels and the q/a
+ * conversions.
+ *
+ * Every geometry confines an ion in two independent directions that each obey Mathieu's
+ * equation. The stability diagram is drawn in the (q, a) of the primary direction (x for the
+ * linear quadrupole, z for the Paul trap); the secondary direction (y, r) sees the same
+ * parameters scaled by SECONDARY_RATIO. Its first stability region is
+ *   a_0(q) <= a <= b_1(q)  and  a_0(|k| q) <= k a <= b_1(|k| q),  k = SECONDARY_RATIO < 0,
+ * which ends at q = FIRST_REGION_Q_MAX.
+ *
+ * In terms of the instrument, q = Q_FACTOR e (V_rf / 2) / (m d^2 Omega^2) and
+ * a = A_FACTOR e V_dc / (m d^2 Omega^2) with d^2 = field_size_sq(params).
+ */
+
+struct LinearQuadrupole {
+    using Params = QuadrupoleParams;
+
+    static constexpr double SECONDARY_RATIO = -1.0;  // a_y = -a_x, q_y = -q_x
+    static constexpr double FIRST_REGION_Q_MAX = MAX_Q;
+    static constexpr double Q_FACTOR = 4.0;
+    static constexpr double A_FACTOR = 8.0;
+
+    static constexpr auto field_size_sq(const Params& params) -> double {
+        return params.quad_radius * params.quad_radius;
+    }
+};
+
+struct PaulTrap3D {
+    using Params = PaulTrapParams;
+
+    static constexpr double SECONDARY_RATIO = -0.5;  // a_r = -a_z / 2, q_r = -q_z / 2
+    // Where beta_z = 1 meets beta_r = 1, at a_z = -0.54397
+    static constexpr double FIRST_REGION_Q_MAX = 1.35121796841439;
+    static constexpr double Q_FACTOR = 8.0;
+    static constexpr double A_FACTOR = -16.0;  // V_dc on the ring pushes ions onto the z axis
+
+    static constexpr auto field_size_sq(const Params& params) -> double {
+        return params.ring_radius * params.ring_radius +
+               2.0 * params.end_cap_distance * params.end_cap_distance;
+    }
+};
+
+// (q, a) of the secondary direction of `Geometry` at diagram point (q, a)
+template <typename Geometry, typename Real>
+constexpr auto secondary_mathieu_parameters(Real q, Real a) -> std::pair<Real, Real> {
+    return {Real(Geometry::SECONDARY_RATIO) * q, Real(Geometry::SECONDARY_RATIO) * a};
+}
+
+}  // namespace mathieu_lib
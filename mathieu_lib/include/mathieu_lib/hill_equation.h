@@ -0,0 +1,82 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "mathieu_lib/digital_drive.h"  // TransferMatrix
+#include "mathieu_lib/geometry.h"
+#include "mathieu_lib/stability.h"
+
+namespace mathieu_lib {
+
+/**
+ * Stability under an arbitrary periodic drive given as a Fourier series.
+ *
+ * The motion obeys Hill's equation u'' + (a - 2q w(xi)) u = 0 with xi = Omega t / 2 and
+ * w(xi) = mean + sum_n (cos_n cos 2n xi + sin_n sin 2n xi); the pure drive (cos_1 = 1) gives
+ * Mathieu's equation, so q and a keep the meaning of mathieu_q() and mathieu_a(). Harmonic
+ * distortion of an RF supply enters as the higher coefficients.
+ */
+struct FourierWaveform {
+    double mean = 0.0;
+    std::vector<double> cosines;  // cosines[n - 1] multiplies cos 2n xi
+    std::vector<double> sines;    // sines[n - 1] multiplies sin 2n xi
+
+    auto value(double xi) const -> double;
+    auto harmonics() const -> std::size_t { return std::max(cosines.size(), sines.size()); }
+};
+
+// Sampled solution: u and du/dxi at xi[i]
+struct HillTrajectory {
+    std::vector<double> xi;
+    std::vector<double> u;
+    std::vector<double> du;
+};
+
+/**
+ * @brief Hill's equation for one drive waveform.
+ *
+ * The waveform is sampled once, at the Gauss nodes of every integration step; everything
+ * that depends on the operating point only rescales those samples by q (and shifts them by
+ * a), so scanning voltage or m/z along one HillEquation costs no further waveform
+ * evaluation. Steps use the fourth-order Magnus propagator, which is exactly unimodular.
+ * Safe to share between threads.
+ */
+class HillEquation {
+   public:
+    explicit HillEquation(FourierWaveform waveform, std::size_t steps_per_period = 256);
+
+    auto waveform() const -> const FourierWaveform& { return m_waveform; }
+    auto steps_per_period() const -> std::size_t { return m_samples.size() / 2; }
+
+    // Monodromy over one period (pi in xi)
+    auto monodromy(double q, double a) const -> TransferMatrix;
+    // Transfer matrices of the integration steps of one period, in order from xi = 0; step i
+    // spans [i, i + 1] pi / steps_per_period()
+    auto step_matrices(double q, double a) const -> std::vector<TransferMatrix>;
+    // beta in [0, 1] within its stability band, NaN where the motion is unstable
+    auto beta(double q, double a) const -> double;
+    // Both directions of `Geometry`, as classify_digital_stability(); instantiated for both
+    template <typename Geometry = LinearQuadrupole>
+    auto classify(double q, double a) const -> StabilityClass;
+
+    // Edges of stability band `order` (0 = first) at q: the motion is stable for
+    // first <= a <= second. From Hill's infinite determinant, not the integrator, so they are
+    // exact to rounding; for w = cos 2xi they are a_r(q) and b_{r+1}(q).
+    auto band_edges(int order, double q) const -> std::pair<double, double>;
+
+    // Solution from (u0, du0) at xi = 0, sampled at the end of every step for `periods` periods
+    auto trajectory(double q, double a, double u0, double du0, std::size_t periods) const
+        -> HillTrajectory;
+
+   private:
+    auto step(double q, double a, std::size_t index) const -> TransferMatrix;
+
+    FourierWaveform m_waveform;
+    double m_step;
+    std::vector<double> m_samples;  // w at the two Gauss nodes of every step
+};
+
+}  // namespace mathieu_lib
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mathieu_lib/progress.h"
+#include "mathieu_lib/thread_pool.h"
+
+namespace mathieu_lib {
+
+/**
+ * Ion trajectories through a linear quadrupole.
+ *
+ * Time is the RF phase xi = Omega t / 2 (period pi), in which the transverse motion obeys
+ * u'' + k_u(xi) u = 0 with k_x = a - 2q cos 2xi and k_y = -k_x, q and a of each ion following
+ * from its m/z as in mathieu_q_from_mz(). Positions are in m and slopes are d/dxi in m, so a
+ * velocity is Omega / 2 times its slope; this is the frame of AcceptanceTable, whose launch()
+ * points can be copied straight in.
+ */
+
+// Ions per work item of simulate_ions(); each block has its own random stream
+constexpr std::size_t ION_BLOCK = 256;
+
+// Per-ion state, one column per coordinate so the integrator vectorizes across ions
+struct IonEnsemble {
+    std::vector<double> mz;  // Da
+    std::vector<double> x, dx;
+    std::vector<double> y, dy;
+    std::vector<double> z, dz;    // axial; z is measured from the filter entrance
+    std::vector<double> lost_at;  // xi at which the ion hit a rod; NaN while it has not
+
+    auto size() const -> std::size_t { return mz.size(); }
+    // Resizes every column; new ions are at rest on axis with lost_at NaN
+    void resize(std::size_t count);
+};
+
+enum class CollisionModel : std::uint8_t {
+    None,        // collision-free Mathieu motion
+    Viscous,     // mean drag at the hard-sphere momentum-transfer rate; cools to rest
+    HardSphere,  // stochastic elastic collisions with Maxwellian gas; cools to the gas temperature
+};
+
+struct BufferGas {
+    double pressure = 0.0;          // Pa
+    double temperature = 300.0;     // K
+    double mass = 28.0;             // Da (N2)
+    double cross_section = 1e-18;  // m^2, ion-neutral collision cross section
+};
+
+// Dipolar auxiliary AC across the x rod pair, for resonant ejection at a secular frequency
+// (see secular_frequency()). The on-axis field is amplitude / (2 r0), the parallel-plate value.
+struct DipolarExcitation {
+    double amplitude = 0.0;  // V, peak rod-to-rod; 0 = off
+    double frequency = 0.0;  // Hz
+    double phase = 0.0;      // rad, drive phase at xi = 0
+};
+
+// Entrance fringe: the RF and DC amplitudes the ions see rise as 1 - exp(-n / length) over the
+// RF cycles n after launch, until within 0.1% of full (7 lengths). A DC ramp longer than the
+// RF one models a delayed-DC entrance. The fringe is collision-free and undriven, except for
+// viscous drag.
+struct FringeField {
+    double rf_length = 0.0;  // RF cycles; 0 = ideal entrance
+    double dc_length = 0.0;  // RF cycles
+};
+
+// Self-consistent space charge: every update_periods RF periods the ions in flight are
+// deposited on a grid across the rods and the field is solved (see SpaceChargeGrid, grounded
+// square through the rod tips); in between, each ion feels that field at its position. Each
+// simulated ion stands for ions_per_particle ions spread over cloud_length. The fringe cycles
+// are taken without it.
+struct SpaceChargeCoupling {
+    double ions_per_particle = 0.0;  // 0 = off
+    double cloud_length = 0.05;      // m
+    std::size_t grid_nodes = 32;     // interior nodes per direction
+    std::size_t update_periods = 1;
+};
+
+struct IonSimulationSpec {
+    double frequency = 1e6;     // Hz
+    double quad_radius = 5e-3;  // m
+    double voltage_rf = 0.0;    // V, as for mathieu_q()
+    double voltage_dc = 0.0;    // V, as for mathieu_a()
+    int charge_state = 1;       // signed; anions see q, a and the excitation reversed
+    double start_phase = 0.0;  // xi at launch
+    std::size_t periods = 100;
+    std::size_t steps_per_period = 64;
+    CollisionModel collisions = CollisionModel::None;
+    BufferGas gas;
+    DipolarExcitation excitation;
+    FringeField fringe;  // counted within `periods`
+    SpaceChargeCoupling space_charge;
+};
+
+struct IonSimulationOptions {
+    std::uint64_t seed = 0;      // collisions are reproducible for a given seed
+    ThreadPool* pool = nullptr;  // nullptr = ThreadPool::global()
+    const std::atomic<bool>* cancel = nullptr;  // set to true from any thread to stop early
+    ProgressCallback progress;                  // (blocks done, blocks total)
+};
+
+struct IonSimulationSummary {
+    std::size_t transmitted = 0;  // ions with lost_at NaN after the run
+    std::size_t lost = 0;
+    bool cancelled = false;  // blocks not started before the cancel are left untouched
+};
+
+// Mean hard-sphere collision rate (1/s) of an ion of m/z `mz` (Da) in thermal equilibrium with
+// `gas`, n sigma sqrt(8 k T / (pi mu)), and its momentum-transfer (drag) rate, the collision
+// rate times M / (m + M)
+auto collision_rate(double mz, int charge_state, const BufferGas& gas) -> double;
+auto drag_rate(double mz, int charge_state, const BufferGas& gas) -> double;
+
+/**
+ * @brief Advances every ion not yet lost by spec.periods RF periods from spec.start_phase,
+ *        recording the phase at which each one reaches |x| or |y| >= r0.
+ */
+auto simulate_ions(const IonSimulationSpec& spec, IonEnsemble& ions,
+                   const IonSimulationOptions& options = IonSimulationOptions())
+    -> IonSimulationSummary;
+
+/**
+ * @brief Resonant ejection over a grid of excitation frequencies and amplitudes.
+ *
+ * Cells are indexed by index(amplitude, frequency, species), species varying fastest. An ion
+ * counts as ejected if it reaches a rod during the run, in x or y.
+ */
+struct EjectionMap {
+    std::vector<double> frequencies;    // Hz
+    std::vector<double> amplitudes;     // V
+    std::vector<double> mz;             // distinct m/z of the ions in flight at launch, ascending
+    std::vector<double> efficiency;     // fraction of the species ejected
+    std::vector<double> ejection_time;  // s after launch, mean over ejected ions; NaN if none
+    bool cancelled = false;             // cells of unfinished work items are undercounted
+
+    auto index(std::size_t amplitude, std::size_t frequency, std::size_t species) const
+        -> std::size_t;
+};
+
+// Simulates a copy of `ions` under spec with its excitation set to each grid point in turn
+// (spec.excitation.phase is kept); the ensemble itself is left untouched. Space-charge
+// coupling is not supported, as the ions of a point would have to be held together.
+auto sweep_excitation(const IonSimulationSpec& spec, const IonEnsemble& ions,
+                      const std::vector<double>& frequencies,
+                      const std::vector<double>& amplitudes,
+                      const IonSimulationOptions& options = IonSimulationOptions()) -> EjectionMap;
+
+}  // namespace mathieu_lib
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Constants.h"
+#include "mathieu_lib/mass_list.h"
+#include "mathieu_lib/mathieu.h"
+
+namespace mathieu_lib {
+
+struct ElementCount {
+    std::string symbol;
+    int count;
+};
+
+// Elemental formula such as "C6H12O6" or "Ca(OH)2", one entry per distinct element in order
+// of first appearance. Throws std::invalid_argument for unknown elements, bad syntax or more
+// than a million atoms of one element.
+auto parse_formula(const std::string& formula) -> std::vector<ElementCount>;
+
+struct IsotopeOptions {
+    // Peaks closer than this (Da) are merged at their abundance-weighted mass; 0.5 gives
+    // nominal-mass clusters, a few mDa keeps the fine structure a high-resolution filter sees
+    double merge_width = 0.01;
+    // Peaks below this fraction of the tallest are dropped after every convolution
+    double min_abundance = 1e-6;
+};
+
+// Neutral isotope pattern, ascending in mass. Abundances are probabilities; they sum to 1
+// less whatever pruning dropped.
+struct IsotopeEnvelope {
+    std::vector<double> mass;  // Da
+    std::vector<double> abundance;
+
+    auto size() const -> std::size_t { return mass.size(); }
+};
+
+auto isotope_envelope(const std::string& formula, const IsotopeOptions& options = IsotopeOptions())
+    -> IsotopeEnvelope;
+
+// The envelope at each charge state, m/z = (M + z adduct_mass) / |z| (so negative z with the
+// default proton is the deprotonated ion), as columns for the broadcast batch kernels;
+// intensity holds the abundance
+auto envelope_mass_list(const IsotopeEnvelope& envelope, const std::vector<int>& charge_states,
+                        double adduct_mass = PROTON_MASS) -> MassList;
+
+// Fraction of the envelope of each charge state that lies inside the first stability region
+// at one instrument setting (abundance of the Both-stable peaks over the envelope total)
+auto envelope_transmission(const IsotopeEnvelope& envelope, const std::vector<int>& charge_states,
+                           double voltage_rf, double voltage_dc, const QuadrupoleParams& params,
+                           double adduct_mass = PROTON_MASS) -> std::vector<double>;
+
+}  // namespace mathieu_lib
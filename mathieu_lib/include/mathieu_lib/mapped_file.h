@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace mathieu_lib {
+
+/**
+ * @brief Memory mapping of a whole file, read-only by default.
+ *
+ * ReadWrite maps an existing file shared, so stores through mutable_data() land in the file
+ * and are visible to other processes mapping it. Throws std::runtime_error if the file cannot
+ * be opened or mapped. Empty files map to a null data pointer with size 0.
+ */
+class MappedFile {
+   public:
+    enum class Access { ReadOnly, ReadWrite };
+
+    explicit MappedFile(const std::string& path, Access access = Access::ReadOnly);
+    ~MappedFile();
+    MappedFile(MappedFile&& other) noexcept;
+    auto operator=(MappedFile&& other) noexcept -> MappedFile&;
+    MappedFile(const MappedFile&) = delete;
+    auto operator=(const MappedFile&) -> MappedFile& = delete;
+
+    auto data() const -> const char* { return m_data; }
+    auto size() const -> std::size_t { return m_size; }
+    auto writable() const -> bool { return m_access == Access::ReadWrite; }
+    auto mutable_data() -> char*;
+    void flush();
+
+   private:
+    void release();
+
+    char* m_data = nullptr;
+    std::size_t m_size = 0;
+    Access m_access = Access::ReadOnly;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+};
+
+}  // namespace mathieu_lib
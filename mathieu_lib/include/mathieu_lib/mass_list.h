@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "mathieu_lib/progress.h"
+#include "mathieu_lib/thread_pool.h"
+
+namespace mathieu_lib {
+
+/**
+ * @brief Columnar ion list: one entry per ion in each column.
+ *
+ * The columns are contiguous so they can be handed straight to the broadcast batch kernels
+ * (e.g. mathieu_q_from_mz(v, params, list.mz.data(), list.size(), out)).
+ */
+struct MassList {
+    std::vector<double> mz;         // m/z in Da
+    std::vector<int> charge_state;  // defaults to 1 when the column is absent
+    std::vector<double> intensity;  // defaults to 1.0 when the column is absent
+
+    auto size() const -> std::size_t { return mz.size(); }
+    auto empty() const -> bool { return mz.empty(); }
+};
+
+struct MassListImportOptions {
+    int mz_column = 0;              // zero-based field indices; -1 disables a column
+    int charge_column = 1;
+    int intensity_column = 2;
+    std::size_t chunk_bytes = 8u << 20;  // approximate chunk size handed to each worker
+    ThreadPool* pool = nullptr;          // nullptr = ThreadPool::global()
+    const std::atomic<bool>* cancel = nullptr;  // set to true from any thread to stop early
+    // Called on the importing thread after each finished chunk with (bytes done, bytes total)
+    ProgressCallback progress;
+};
+
+/**
+ * @brief Thrown by the importer when MassListImportOptions::cancel was raised.
+ */
+class ImportCancelled : public std::exception {
+   public:
+    auto what() const noexcept -> const char* override { return "Mass list import cancelled"; }
+};
+
+auto parse_mass_list(const char* data, std::size_t size,
+                     const MassListImportOptions& options = MassListImportOptions())
+    -> MassList;
+auto import_mass_list(const std::string& path,
+                      const MassListImportOptions& options = MassListImportOptions())
+    -> MassList;
+
+}  // namespace mathieu_lib
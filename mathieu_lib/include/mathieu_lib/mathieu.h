@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
 namespace mathieu_lib {
@@ -14,6 +15,19 @@ struct QuadrupoleParams {
         : frequency(freq), quad_radius(radius), molar_mass(mass) {}
 };
 
+// 3D Paul trap: hyperbolic ring electrode of inner radius r0 between two end caps at +-z0.
+// The field scales with r0^2 + 2 z0^2, so traps need not be ideal (r0^2 = 2 z0^2).
+struct PaulTrapParams {
+    double frequency;         // Frequency in Hz
+    double ring_radius;       // r0 in meters
+    double end_cap_distance;  // z0 in meters
+    double molar_mass;        // Molar mass in kg/mol
+
+    PaulTrapParams(double freq, double r0,  // NOLINT(bugprone-easily-swappable-parameters)
+                   double z0, double mass)
+        : frequency(freq), ring_radius(r0), end_cap_distance(z0), molar_mass(mass) {}
+};
+
 #include "Constants.h"
 
 auto omega(double frequency) -> double;
@@ -22,10 +36,15 @@ auto omega(const std::vector<double>& frequencies) -> std::vector<double>;
 auto particle_mass(double molar_mass) -> double;
 auto particle_mass(const std::vector<double>& molar_masses) -> std::vector<double>;
 
-auto beta(double mathieu_q) -> double;
+// Precision-generic kernels (`Real` = float or double, explicitly instantiated in
+// mathieu.cpp). float halves the memory traffic and doubles the SIMD lanes for maps and
+// Monte Carlo runs; see test_mathieu_vector for the error bounds against double.
+template <typename Real>
+auto beta(Real mathieu_q) -> Real;
 auto beta(const std::vector<double>& mathieu_qs) -> std::vector<double>;
 
-auto secular_frequency(double frequency, double mathieu_q) -> double;
+template <typename Real>
+auto secular_frequency(Real frequency, Real mathieu_q) -> Real;
 auto secular_frequency(const std::vector<double>& frequencies,
                        const std::vector<double>& mathieu_qs) -> std::vector<double>;
 
@@ -37,8 +56,38 @@ auto mathieu_a(double voltage_dc, int charge_state, const QuadrupoleParams& para
 auto mathieu_a(const std::vector<double>& voltage_dcs, const std::vector<int>& charge_states,
                const std::vector<QuadrupoleParams>& params) -> std::vector<double>;
 
+// Axial q_z and a_z of a 3D Paul trap with V_rf on the ring and V_dc between ring and end caps;
+// the radial parameters are q_r = -q_z / 2 and a_r = -a_z / 2 (see PaulTrap3D in geometry.h)
+auto mathieu_q(double voltage_rf, int charge_state, const PaulTrapParams& params) -> double;
+auto mathieu_a(double voltage_dc, int charge_state, const PaulTrapParams& params) -> double;
+
+// Broadcast batch forms: one instrument setting applied to a column of ion m/z values (Da).
+// q and a depend only on m/z, so the charge state drops out. The instrument factor is always
+// formed in double; only the per-ion work runs in `Real`.
+template <typename Real>
+void mathieu_q_from_mz(double voltage_rf, const QuadrupoleParams& params, const Real* mzs,
+                       std::size_t count, Real* out);
+auto mathieu_q_from_mz(double voltage_rf, const QuadrupoleParams& params,
+                       const std::vector<double>& mzs) -> std::vector<double>;
+
+template <typename Real>
+void mathieu_a_from_mz(double voltage_dc, const QuadrupoleParams& params, const Real* mzs,
+                       std::size_t count, Real* out);
+auto mathieu_a_from_mz(double voltage_dc, const QuadrupoleParams& params,
+                       const std::vector<double>& mzs) -> std::vector<double>;
+// Paul trap forms, q_z and a_z per ion
+template <typename Real>
+void mathieu_q_from_mz(double voltage_rf, const PaulTrapParams& params, const Real* mzs,
+                       std::size_t count, Real* out);
+template <typename Real>
+void mathieu_a_from_mz(double voltage_dc, const PaulTrapParams& params, const Real* mzs,
+                       std::size_t count, Real* out);
+
 auto mz(double voltage_rf, int charge_state, const QuadrupoleParams& params, double mathieu_q)
     -> double;
+// m/z (Da) at which an ion sits at axial q_z; with MAX_Q this is the trap's low-mass cutoff
+auto mz(double voltage_rf, int charge_state, const PaulTrapParams& params, double mathieu_q)
+    -> double;
 auto mz(const std::vector<double>& voltage_rfs, const std::vector<int>& charge_states,
         const std::vector<QuadrupoleParams>& params, const std::vector<double>& mathieu_qs)
     -> std::vector<double>;
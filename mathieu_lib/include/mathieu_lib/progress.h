@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+namespace mathieu_lib {
+
+// Receives (units done, units total); the unit is engine specific (bytes, chunks, rows)
+using ProgressCallback = std::function<void(std::uint64_t, std::uint64_t)>;
+
+// Cancellation check used by every long-running engine: a null flag never cancels
+inline auto cancel_requested(const std::atomic<bool>* cancel) -> bool {
+    return cancel && cancel->load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Thread-safe progress counter shared by the workers of one long-running operation.
+ *
+ * Workers call advance() as units of work finish. The progress callback and the optional
+ * per-call partial-result hook run one at a time, so callers may stream results from them
+ * without further locking, and the reported count only ever grows. When neither is set,
+ * advance() is a single relaxed atomic add.
+ */
+class ProgressReporter {
+   public:
+    ProgressReporter(ProgressCallback callback, std::uint64_t total, std::uint64_t done = 0);
+
+    auto total() const -> std::uint64_t { return m_total; }
+    auto done() const -> std::uint64_t { return m_done.load(std::memory_order_relaxed); }
+
+    // Reports the current count without advancing it (e.g. work skipped on resume)
+    void report();
+    // Adds `units` finished units; `partial` runs first, under the same lock as the callback
+    auto advance(std::uint64_t units, const std::function<void()>& partial = nullptr)
+        -> std::uint64_t;
+
+   private:
+    ProgressCallback m_callback;
+    std::uint64_t m_total;
+    std::atomic<std::uint64_t> m_done;
+    std::mutex m_mutex;
+};
+
+}  // namespace mathieu_lib
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "mathieu_lib/mathieu.h"
+
+namespace mathieu_lib {
+
+/**
+ * Dehmelt pseudopotential of a linear quadrupole, valid in the adiabatic regime (q <~ 0.4).
+ *
+ * Averaged over the RF cycle, an ion moves in a harmonic well of secular frequency
+ * beta Omega / 2, so the depth at the rods is D = m Omega^2 r0^2 beta^2 / (8 z e). With the
+ * lowest-order beta^2 = a + q^2 / 2 this is D = q V_rf / 8 + V_dc along x (q V_rf / 8 - V_dc
+ * along y), V_rf and V_dc as passed to mathieu_q() and mathieu_a().
+ */
+
+struct Pseudopotential {
+    double depth_x;       // V; well depth at r0 along x
+    double depth_y;       // V; along y
+    double adiabaticity;  // eta = 2 z e |grad E_0| / (m Omega^2); equal to q in a quadrupole
+    double max_energy;    // eV; z * min(depth_x, depth_y), the largest storable radial energy
+};
+
+// beta^2 from the expansion of the characteristic equation to q^6; beta^2 < 0 means unstable.
+// Instantiated for float and double.
+template <typename Real>
+auto adiabatic_beta_squared(Real mathieu_q, Real mathieu_a) -> Real;
+
+auto pseudopotential(double voltage_rf, double voltage_dc, int charge_state,
+                     const QuadrupoleParams& params) -> Pseudopotential;
+
+// Broadcast batch form: depth of the shallower direction (V) for a column of ion m/z values
+// (Da), 0 for ions outside the first stability region. As for mathieu_q_from_mz(), the
+// instrument factors are formed once in double.
+template <typename Real>
+void well_depth_from_mz(double voltage_rf, double voltage_dc, const QuadrupoleParams& params,
+                        const Real* mzs, std::size_t count, Real* out);
+auto well_depth_from_mz(double voltage_rf, double voltage_dc, const QuadrupoleParams& params,
+                        const std::vector<double>& mzs) -> std::vector<double>;
+
+// Gerlich's generalization to a 2n-pole (n = 2: quadrupole) of inscribed radius r0, at radius
+// r: depth (V) = n^2 q V_rf / 32 (r / r0)^(2n - 2) and eta = n (n - 1) q / 2 (r / r0)^(n - 2),
+// with q the quadrupole q for the same r0
+struct MultipolePseudopotential {
+    double depth;
+    double adiabaticity;
+};
+auto multipole_pseudopotential(int poles_half, double voltage_rf, double mathieu_q,
+                               double r_over_r0) -> MultipolePseudopotential;
+
+}  // namespace mathieu_lib
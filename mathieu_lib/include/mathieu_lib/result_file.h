@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "mathieu_lib/mapped_file.h"
+
+namespace mathieu_lib {
+
+/*
+ * Columnar binary result file (.trb), little-endian throughout.
+ *
+ *   [header, 64 bytes]
+ *     0  char[8]  magic "TRAPRES\0"
+ *     8  u16      major version (readers reject other majors)
+ *     10 u16      minor version (additive changes only)
+ *     12 u32      flags (bit 0: chunk statistics present)
+ *     16 u32      column count
+ *     20 u32      reserved
+ *     24 u64      row count
+ *     32 u64      chunk count
+ *     40 u64      footer offset
+ *     48 u8[16]   reserved
+ *   [chunks]  per chunk, each column's values stored contiguously, each column padded to 8 bytes
+ *   [footer]
+ *     u32 column count, then per column: u32 type, u32 name length, name bytes
+ *     u64 chunk count, then per chunk: u64 first row, u64 rows,
+ *         per column: u64 data offset, f64 min, f64 max (NaN when statistics are off)
+ *   [trailer, 16 bytes]  u64 footer offset, char[8] "TRAPEND\0"
+ */
+constexpr std::uint16_t RESULT_FILE_MAJOR_VERSION = 1;
+constexpr std::uint16_t RESULT_FILE_MINOR_VERSION = 0;
+constexpr std::size_t RESULT_FILE_HEADER_SIZE = 64;
+constexpr std::size_t RESULT_FILE_TRAILER_SIZE = 16;
+
+enum class ColumnType : std::uint32_t { Float64 = 1, Int32 = 2, UInt8 = 3 };
+
+struct ColumnSpec {
+    std::string name;
+    ColumnType type;
+};
+
+struct ColumnChunkInfo {
+    std::uint64_t offset;  // byte offset of the first value from the start of the file
+    double min;
+    double max;
+};
+
+struct ResultChunkInfo {
+    std::uint64_t first_row;
+    std::uint64_t rows;
+    std::vector<ColumnChunkInfo> columns;
+};
+
+// Where each column of a single-chunk file starts, for writers filling it in place
+struct ResultFileLayout {
+    std::vector<std::uint64_t> column_offsets;
+    std::uint64_t footer_offset = 0;
+    std::uint64_t file_size = 0;
+};
+
+auto column_type_size(ColumnType type) -> std::size_t;
+auto result_file_layout(const std::vector<ColumnSpec>& columns, std::uint64_t rows)
+    -> ResultFileLayout;
+auto create_preallocated_result_file(const std::string& path,
+                                     const std::vector<ColumnSpec>& columns, std::uint64_t rows)
+    -> ResultFileLayout;
+
+template <typename T>
+constexpr auto column_type_of() -> ColumnType;
+template <>
+constexpr auto column_type_of<double>() -> ColumnType {
+    return ColumnType::Float64;
+}
+template <>
+constexpr auto column_type_of<std::int32_t>() -> ColumnType {
+    return ColumnType::Int32;
+}
+template <>
+constexpr auto column_type_of<std::uint8_t>() -> ColumnType {
+    return ColumnType::UInt8;
+}
+
+/**
+ * @brief Streaming writer: chunks go to disk as they are appended, the footer on close().
+ *
+ * Throws std::runtime_error on I/O failure and std::invalid_argument on misuse.
+ */
+class ResultFileWriter {
+   public:
+    ResultFileWriter(const std::string& path, std::vector<ColumnSpec> columns,
+                     bool chunk_statistics = true);
+    ~ResultFileWriter();
+    ResultFileWriter(const ResultFileWriter&) = delete;
+    auto operator=(const ResultFileWriter&) -> ResultFileWriter& = delete;
+
+    // columns[i] points at `rows` values of m_columns[i].type
+    void write_chunk(const std::vector<const void*>& columns, std::size_t rows);
+    void close();
+
+    auto rows_written() const -> std::uint64_t { return m_rows; }
+
+   private:
+    std::FILE* m_file = nullptr;
+    std::vector<ColumnSpec> m_columns;
+    std::vector<ResultChunkInfo> m_chunks;
+    std::uint64_t m_rows = 0;
+    std::uint64_t m_offset = 0;
+    bool m_statistics;
+};
+
+/**
+ * @brief Zero-copy reader over a memory-mapped result file.
+ *
+ * Column pointers point straight into the mapping and stay valid for the reader's lifetime.
+ * Throws std::runtime_error for malformed or unsupported files.
+ */
+class ResultFileReader {
+   public:
+    explicit ResultFileReader(const std::string& path);
+
+    auto major_version() const -> std::uint16_t { return m_major; }
+    auto minor_version() const -> std::uint16_t { return m_minor; }
+    auto has_statistics() const -> bool { return m_statistics; }
+    auto row_count() const -> std::uint64_t { return m_rows; }
+    auto columns() const -> const std::vector<ColumnSpec>& { return m_columns; }
+    auto chunk_count() const -> std::size_t { return m_chunks.size(); }
+    auto chunk(std::size_t index) const -> const ResultChunkInfo& { return m_chunks.at(index); }
+    auto find_column(const std::string& name) const -> int;
+
+    template <typename T>
+    auto column_data(std::size_t column, std::size_t chunk_index) const -> const T* {
+        if (m_columns.at(column).type != column_type_of<T>())
+            throw std::invalid_argument("Column type mismatch: " + m_columns[column].name);
+        return reinterpret_cast<const T*>(m_file.data() +
+                                          m_chunks.at(chunk_index).columns[column].offset);
+    }
+
+    // Whole column gathered across chunks, converted to the requested type
+    auto read_f64(const std::string& name) const -> std::vector<double>;
+    auto read_i32(const std::string& name) const -> std::vector<int>;
+
+   private:
+    template <typename Out>
+    auto gather(const std::string& name) const -> std::vector<Out>;
+
+    MappedFile m_file;
+    std::uint16_t m_major = 0;
+    std::uint16_t m_minor = 0;
+    bool m_statistics = false;
+    std::uint64_t m_rows = 0;
+    std::vector<ColumnSpec> m_columns;
+    std::vector<ResultChunkInfo> m_chunks;
+};
+
+}  // namespace mathieu_lib
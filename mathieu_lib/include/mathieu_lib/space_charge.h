@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mathieu_lib/mathieu.h"
+#include "mathieu_lib/stability.h"
+
+namespace mathieu_lib {
+
+/**
+ * Mean-field space charge in a linear quadrupole.
+ *
+ * Inside a long cloud of line charge lambda the ions' own field is, to first order, linear
+ * and defocusing: E_x = G_x x, E_y = G_y y. Added to the quadrupole field this turns the x
+ * equation into u'' + (a - delta_x - 2q cos 2xi) u = 0 and the y equation into the Mathieu
+ * equation at -(a + delta_y), with delta_u = 4 e N_A G_u / ((m/z) Omega^2) for m/z in Da.
+ * q is unchanged; the x motion is stable where classify_stability(q, a - delta_x) has its X
+ * bit and the y motion where classify_stability(q, a + delta_y) has its Y bit.
+ */
+
+enum class CloudProfile : std::uint8_t {
+    Uniform,   // uniformly filled ellipse; the field is exactly linear inside
+    Gaussian,  // bi-Gaussian; replaced by the uniform ellipse of the same rms size
+};
+
+struct IonCloud {
+    double ions = 0.0;  // number of ions
+    int charge_state = 1;
+    double length = 0.05;  // m, axial extent the ions fill
+    double size_x = 1e-3;  // m; Uniform: semi-axis, Gaussian: rms width
+    double size_y = 1e-3;  // m
+    CloudProfile profile = CloudProfile::Uniform;
+};
+
+// Field gradients dE_x/dx and dE_y/dy (V/m^2) inside a cloud
+struct SpaceChargeGradient {
+    double x = 0.0;
+    double y = 0.0;
+};
+
+// Throws std::invalid_argument for a negative ion count, a nonpositive length or size
+auto space_charge_gradient(const IonCloud& cloud) -> SpaceChargeGradient;
+// Coaxial populations (e.g. one cloud per species) superpose
+auto space_charge_gradient(const std::vector<IonCloud>& clouds) -> SpaceChargeGradient;
+
+// Broadcast batch form over a column of ion m/z values (Da): the unchanged q and the
+// effective a_x = a - delta_x and a_y = a + delta_y defined above. As for
+// mathieu_q_from_mz(), the instrument factors are formed once in double.
+template <typename Real>
+void space_charge_qa_from_mz(double voltage_rf, double voltage_dc, const QuadrupoleParams& params,
+                             const SpaceChargeGradient& gradient, const Real* mzs,
+                             std::size_t count, Real* q, Real* a_x, Real* a_y);
+// Stability of each ion in the shifted diagram, from the batch classify_stability()
+template <typename Real>
+void classify_space_charge_from_mz(double voltage_rf, double voltage_dc,
+                                   const QuadrupoleParams& params,
+                                   const SpaceChargeGradient& gradient, const Real* mzs,
+                                   std::size_t count, StabilityClass* out);
+
+struct SpaceChargeColumns {
+    std::vector<double> q, a_x, a_y;
+    std::vector<StabilityClass> stability;
+};
+auto space_charge_qa_from_mz(double voltage_rf, double voltage_dc, const QuadrupoleParams& params,
+                             const SpaceChargeGradient& gradient, const std::vector<double>& mzs)
+    -> SpaceChargeColumns;
+
+/**
+ * @brief Transverse space-charge field of a set of line charges on a square grid.
+ *
+ * The grid spans |x|, |y| <= half_width with `nodes` interior nodes per direction and a
+ * grounded boundary; with half_width = r0 the square touches the four rod tips. Charges are
+ * deposited cloud-in-cell and the Poisson equation is solved exactly for the 5-point
+ * Laplacian with two sine transforms, done as dense products (O(nodes^3), cheap for the
+ * 16 to 64 nodes a mean field needs). The field is interpolated bilinearly.
+ */
+class SpaceChargeGrid {
+   public:
+    SpaceChargeGrid(double half_width, std::size_t nodes);
+
+    auto nodes() const -> std::size_t { return m_nodes; }
+    auto spacing() const -> double { return m_spacing; }
+
+    void clear();
+    // Adds a line charge (C/m) at (x, y); charge outside the grid is dropped
+    void deposit(double x, double y, double charge_per_length);
+    // Solves for the field of the charge deposited since clear()
+    void solve();
+    // Field (V/m) at `count` points
+    void field(const double* x, const double* y, std::size_t count, double* ex,
+               double* ey) const;
+
+   private:
+    void sine_transform(std::vector<double>& grid) const;  // interior nodes, both directions
+
+    double m_half_width;
+    std::size_t m_nodes;
+    double m_spacing;
+    std::vector<double> m_sine;     // sin(i k pi / (nodes + 1)), nodes x nodes
+    std::vector<double> m_inverse;  // 1 / (eps0 mu_kl) scaled for the inverse transform
+    std::vector<double> m_charge;   // C/m per node, (nodes + 2)^2 with the boundary
+    std::vector<double> m_ex, m_ey;
+};
+
+}  // namespace mathieu_lib
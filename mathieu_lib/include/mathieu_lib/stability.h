@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "mathieu_lib/geometry.h"
+
+namespace mathieu_lib {
+
+// Distances from a (q, a) point to the upper boundary of the first stability region
+struct BoundaryMargins {
+    bool stable;
+    double q_boundary;  // nearest boundary point
+    double a_boundary;
+    double delta_a;  // vertical distance (a_boundary - a)
+    double delta_q;  // horizontal distance |q_boundary - q|
+    double delta_e;  // Euclidean distance
+};
+
+// First stability region in the diagram coordinates of `Geometry` (see geometry.h), between
+// lower_boundary and upper_boundary for 0 <= q <= FIRST_REGION_Q_MAX; both are 0 outside.
+// The linear quadrupole's region is symmetric in a, so only its a >= 0 half is used: the lower
+// boundary is the q axis. Instantiated for float and double and both geometries.
+template <typename Real, typename Geometry = LinearQuadrupole>
+auto upper_boundary(Real q) -> Real;
+template <typename Real, typename Geometry = LinearQuadrupole>
+auto lower_boundary(Real q) -> Real;
+template <typename Real, typename Geometry = LinearQuadrupole>
+auto is_stable(Real q, Real a) -> bool;
+// Batch form: out[i] = 1 if (qs[i], as[i]) is stable, else 0
+template <typename Real, typename Geometry = LinearQuadrupole>
+void is_stable(const Real* qs, const Real* as, std::size_t count, std::uint8_t* out);
+
+// Directions in which the geometry confines an ion at (q, a): X for the primary direction
+// (x, or z of a Paul trap), stable for a_0(|q|) <= a <= b_1(|q|), and Y for the secondary one
+// (y, or r). For a linear quadrupole (a_y = -a, q_y = -q) y is stable for
+// -b_1(|q|) <= a <= -a_0(|q|). The bits combine, so Both == X | Y and the first stability
+// region is Both.
+enum class StabilityClass : std::uint8_t { None = 0, X = 1, Y = 2, Both = 3 };
+
+// The class with the X bit set where `x` holds and the Y bit where `y` does
+constexpr auto make_stability_class(bool x, bool y) -> StabilityClass {
+    return static_cast<StabilityClass>(static_cast<unsigned>(x) | (static_cast<unsigned>(y) << 1));
+}
+// X bit of `x_from` with the Y bit of `y_from`, for directions classified separately
+constexpr auto merge_stability(StabilityClass x_from, StabilityClass y_from) -> StabilityClass {
+    return static_cast<StabilityClass>(
+        (static_cast<unsigned>(x_from) & static_cast<unsigned>(StabilityClass::X)) |
+        (static_cast<unsigned>(y_from) & static_cast<unsigned>(StabilityClass::Y)));
+}
+
+// Instantiated for float and double and both geometries; full a range, either sign of q
+template <typename Real, typename Geometry = LinearQuadrupole>
+auto classify_stability(Real q, Real a) -> StabilityClass;
+// Batch form sharing the boundary tables of the scalar classifier
+template <typename Real, typename Geometry = LinearQuadrupole>
+void classify_stability(const Real* qs, const Real* as, std::size_t count, StabilityClass* out);
+
+// Linear quadrupole only
+auto nearest_boundary_point(double q, double a) -> std::pair<double, double>;
+auto boundary_margins(double q, double a) -> BoundaryMargins;
+
+}  // namespace mathieu_lib
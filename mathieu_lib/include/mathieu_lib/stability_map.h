@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "mathieu_lib/progress.h"
+#include "mathieu_lib/thread_pool.h"
+
+namespace mathieu_lib {
+
+/**
+ * @brief Regular (q, a) grid; cells are sampled at their centers, which run from
+ *        (q_min, a_min) to (q_max, a_max) inclusive.
+ */
+struct StabilityMapSpec {
+    double q_min = 0.0;
+    double q_max = 0.0;
+    std::size_t q_cells = 0;
+    double a_min = 0.0;
+    double a_max = 0.0;
+    std::size_t a_cells = 0;
+
+    auto cell_q(std::size_t column) const -> double;
+    auto cell_a(std::size_t row) const -> double;
+    auto cell_count() const -> std::size_t { return q_cells * a_cells; }
+};
+
+struct StabilityMapOptions {
+    std::size_t band_rows = 8;                  // a-rows per work item and per on_rows call
+    ThreadPool* pool = nullptr;                 // nullptr = ThreadPool::global()
+    const std::atomic<bool>* cancel = nullptr;  // set to true from any thread to stop early
+    // Called after each finished band with (rows done, rows total); serialized, pool threads
+    ProgressCallback progress;
+    // Called with (first row, row count, margins of those rows) as each band finishes, in
+    // completion order and serialized with `progress`
+    std::function<void(std::size_t, std::size_t, const double*)> on_rows;
+};
+
+/**
+ * @brief Signed distance from every cell to the upper boundary of the first stability
+ *        region: delta_e inside the region, -delta_e outside (so signbit() marks unstable
+ *        cells even on the boundary).
+ */
+struct StabilityMap {
+    StabilityMapSpec spec;
+    std::vector<double> margin;  // a_cells rows of q_cells values, row 0 at a_min
+    bool complete = false;       // false if cancelled; unfinished bands hold NaN
+
+    auto at(std::size_t column, std::size_t row) const -> double {
+        return margin[row * spec.q_cells + column];
+    }
+};
+
+auto rasterize_stability(const StabilityMapSpec& spec,
+                         const StabilityMapOptions& options = StabilityMapOptions())
+    -> StabilityMap;
+
+}  // namespace mathieu_lib
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "mathieu_lib/thread_pool.h"
+
+namespace mathieu_lib {
+
+/**
+ * @brief A stability region of the linear quadrupole (a_y = -a, q_y = -q), named by the bands
+ *        its two motions lie in: x in band r means a_r(q) <= a <= b_{r+1}(q), i.e.
+ *        beta_x in [r, r + 1], and y in band s means -b_{s+1}(q) <= a <= -a_s(q).
+ *        (0, 0) is the first region.
+ */
+struct RegionId {
+    int x_order = 0;
+    int y_order = 0;
+
+    auto operator==(const RegionId& other) const -> bool {
+        return x_order == other.x_order && y_order == other.y_order;
+    }
+    auto operator<(const RegionId& other) const -> bool {
+        return std::tie(x_order, y_order) < std::tie(other.x_order, other.y_order);
+    }
+};
+
+// One connected q span of a region: lower and upper a bounds on the sample grid, closed at
+// either end by the point where the bounds meet (found by bisection between grid points)
+struct RegionSpan {
+    std::vector<double> q;
+    std::vector<double> a_lower;
+    std::vector<double> a_upper;
+};
+
+struct StabilityRegion {
+    RegionId id;
+    std::vector<RegionSpan> spans;  // empty if the region does not reach into [0, q_max]
+};
+
+// Band orders of (q, a); a member is -1 where that motion is unstable, or stable only in a
+// band above max_order
+auto locate_stability_region(double q, double a, int max_order = 4) -> RegionId;
+
+struct StabilityRegionOptions {
+    ThreadPool* pool = nullptr;                 // nullptr = ThreadPool::global()
+    const std::atomic<bool>* cancel = nullptr;  // set to true from any thread to stop early
+};
+
+/**
+ * @brief Region boundaries over 0 <= q <= q_max from the exact characteristic values,
+ *        computed on first request and kept per region. The characteristic curves are
+ *        sampled once on the q grid and shared by all regions they bound. Safe to share
+ *        between threads.
+ */
+class StabilityRegionCache {
+   public:
+    StabilityRegionCache(double q_max, std::size_t samples);
+
+    auto q_max() const -> double { return m_q_max; }
+    auto samples() const -> std::size_t { return m_samples; }
+    auto cached_count() const -> std::size_t;
+
+    // nullptr if cancelled before the region was finished
+    auto region(RegionId id, const StabilityRegionOptions& options = StabilityRegionOptions())
+        -> std::shared_ptr<const StabilityRegion>;
+    // Every non-empty region with both orders <= max_order, in RegionId order; missing regions
+    // are computed in parallel. Regions not finished before a cancel are left out.
+    auto regions(int max_order, const StabilityRegionOptions& options = StabilityRegionOptions())
+        -> std::vector<std::shared_ptr<const StabilityRegion>>;
+
+   private:
+    using Curve = std::shared_ptr<const std::vector<double>>;
+
+    // a_order (sine = false) or b_order (sine = true) on the q grid; nullptr if cancelled
+    auto curve(bool sine, int order, const StabilityRegionOptions& options) -> Curve;
+    auto compute(RegionId id, const StabilityRegionOptions& options)
+        -> std::shared_ptr<const StabilityRegion>;
+    auto grid_q(std::size_t i) const -> double { return m_q_max * i / (m_samples - 1); }
+
+    double m_q_max;
+    std::size_t m_samples;
+    mutable std::mutex m_mutex;
+    std::map<std::pair<bool, int>, Curve> m_curves;
+    std::map<RegionId, std::shared_ptr<const StabilityRegion>> m_regions;
+};
+
+}  // namespace mathieu_lib
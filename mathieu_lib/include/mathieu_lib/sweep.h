@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "mathieu_lib/mapped_file.h"
+#include "mathieu_lib/progress.h"
+#include "mathieu_lib/result_file.h"
+#include "mathieu_lib/thread_pool.h"
+
+namespace mathieu_lib {
+
+/**
+ * @brief Cartesian parameter sweep.
+ *
+ * Points are numbered in row-major order over (frequency, quad_radius, voltage_rf, voltage_dc,
+ * charge_state, mass), mass varying fastest, so a point index always names the same
+ * parameters for a given spec.
+ */
+struct SweepSpec {
+    std::vector<double> frequency;    // Hz
+    std::vector<double> quad_radius;  // m
+    std::vector<double> voltage_rf;   // V
+    std::vector<double> voltage_dc;   // V
+    std::vector<int> charge_state;
+    std::vector<double> mass;  // Da
+
+    auto point_count() const -> std::uint64_t;
+};
+
+// Columnar results for a contiguous range of sweep points
+struct SweepColumns {
+    std::vector<double> frequency, quad_radius, voltage_rf, voltage_dc;
+    std::vector<std::int32_t> charge_state;
+    std::vector<double> mass, mz, q, a, beta, secular_khz;
+    std::vector<std::uint8_t> stable;
+    std::vector<double> delta_a, delta_q, delta_e;
+
+    // Pointers in sweep_result_columns() order, for ResultFileWriter::write_chunk
+    auto column_pointers() const -> std::vector<const void*>;
+};
+
+struct SweepOptions {
+    std::uint64_t chunk_points = 1u << 16;  // points per chunk file; part of the sweep identity
+    ThreadPool* pool = nullptr;             // nullptr = ThreadPool::global()
+    const std::atomic<bool>* cancel = nullptr;  // set to true from any thread to stop early
+    // Called after each finished chunk with (chunks done, chunks total); calls are serialized
+    // but may come from pool threads
+    ProgressCallback progress;
+    // Called with (first point, results) as each chunk lands on disk, in completion order,
+    // serialized with `progress`; lets callers stream partial results while the sweep runs
+    std::function<void(std::uint64_t, const SweepColumns&)> on_chunk;
+};
+
+struct SweepSummary {
+    std::size_t total_chunks = 0;
+    std::size_t skipped_chunks = 0;   // already complete from an earlier run
+    std::size_t computed_chunks = 0;  // written by this run
+    bool cancelled = false;
+};
+
+auto sweep_result_columns() -> std::vector<ColumnSpec>;
+auto compute_sweep_range(const SweepSpec& spec, std::uint64_t first, std::size_t count)
+    -> SweepColumns;
+auto sweep_chunk_count(const SweepSpec& spec, std::uint64_t chunk_points) -> std::size_t;
+auto sweep_chunk_path(const std::string& directory, std::size_t chunk) -> std::string;
+auto run_sweep(const SweepSpec& spec, const std::string& directory,
+               const SweepOptions& options = SweepOptions()) -> SweepSummary;
+
+// Contiguous slice [first, first + count) of `total` points owned by shard `shard` of `shards`
+struct SweepShard {
+    std::uint64_t first;
+    std::uint64_t count;
+};
+auto sweep_shard(std::uint64_t total, unsigned shard, unsigned shards) -> SweepShard;
+
+// Fills rows [first, first + count) of a preallocated single-chunk sweep result file in place.
+// `progress` receives the number of rows written so far after each block.
+void write_sweep_range(const SweepSpec& spec, std::uint64_t first, std::uint64_t count,
+                       MappedFile& file,
+                       const std::function<void(std::uint64_t)>& progress = nullptr,
+                       std::size_t block_points = 1u << 16);
+
+}  // namespace mathieu_lib
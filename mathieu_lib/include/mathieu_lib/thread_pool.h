@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace mathieu_lib {
+
+/**
+ * @brief Shareable cooperative cancellation flag.
+ *
+ * Copies refer to the same flag. flag() plugs into the `cancel` member of the option structs
+ * (MassListImportOptions, SweepOptions, ParallelForOptions).
+ */
+class CancellationToken {
+   public:
+    CancellationToken() : m_flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() const { m_flag->store(true, std::memory_order_relaxed); }
+    void reset() const { m_flag->store(false, std::memory_order_relaxed); }
+    auto cancelled() const -> bool { return m_flag->load(std::memory_order_relaxed); }
+    auto flag() const -> const std::atomic<bool>* { return m_flag.get(); }
+
+   private:
+    std::shared_ptr<std::atomic<bool>> m_flag;
+};
+
+struct ParallelForOptions {
+    std::size_t grain = 0;  // max indices per body call; 0 = derived from range and thread count
+    const std::atomic<bool>* cancel = nullptr;  // stops handing out new index blocks when set
+};
+
+/**
+ * @brief Work-stealing task scheduler.
+ *
+ * Each worker owns a deque: it pushes and pops its own tasks at the back and steals from the
+ * front of the others' when idle. Tasks submitted from outside the pool go to a shared
+ * injection queue. Threads waiting on parallel_for() run queued tasks while they wait, so
+ * nested parallel loops do not deadlock.
+ */
+class ThreadPool {
+   public:
+    static constexpr unsigned MAX_THREADS = 1024;  // larger requests are clamped
+
+    explicit ThreadPool(unsigned threads = 0);  // 0 = std::thread::hardware_concurrency()
+    ~ThreadPool();                              // runs all queued tasks, then joins
+    ThreadPool(const ThreadPool&) = delete;
+    auto operator=(const ThreadPool&) -> ThreadPool& = delete;
+
+    auto thread_count() const -> unsigned { return static_cast<unsigned>(m_threads.size()); }
+
+    void submit(std::function<void()> task);
+
+    template <typename F>
+    auto async(F&& function) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(function));
+        std::future<Result> future = task->get_future();
+        submit([task]() { (*task)(); });
+        return future;
+    }
+
+    // Calls body(first, last) over disjoint blocks covering [begin, end). Returns false if the
+    // loop was cancelled; rethrows the first exception thrown by body.
+    auto parallel_for(std::size_t begin, std::size_t end,
+                      const std::function<void(std::size_t, std::size_t)>& body,
+                      const ParallelForOptions& options = ParallelForOptions()) -> bool;
+
+    // Process-wide pool shared by the GUI, the CLI and the library's parallel engines
+    static auto global() -> ThreadPool&;
+    // Sizes the global pool, at most MAX_THREADS; only effective before its first use (returns
+    // false afterwards)
+    static auto set_global_thread_count(unsigned threads) -> bool;
+
+   private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void worker_loop(std::size_t index);
+    auto try_pop(std::function<void()>& task) -> bool;
+    auto run_pending_task() -> bool;
+
+    std::vector<std::unique_ptr<Queue>> m_queues;  // one per worker, then the injection queue
+    std::vector<std::thread> m_threads;
+    std::atomic<std::size_t> m_queued{0};
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_wake;
+    bool m_stop = false;
+};
+
+}  // namespace mathieu_lib
@@ -0,0 +1,184 @@
+// NOLINTBEGIN(readability-magic-numbers)
+
+/**
+ * @file acceptance.cpp
+ * @brief Courant-Snyder parameters over the RF phase, acceptance and beam emittance.
+ */
+#include "mathieu_lib/acceptance.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+#include "Constants.h"
+
+namespace mathieu_lib {
+
+namespace {
+
+// Inverse of a unimodular matrix
+auto inverse(const TransferMatrix& m) -> TransferMatrix { return {m.m22, -m.m12, -m.m21, m.m11}; }
+
+/**
+ * @brief Twiss parameters at every step boundary from the one-period matrices
+ *        M_{k+1} = S_k M_k S_k^-1, with M = [[cos mu + alpha sin mu, beta sin mu],
+ *        [-gamma sin mu, cos mu - alpha sin mu]]. The sign of sin mu is the one that makes
+ *        beta positive; it is the same at every phase.
+ */
+auto twiss_table(const std::vector<TransferMatrix>& steps, double r0) -> TwissTable {
+    TransferMatrix period;
+    for (const TransferMatrix& s : steps) period = period.then(s);
+    TwissTable table;
+    const double cos_mu = 0.5 * period.trace();
+    if (!(std::abs(cos_mu) < 1.0))
+        return table;
+    const double sin_mu = std::copysign(std::sqrt(1.0 - cos_mu * cos_mu), period.m12);
+    table.phase_advance = std::acos(cos_mu);
+    table.twiss.reserve(steps.size());
+    double max_beta = 0.0;
+    for (const TransferMatrix& s : steps) {
+        Twiss t;
+        t.alpha = (period.m11 - period.m22) / (2.0 * sin_mu);
+        t.beta = period.m12 / sin_mu;
+        t.gamma = -period.m21 / sin_mu;
+        max_beta = std::max(max_beta, t.beta);
+        table.twiss.push_back(t);
+        period = inverse(s).then(period).then(s);
+    }
+    table.acceptance = r0 * r0 / max_beta;
+    return table;
+}
+
+}  // namespace
+
+/**
+ * @throws std::invalid_argument if r0 is not positive.
+ */
+AcceptanceTable::AcceptanceTable(const HillEquation& hill, double q, double a, double r0)
+    : m_q(q), m_a(a), m_r0(r0), m_phases(hill.steps_per_period()) {
+    if (!(r0 > 0.0))
+        throw std::invalid_argument("Acceptance needs a positive field radius");
+    m_x = twiss_table(hill.step_matrices(q, a), r0);
+    m_y = twiss_table(hill.step_matrices(-q, -a), r0);
+}
+
+auto AcceptanceTable::index(double xi) const -> std::size_t {
+    const double turns = xi / M_PI;
+    const double offset = (turns - std::floor(turns)) * static_cast<double>(m_phases);
+    return static_cast<std::size_t>(std::lround(offset)) % m_phases;
+}
+
+auto AcceptanceTable::accepts(std::size_t phase, double x, double dx, double y, double dy) const
+    -> bool {
+    if (!m_x.stable() || !m_y.stable())
+        return false;
+    return m_x.twiss[phase].invariant(x, dx) <= m_x.acceptance &&
+           m_y.twiss[phase].invariant(y, dy) <= m_y.acceptance;
+}
+
+void AcceptanceTable::accepts(const double* xi, const double* x, const double* dx,
+                              const double* y, const double* dy, std::size_t count,
+                              std::uint8_t* out) const {
+    for (std::size_t i = 0; i < count; ++i)
+        out[i] = accepts(index(xi[i]), x[i], dx[i], y[i], dy[i]) ? 1 : 0;
+}
+
+/**
+ * @brief The invariant of a uniform fill is uniform in [0, acceptance], so s1 sets it and s2
+ *        the angle on its ellipse. An unstable table has no ellipse and returns the origin.
+ */
+auto AcceptanceTable::launch(const TwissTable& table, std::size_t phase, double s1, double s2)
+    -> PhaseSpacePoint {
+    if (!table.stable())
+        return {0.0, 0.0};
+    const Twiss& t = table.twiss[phase];
+    const double invariant = table.acceptance * s1;
+    const double angle = 2.0 * M_PI * s2;
+    const double c = std::cos(angle);
+    const double s = std::sin(angle);
+    return {std::sqrt(invariant * t.beta) * c,
+            -std::sqrt(invariant / t.beta) * (t.alpha * c + s)};
+}
+
+/**
+ * @brief Emittance sqrt(<u^2><u'^2> - <u u'>^2) about the centroid, and the Twiss
+ *        parameters of the ellipse with those second moments.
+ *
+ * @throws std::invalid_argument if count is zero.
+ */
+auto rms_ellipse(const double* u, const double* du, std::size_t count) -> BeamEllipse {
+    if (count == 0)
+        throw std::invalid_argument("An rms ellipse needs at least one ion");
+    double mean_u = 0.0;
+    double mean_du = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        mean_u += u[i];
+        mean_du += du[i];
+    }
+    mean_u /= count;
+    mean_du /= count;
+    double uu = 0.0;
+    double ud = 0.0;
+    double dd = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const double cu = u[i] - mean_u;
+        const double cd = du[i] - mean_du;
+        uu += cu * cu;
+        ud += cu * cd;
+        dd += cd * cd;
+    }
+    uu /= count;
+    ud /= count;
+    dd /= count;
+    BeamEllipse beam;
+    beam.emittance = std::sqrt(std::max(uu * dd - ud * ud, 0.0));
+    if (beam.emittance > 0.0)
+        beam.twiss = {-ud / beam.emittance, uu / beam.emittance, dd / beam.emittance};
+    return beam;
+}
+auto rms_ellipse(const std::vector<double>& u, const std::vector<double>& du) -> BeamEllipse {
+    if (u.size() != du.size())
+        throw std::invalid_argument("Position and slope columns must have the same length");
+    return rms_ellipse(u.data(), du.data(), u.size());
+}
+
+auto max_invariant(const BeamEllipse& beam, const Twiss& machine) -> double {
+    const double r = 0.5 * (machine.beta * beam.twiss.gamma + beam.twiss.beta * machine.gamma -
+                            2.0 * machine.alpha * beam.twiss.alpha);
+    return beam.emittance * (r + std::sqrt(std::max(r * r - 1.0, 0.0)));
+}
+
+AcceptanceCache::AcceptanceCache(HillEquation hill) : m_hill(std::move(hill)) {}
+
+auto AcceptanceCache::cached_count() const -> std::size_t {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tables.size();
+}
+
+/**
+ * @brief Returns the cached table, building it outside the lock if needed; when two threads
+ *        race on one operating point the first to finish is kept.
+ */
+auto AcceptanceCache::table(double q, double a, double r0)
+    -> std::shared_ptr<const AcceptanceTable> {
+    const std::tuple<double, double, double> key(q, a, r0);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto found = m_tables.find(key);
+        if (found != m_tables.end())
+            return found->second;
+    }
+    auto built = std::make_shared<const AcceptanceTable>(m_hill, q, a, r0);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tables.emplace(key, std::move(built)).first->second;
+}
+
+void AcceptanceCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tables.clear();
+}
+
+}  // namespace mathieu_lib
+
+// NOLINTEND(readability-magic-numbers)
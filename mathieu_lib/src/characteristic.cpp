@@ -0,0 +1,171 @@
+// NOLINTBEGIN(readability-magic-numbers)
+
+/**
+ * @file characteristic.cpp
+ * @brief Characteristic values of Mathieu's equation: exact solver and Chebyshev fast path.
+ */
+#include "mathieu_lib/characteristic.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace mathieu_lib {
+
+namespace {
+
+/**
+ * @brief Number of eigenvalues below x of the symmetric tridiagonal matrix with diagonal d
+ *        and off-diagonal squares e2 (Sturm sequence count).
+ */
+auto sturm_count(const std::vector<double>& d, const std::vector<double>& e2, double x) -> int {
+    int count = 0;
+    double p = d[0] - x;
+    for (std::size_t i = 0;; ++i) {
+        if (p < 0.0)
+            ++count;
+        if (i + 1 == d.size())
+            return count;
+        if (p == 0.0)
+            p = std::numeric_limits<double>::epsilon() * (std::abs(x) + 1.0);
+        p = d[i + 1] - x - e2[i] / p;
+    }
+}
+
+/**
+ * @brief k-th smallest eigenvalue (k >= 0) of a symmetric tridiagonal matrix by bisection on
+ *        the Sturm count, starting from the Gershgorin interval.
+ */
+auto tridiagonal_eigenvalue(const std::vector<double>& d, const std::vector<double>& e2, int k)
+    -> double {
+    double lo = std::numeric_limits<double>::max();
+    double hi = std::numeric_limits<double>::lowest();
+    for (std::size_t i = 0; i < d.size(); ++i) {
+        const double radius = (i > 0 ? std::sqrt(e2[i - 1]) : 0.0) +
+                              (i + 1 < d.size() ? std::sqrt(e2[i]) : 0.0);
+        lo = std::min(lo, d[i] - radius);
+        hi = std::max(hi, d[i] + radius);
+    }
+    for (int iteration = 0; iteration < 200; ++iteration) {
+        const double mid = 0.5 * (lo + hi);
+        if (mid <= lo || mid >= hi)
+            break;
+        if (sturm_count(d, e2, mid) > k)
+            hi = mid;
+        else
+            lo = mid;
+    }
+    return 0.5 * (lo + hi);
+}
+
+/**
+ * @brief Eigenvalue `k` of the recurrence matrix of one Fourier family.
+ *
+ * Families: even cosine (a_2n), odd cosine (a_2n+1), even sine (b_2n+2), odd sine (b_2n+1).
+ * The truncation leaves a dozen or more rows beyond both the requested order and the
+ * sqrt(q) band in which the Fourier coefficients are still significant.
+ */
+enum class Family { EvenCos, OddCos, EvenSin, OddSin };
+
+auto family_eigenvalue(Family family, int k, double q) -> double {
+    // Bounds the truncation: at most EXACT_SOLVER_ORDER_MAX / 2 + 16 + 2e4 rows. NaN fails too.
+    if (!(std::abs(q) <= EXACT_SOLVER_Q_MAX))
+        throw std::invalid_argument("Characteristic values need finite |q| <= 1e8");
+    const int size = k + 16 + 2 * static_cast<int>(std::ceil(std::sqrt(std::abs(q))));
+    std::vector<double> d(size), e2(size - 1, q * q);
+    for (int r = 0; r < size; ++r) {
+        double n = 0.0;  // harmonic of row r
+        switch (family) {
+            case Family::EvenCos: n = 2.0 * r; break;
+            case Family::OddCos:
+            case Family::OddSin: n = 2.0 * r + 1.0; break;
+            case Family::EvenSin: n = 2.0 * r + 2.0; break;
+        }
+        d[r] = n * n;
+    }
+    if (family == Family::EvenCos)
+        e2[0] = 2.0 * q * q;  // the constant term couples with weight 2; symmetrized
+    if (family == Family::OddCos)
+        d[0] += q;
+    if (family == Family::OddSin)
+        d[0] -= q;
+    return tridiagonal_eigenvalue(d, e2, k);
+}
+
+}  // namespace
+
+/**
+ * @brief Characteristic value a_r(q) of the even periodic Mathieu function ce_r.
+ *
+ * Bisection on the Sturm count of the symmetric tridiagonal recurrence matrix converges to
+ * full double precision and cannot pick the wrong eigenvalue, for any q and order in range.
+ *
+ * @throws std::invalid_argument if order is outside [0, EXACT_SOLVER_ORDER_MAX] or q is not
+ *         finite with |q| <= EXACT_SOLVER_Q_MAX.
+ */
+auto characteristic_a(int order, double q) -> double {
+    if (order < 0 || order > EXACT_SOLVER_ORDER_MAX)
+        throw std::invalid_argument("Characteristic value a_r needs 0 <= r <= 10000");
+    return order % 2 == 0 ? family_eigenvalue(Family::EvenCos, order / 2, q)
+                          : family_eigenvalue(Family::OddCos, order / 2, q);
+}
+
+/**
+ * @brief Characteristic value b_r(q) of the odd periodic Mathieu function se_r.
+ *
+ * @throws std::invalid_argument if order is outside [1, EXACT_SOLVER_ORDER_MAX] or q is out
+ *         of range, as for characteristic_a().
+ */
+auto characteristic_b(int order, double q) -> double {
+    if (order < 1 || order > EXACT_SOLVER_ORDER_MAX)
+        throw std::invalid_argument("Characteristic value b_r needs 1 <= r <= 10000");
+    return order % 2 == 0 ? family_eigenvalue(Family::EvenSin, order / 2 - 1, q)
+                          : family_eigenvalue(Family::OddSin, order / 2, q);
+}
+
+/**
+ * @brief a_0(q) from the Chebyshev table (|q| <= CHEBYSHEV_Q_MAX), exact solver otherwise.
+ *        a_0 is even in q.
+ */
+template <typename Real>
+auto characteristic_a0(Real q) -> Real {
+    q = std::abs(q);
+    if (q > Real(CHEBYSHEV_Q_MAX))
+        return static_cast<Real>(characteristic_a(0, q));
+    return chebyshev_table_eval(CHEBYSHEV_A0, q);
+}
+template auto characteristic_a0<float>(float) -> float;
+template auto characteristic_a0<double>(double) -> double;
+
+/**
+ * @brief b_1(q) from the Chebyshev table (0 <= q <= CHEBYSHEV_Q_MAX), exact solver otherwise
+ *        (b_1(-q) = a_1(q) is not tabulated).
+ */
+template <typename Real>
+auto characteristic_b1(Real q) -> Real {
+    if (q < Real(0) || q > Real(CHEBYSHEV_Q_MAX))
+        return static_cast<Real>(characteristic_b(1, q));
+    return chebyshev_table_eval(CHEBYSHEV_B1, q);
+}
+template auto characteristic_b1<float>(float) -> float;
+template auto characteristic_b1<double>(double) -> double;
+
+template <typename Real>
+void characteristic_a0(const Real* qs, std::size_t count, Real* out) {
+    for (std::size_t i = 0; i < count; ++i) out[i] = chebyshev_table_eval(CHEBYSHEV_A0, qs[i]);
+}
+template void characteristic_a0<float>(const float*, std::size_t, float*);
+template void characteristic_a0<double>(const double*, std::size_t, double*);
+
+template <typename Real>
+void characteristic_b1(const Real* qs, std::size_t count, Real* out) {
+    for (std::size_t i = 0; i < count; ++i) out[i] = chebyshev_table_eval(CHEBYSHEV_B1, qs[i]);
+}
+template void characteristic_b1<float>(const float*, std::size_t, float*);
+template void characteristic_b1<double>(const double*, std::size_t, double*);
+
+}  // namespace mathieu_lib
+
+// NOLINTEND(readability-magic-numbers)
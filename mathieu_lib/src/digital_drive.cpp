@@ -0,0 +1,192 @@
+// NOLINTBEGIN(readability-magic-numbers)
+
+/**
+ * @file digital_drive.cpp
+ * @brief Stability and beta under piecewise-constant drives from closed-form transfer matrices.
+ */
+#include "mathieu_lib/digital_drive.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "Constants.h"
+
+namespace mathieu_lib {
+
+/**
+ * @throws std::invalid_argument if there are no segments, a fraction is not positive or a
+ *         value is not finite.
+ */
+PiecewiseWaveform::PiecewiseWaveform(std::vector<DriveSegment> segments)
+    : m_segments(std::move(segments)) {
+    if (m_segments.empty())
+        throw std::invalid_argument("Waveform needs at least one segment");
+    double total = 0.0;
+    for (const DriveSegment& segment : m_segments) {
+        if (!(segment.fraction > 0.0) || !std::isfinite(segment.fraction) ||
+            !std::isfinite(segment.level))
+            throw std::invalid_argument("Waveform segments need finite levels and fractions > 0");
+        total += segment.fraction;
+    }
+    for (DriveSegment& segment : m_segments) segment.fraction /= total;
+}
+
+/**
+ * @throws std::invalid_argument unless 0 < duty_cycle < 1.
+ */
+auto PiecewiseWaveform::rectangular(double duty_cycle) -> PiecewiseWaveform {
+    if (!(duty_cycle > 0.0 && duty_cycle < 1.0))
+        throw std::invalid_argument("Duty cycle must lie strictly between 0 and 1");
+    return PiecewiseWaveform({{duty_cycle, 1.0}, {1.0 - duty_cycle, -1.0}});
+}
+
+auto TransferMatrix::then(const TransferMatrix& later) const -> TransferMatrix {
+    return {later.m11 * m11 + later.m12 * m21, later.m11 * m12 + later.m12 * m22,
+            later.m21 * m11 + later.m22 * m21, later.m21 * m12 + later.m22 * m22};
+}
+
+namespace {
+
+/**
+ * @brief Transfer matrix of u'' + k u = 0 over a stretch of length tau: a rotation for k > 0,
+ *        a hyperbolic boost for k < 0 and a drift for k = 0.
+ */
+auto segment_matrix(double k, double tau) -> TransferMatrix {
+    if (k > 0.0) {
+        const double w = std::sqrt(k);
+        const double c = std::cos(w * tau);
+        const double s = std::sin(w * tau);
+        return {c, s / w, -w * s, c};
+    }
+    if (k < 0.0) {
+        const double w = std::sqrt(-k);
+        const double c = std::cosh(w * tau);
+        const double s = std::sinh(w * tau);
+        return {c, s / w, w * s, c};
+    }
+    return {1.0, tau, 0.0, 1.0};
+}
+
+}  // namespace
+
+/**
+ * @brief beta from cos(pi beta) = trace / 2, shared by every monodromy-based solver.
+ */
+auto beta_from_trace(double trace) -> double {
+    if (!(std::abs(trace) <= 2.0))
+        return std::numeric_limits<double>::quiet_NaN();
+    return std::acos(0.5 * trace) / M_PI;
+}
+
+/**
+ * @brief Product of the segment matrices over one period (pi in xi), in drive order.
+ */
+auto digital_monodromy(const PiecewiseWaveform& waveform, double q, double a) -> TransferMatrix {
+    TransferMatrix monodromy;
+    for (const DriveSegment& segment : waveform.segments())
+        monodromy = monodromy.then(
+            segment_matrix(a - 2.0 * q * segment.level, segment.fraction * M_PI));
+    return monodromy;
+}
+
+/**
+ * @brief beta of the Floquet solutions, from cos(pi beta) = trace / 2.
+ *
+ * The trace fixes beta only up to its band, so the result is folded into [0, 1]; in the first
+ * stability region that is beta itself.
+ */
+auto digital_beta(const PiecewiseWaveform& waveform, double q, double a) -> double {
+    return beta_from_trace(digital_monodromy(waveform, q, a).trace());
+}
+
+/**
+ * @brief Stability of both directions; boundaries (|trace| = 2) count as stable, as for the
+ *        sinusoidal classifier.
+ */
+template <typename Geometry>
+auto classify_digital_stability(const PiecewiseWaveform& waveform, double q, double a)
+    -> StabilityClass {
+    constexpr double k = Geometry::SECONDARY_RATIO;
+    const bool x = std::abs(digital_monodromy(waveform, q, a).trace()) <= 2.0;
+    const bool y = std::abs(digital_monodromy(waveform, k * q, k * a).trace()) <= 2.0;
+    return make_stability_class(x, y);
+}
+template auto classify_digital_stability<LinearQuadrupole>(const PiecewiseWaveform&, double,
+                                                           double) -> StabilityClass;
+template auto classify_digital_stability<PaulTrap3D>(const PiecewiseWaveform&, double, double)
+    -> StabilityClass;
+
+/**
+ * @brief Evaluates both directions in every grid cell, band by band on the thread pool.
+ *
+ * Cells are independent, so bands are handed out one per task and finished bands are passed
+ * to options.on_rows straight away, as in rasterize_stability().
+ *
+ * @throws std::invalid_argument if the grid is empty or a range is reversed.
+ */
+template <typename Geometry>
+auto rasterize_digital_stability(const PiecewiseWaveform& waveform, const StabilityMapSpec& spec,
+                                 const DigitalStabilityMapOptions& options)
+    -> DigitalStabilityMap {
+    if (spec.q_cells == 0 || spec.a_cells == 0)
+        throw std::invalid_argument("Stability map needs at least one cell per axis");
+    if (spec.q_max < spec.q_min || spec.a_max < spec.a_min)
+        throw std::invalid_argument("Stability map range is reversed");
+
+    constexpr double k = Geometry::SECONDARY_RATIO;
+    DigitalStabilityMap map;
+    map.spec = spec;
+    map.classes.assign(spec.cell_count(), StabilityClass::None);
+    map.beta_x.assign(spec.cell_count(), std::numeric_limits<double>::quiet_NaN());
+    map.beta_y.assign(spec.cell_count(), std::numeric_limits<double>::quiet_NaN());
+    const std::size_t band_rows = std::max<std::size_t>(options.band_rows, 1);
+    const std::size_t bands = (spec.a_cells + band_rows - 1) / band_rows;
+
+    ProgressReporter reporter(options.progress, spec.a_cells);
+    ThreadPool& pool = options.pool ? *options.pool : ThreadPool::global();
+    ParallelForOptions loop;
+    loop.grain = 1;
+    loop.cancel = options.cancel;
+    pool.parallel_for(0, bands, [&](std::size_t first, std::size_t last) {
+        for (std::size_t band = first; band < last; ++band) {
+            const std::size_t row_begin = band * band_rows;
+            const std::size_t rows = std::min(band_rows, spec.a_cells - row_begin);
+            const std::size_t offset = row_begin * spec.q_cells;
+            for (std::size_t row = 0; row < rows; ++row) {
+                const double a = spec.cell_a(row_begin + row);
+                for (std::size_t column = 0; column < spec.q_cells; ++column) {
+                    const double q = spec.cell_q(column);
+                    const std::size_t cell = offset + row * spec.q_cells + column;
+                    const double beta_x = digital_beta(waveform, q, a);
+                    const double beta_y = digital_beta(waveform, k * q, k * a);
+                    map.beta_x[cell] = beta_x;
+                    map.beta_y[cell] = beta_y;
+                    map.classes[cell] =
+                        make_stability_class(!std::isnan(beta_x), !std::isnan(beta_y));
+                }
+            }
+            const StabilityClass* out = map.classes.data() + offset;
+            if (options.on_rows)
+                reporter.advance(rows, [&]() { options.on_rows(row_begin, rows, out); });
+            else
+                reporter.advance(rows);
+        }
+    }, loop);
+    map.complete = reporter.done() == spec.a_cells;
+    return map;
+}
+template auto rasterize_digital_stability<LinearQuadrupole>(const PiecewiseWaveform&,
+                                                            const StabilityMapSpec&,
+                                                            const DigitalStabilityMapOptions&)
+    -> DigitalStabilityMap;
+template auto rasterize_digital_stability<PaulTrap3D>(const PiecewiseWaveform&,
+                                                      const StabilityMapSpec&,
+                                                      const DigitalStabilityMapOptions&)
+    -> DigitalStabilityMap;
+
+}  // namespace mathieu_lib
+
+// NOLINTEND(readability-magic-numbers)
@@ -0,0 +1,249 @@
+// NOLINTBEGIN(readability-magic-numbers)
+
+/**
+ * @file hill_equation.cpp
+ * @brief Hill's equation for Fourier-series drives: Magnus monodromy and infinite-determinant
+ *        band edges.
+ */
+#include "mathieu_lib/hill_equation.h"
+
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <stdexcept>
+
+#include "Constants.h"
+
+namespace mathieu_lib {
+
+auto FourierWaveform::value(double xi) const -> double {
+    double w = mean;
+    for (std::size_t n = 1; n <= cosines.size(); ++n) w += cosines[n - 1] * std::cos(2.0 * n * xi);
+    for (std::size_t n = 1; n <= sines.size(); ++n) w += sines[n - 1] * std::sin(2.0 * n * xi);
+    return w;
+}
+
+namespace {
+
+// Offsets of the two-point Gauss-Legendre nodes within a step, in units of the step
+const double GAUSS_LOW = 0.5 - std::sqrt(3.0) / 6.0;
+const double GAUSS_HIGH = 0.5 + std::sqrt(3.0) / 6.0;
+
+/**
+ * @brief Hill's matrix for Floquet exponent nu (0: period pi, 1: period 2 pi), truncated to
+ *        the harmonics m = nu + 2j for |m| <= 2 half_width + nu.
+ *
+ * Substituting u = sum_m c_m e^{i m xi} gives a c_m = m^2 c_m + 2q sum_d W_d c_{m - 2d}, with
+ * W_d the complex Fourier coefficients of w, so the a admitting such a solution are the
+ * eigenvalues of a Hermitian band matrix of half-bandwidth `harmonics`.
+ */
+class HillMatrix {
+   public:
+    HillMatrix(const FourierWaveform& waveform, double q, int nu, int half_width)
+        : m_size(2 * half_width + 1 + nu),
+          m_band(static_cast<int>(waveform.harmonics())),
+          m_diagonal(m_size),
+          m_coupling(m_band + 1) {
+        for (int j = 0; j < m_size; ++j) {
+            const double m = 2.0 * (j - half_width) - nu;
+            m_diagonal[j] = m * m + 2.0 * q * waveform.mean;
+        }
+        for (int d = 1; d <= m_band; ++d) {
+            const auto n = static_cast<std::size_t>(d);
+            const double c = n <= waveform.cosines.size() ? waveform.cosines[n - 1] : 0.0;
+            const double s = n <= waveform.sines.size() ? waveform.sines[n - 1] : 0.0;
+            m_coupling[d] = 2.0 * q * std::complex<double>(0.5 * c, -0.5 * s);
+        }
+    }
+
+    /**
+     * @brief Number of eigenvalues below x: the negative pivots of the LDL^H factorization of
+     *        the band matrix minus x (Sylvester's law of inertia; the Sturm count in the
+     *        tridiagonal case).
+     */
+    auto count_below(double x) const -> int {
+        const int width = m_band + 1;
+        std::vector<std::complex<double>> lower(static_cast<std::size_t>(m_size) * width);
+        std::vector<double> pivots(m_size);
+        auto l = [&](int row, int column) -> std::complex<double>& {
+            return lower[static_cast<std::size_t>(row) * width + (row - column)];
+        };
+        int count = 0;
+        for (int j = 0; j < m_size; ++j) {
+            const int first = std::max(0, j - m_band);
+            for (int i = first; i < j; ++i) {
+                std::complex<double> value = m_coupling[j - i];
+                for (int k = std::max(first, i - m_band); k < i; ++k)
+                    value -= l(j, k) * std::conj(l(i, k)) * pivots[k];
+                l(j, i) = value / pivots[i];
+            }
+            double pivot = m_diagonal[j] - x;
+            for (int k = first; k < j; ++k) pivot -= std::norm(l(j, k)) * pivots[k];
+            if (pivot == 0.0)
+                pivot = std::numeric_limits<double>::epsilon() * (std::abs(x) + 1.0);
+            pivots[j] = pivot;
+            if (pivot < 0.0)
+                ++count;
+        }
+        return count;
+    }
+
+    /**
+     * @brief k-th smallest eigenvalue (k >= 0) by bisection on count_below(), inside the
+     *        Weyl bracket of the k-th smallest diagonal entry.
+     */
+    auto eigenvalue(int k) const -> double {
+        std::vector<double> sorted = m_diagonal;
+        std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+        double radius = 0.0;
+        for (int d = 1; d <= m_band; ++d) radius += 2.0 * std::abs(m_coupling[d]);
+        double lo = sorted[k] - radius;
+        double hi = sorted[k] + radius;
+        for (int iteration = 0; iteration < 200; ++iteration) {
+            const double mid = 0.5 * (lo + hi);
+            if (mid <= lo || mid >= hi)
+                break;
+            if (count_below(mid) > k)
+                hi = mid;
+            else
+                lo = mid;
+        }
+        return 0.5 * (lo + hi);
+    }
+
+   private:
+    int m_size;
+    int m_band;
+    std::vector<double> m_diagonal;
+    std::vector<std::complex<double>> m_coupling;  // entry (j, j - d) for d = 1..m_band
+};
+
+}  // namespace
+
+/**
+ * @throws std::invalid_argument if steps_per_period is zero or a coefficient is not finite.
+ */
+HillEquation::HillEquation(FourierWaveform waveform, std::size_t steps_per_period)
+    : m_waveform(std::move(waveform)), m_step(0.0) {
+    if (steps_per_period == 0)
+        throw std::invalid_argument("Hill equation needs at least one step per period");
+    bool finite = std::isfinite(m_waveform.mean);
+    for (double c : m_waveform.cosines) finite = finite && std::isfinite(c);
+    for (double s : m_waveform.sines) finite = finite && std::isfinite(s);
+    if (!finite)
+        throw std::invalid_argument("Waveform coefficients must be finite");
+    m_step = M_PI / steps_per_period;
+    m_samples.reserve(2 * steps_per_period);
+    for (std::size_t i = 0; i < steps_per_period; ++i) {
+        m_samples.push_back(m_waveform.value((i + GAUSS_LOW) * m_step));
+        m_samples.push_back(m_waveform.value((i + GAUSS_HIGH) * m_step));
+    }
+}
+
+/**
+ * @brief Fourth-order Magnus step: exp(h/2 (A1 + A2) + sqrt(3)/12 h^2 [A2, A1]) with
+ *        A = [[0, 1], [-k, 0]] at the two Gauss nodes. The exponent is traceless, so its
+ *        exponential is a closed-form rotation or boost of determinant one.
+ */
+auto HillEquation::step(double q, double a, std::size_t index) const -> TransferMatrix {
+    const double h = m_step;
+    const double k1 = a - 2.0 * q * m_samples[2 * index];
+    const double k2 = a - 2.0 * q * m_samples[2 * index + 1];
+    const double e = std::sqrt(3.0) / 12.0 * h * h * (k2 - k1);
+    const double o12 = h;
+    const double o21 = -0.5 * h * (k1 + k2);
+    const double delta = e * e + o12 * o21;  // Omega^2 = delta I
+    double c = 1.0;
+    double s = 1.0;  // sinh(sqrt(delta)) / sqrt(delta) or its circular counterpart
+    if (delta > 0.0) {
+        const double root = std::sqrt(delta);
+        c = std::cosh(root);
+        s = std::sinh(root) / root;
+    } else if (delta < 0.0) {
+        const double root = std::sqrt(-delta);
+        c = std::cos(root);
+        s = std::sin(root) / root;
+    }
+    return {c + s * e, s * o12, s * o21, c - s * e};
+}
+
+auto HillEquation::monodromy(double q, double a) const -> TransferMatrix {
+    TransferMatrix monodromy;
+    for (std::size_t i = 0; i < steps_per_period(); ++i) monodromy = monodromy.then(step(q, a, i));
+    return monodromy;
+}
+
+auto HillEquation::step_matrices(double q, double a) const -> std::vector<TransferMatrix> {
+    std::vector<TransferMatrix> steps;
+    steps.reserve(steps_per_period());
+    for (std::size_t i = 0; i < steps_per_period(); ++i) steps.push_back(step(q, a, i));
+    return steps;
+}
+
+/**
+ * @brief beta of the Floquet solutions, from cos(pi beta) = trace / 2, folded into [0, 1].
+ */
+auto HillEquation::beta(double q, double a) const -> double {
+    return beta_from_trace(monodromy(q, a).trace());
+}
+
+template <typename Geometry>
+auto HillEquation::classify(double q, double a) const -> StabilityClass {
+    constexpr double k = Geometry::SECONDARY_RATIO;
+    const bool x = std::abs(monodromy(q, a).trace()) <= 2.0;
+    const bool y = std::abs(monodromy(k * q, k * a).trace()) <= 2.0;
+    return make_stability_class(x, y);
+}
+template auto HillEquation::classify<LinearQuadrupole>(double, double) const -> StabilityClass;
+template auto HillEquation::classify<PaulTrap3D>(double, double) const -> StabilityClass;
+
+/**
+ * @brief Band r runs from the r-th periodic eigenvalue of one parity to the r-th of the other:
+ *        period pi (nu = 0) starts the even bands and period 2 pi (nu = 1) the odd ones.
+ *
+ * The truncation keeps a dozen or more harmonics beyond both the requested order and the
+ * sqrt(q) spread of the Fourier coefficients, as for the Mathieu characteristic values.
+ *
+ * @throws std::invalid_argument if order < 0.
+ */
+auto HillEquation::band_edges(int order, double q) const -> std::pair<double, double> {
+    if (order < 0)
+        throw std::invalid_argument("Stability band order must be >= 0");
+    double amplitude = std::abs(m_waveform.mean);
+    for (double c : m_waveform.cosines) amplitude += std::abs(c);
+    for (double s : m_waveform.sines) amplitude += std::abs(s);
+    const int half_width = order + 16 + static_cast<int>(m_waveform.harmonics()) +
+                           2 * static_cast<int>(std::ceil(std::sqrt(std::abs(q) * amplitude)));
+    const int parity = order % 2;
+    const HillMatrix starts(m_waveform, q, parity, half_width);
+    const HillMatrix ends(m_waveform, q, 1 - parity, half_width);
+    return {starts.eigenvalue(order), ends.eigenvalue(order)};
+}
+
+auto HillEquation::trajectory(double q, double a, double u0, double du0,
+                              std::size_t periods) const -> HillTrajectory {
+    HillTrajectory trajectory;
+    const std::size_t steps = periods * steps_per_period();
+    trajectory.xi.reserve(steps + 1);
+    trajectory.u.reserve(steps + 1);
+    trajectory.du.reserve(steps + 1);
+    trajectory.xi.push_back(0.0);
+    trajectory.u.push_back(u0);
+    trajectory.du.push_back(du0);
+    double u = u0;
+    double du = du0;
+    for (std::size_t i = 0; i < steps; ++i) {
+        const TransferMatrix m = step(q, a, i % steps_per_period());
+        const double next_u = m.m11 * u + m.m12 * du;
+        du = m.m21 * u + m.m22 * du;
+        u = next_u;
+        trajectory.xi.push_back((i + 1) * m_step);
+        trajectory.u.push_back(u);
+        trajectory.du.push_back(du);
+    }
+    return trajectory;
+}
+
+}  // namespace mathieu_lib
+
+// NOLINTEND(readability-magic-numbers)
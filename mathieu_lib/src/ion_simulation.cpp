@@ -0,0 +1,692 @@
+// NOLINTBEGIN(readability-magic-numbers)
+
+/**
+ * @file ion_simulation.cpp
+ * @brief Block-parallel ion trajectory integrator with buffer-gas collisions.
+ */
+#include "mathieu_lib/ion_simulation.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+
+#include "Constants.h"
+#include "mathieu_factors.h"
+#include "mathieu_lib/digital_drive.h"  // TransferMatrix
+#include "mathieu_lib/space_charge.h"
+
+namespace mathieu_lib {
+
+void IonEnsemble::resize(std::size_t count) {
+    mz.resize(count, 0.0);
+    for (auto* column : {&x, &dx, &y, &dy, &z, &dz}) column->resize(count, 0.0);
+    lost_at.resize(count, std::numeric_limits<double>::quiet_NaN());
+}
+
+namespace {
+
+// Ion mass in kg from m/z in Da
+auto ion_mass(double mz, int charge_state) -> double {
+    return mz * std::abs(charge_state) / (AVOGADRO_NUMBER * 1000);
+}
+
+auto gas_mass(const BufferGas& gas) -> double { return gas.mass / (AVOGADRO_NUMBER * 1000); }
+
+auto number_density(const BufferGas& gas) -> double {
+    return gas.pressure / (BOLTZMANN * gas.temperature);
+}
+
+// Seed of random stream `stream`: a SplitMix64 step over the pair, so neighbouring blocks get
+// unrelated generators
+auto stream_seed(std::uint64_t seed, std::uint64_t stream) -> std::uint64_t {
+    std::uint64_t z = seed + (stream + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief The ions of one work item still in flight, gathered out of the ensemble, with the
+ *        per-ion constants of the run.
+ *
+ * The columns are fixed-size members of one object, so the compiler can see they do not
+ * overlap and vectorizes the step loops without runtime alias checks. Lost ions stay in the
+ * block, parked where they hit the rod with q, a and their slopes zeroed.
+ */
+struct IonBlock {
+    std::size_t size = 0;
+    std::array<std::size_t, ION_BLOCK> index;    // position in the ensemble
+    std::array<std::size_t, ION_BLOCK> species;  // into the run's distinct m/z
+    std::array<double, ION_BLOCK> q, a, force, damping, mass;
+    std::array<double, ION_BLOCK> x, dx, y, dy, z, dz;
+    std::array<double, ION_BLOCK> free_path;  // optical depth left to the next candidate
+    std::array<double, ION_BLOCK> live;       // 1 in flight, 0 once lost
+    std::array<double, ION_BLOCK> lost_at;
+    // Space-charge acceleration per unit field, and the field at the current positions
+    std::array<double, ION_BLOCK> coupling, ex, ey;
+
+    void gather(const IonEnsemble& ions, std::size_t first, std::size_t last) {
+        size = 0;
+        for (std::size_t i = first; i < last; ++i) {
+            if (!std::isnan(ions.lost_at[i]))
+                continue;
+            index[size] = i;
+            x[size] = ions.x[i];
+            dx[size] = ions.dx[i];
+            y[size] = ions.y[i];
+            dy[size] = ions.dy[i];
+            z[size] = ions.z[i];
+            dz[size] = ions.dz[i];
+            live[size] = 1.0;
+            lost_at[size] = std::numeric_limits<double>::quiet_NaN();
+            ++size;
+        }
+    }
+
+    // One kick-drift-kick step of h between phases with cos 2xi = c0 and c1 and dipolar drive
+    // cos(omega t + phi) = e0 and e1, then the drag; true if an ion in flight reached a rod
+    auto advance(double h, double c0, double c1, double e0, double e1, double r0) -> bool {
+        double out = 0.0;  // a count, so the reduction vectorizes with the rest of the loop
+        for (std::size_t i = 0; i < size; ++i) {
+            const double k0 = a[i] - 2.0 * q[i] * c0;
+            double vx = dx[i] + 0.5 * h * (force[i] * e0 - k0 * x[i]);
+            double vy = dy[i] + 0.5 * h * k0 * y[i];
+            const double px = x[i] + h * vx;
+            const double py = y[i] + h * vy;
+            const double k1 = a[i] - 2.0 * q[i] * c1;
+            vx += 0.5 * h * (force[i] * e1 - k1 * px);
+            vy += 0.5 * h * k1 * py;
+            x[i] = px;
+            y[i] = py;
+            z[i] += h * dz[i];
+            dx[i] = vx * damping[i];
+            dy[i] = vy * damping[i];
+            dz[i] *= damping[i];
+            out += live[i] * ((std::abs(px) >= r0 ? 1.0 : 0.0) + (std::abs(py) >= r0 ? 1.0 : 0.0));
+        }
+        return out > 0.0;
+    }
+
+    // As advance(), with the space-charge field of `grid` in both kicks. ex and ey hold the
+    // field at the positions on entry and are refreshed after the drift, so each step costs
+    // one interpolation.
+    auto advance_in_field(double h, double c0, double c1, double e0, double e1, double r0,
+                          const SpaceChargeGrid& grid) -> bool {
+        for (std::size_t i = 0; i < size; ++i) {
+            const double k0 = a[i] - 2.0 * q[i] * c0;
+            dx[i] += 0.5 * h * (force[i] * e0 + coupling[i] * ex[i] - k0 * x[i]);
+            dy[i] += 0.5 * h * (coupling[i] * ey[i] + k0 * y[i]);
+            x[i] += h * dx[i];
+            y[i] += h * dy[i];
+            z[i] += h * dz[i];
+        }
+        grid.field(x.data(), y.data(), size, ex.data(), ey.data());
+        double out = 0.0;
+        for (std::size_t i = 0; i < size; ++i) {
+            const double k1 = a[i] - 2.0 * q[i] * c1;
+            dx[i] = (dx[i] + 0.5 * h * (force[i] * e1 + coupling[i] * ex[i] - k1 * x[i])) *
+                    damping[i];
+            dy[i] = (dy[i] + 0.5 * h * (coupling[i] * ey[i] + k1 * y[i])) * damping[i];
+            dz[i] *= damping[i];
+            out += live[i] * ((std::abs(x[i]) >= r0 ? 1.0 : 0.0) +
+                              (std::abs(y[i]) >= r0 ? 1.0 : 0.0));
+        }
+        return out > 0.0;
+    }
+
+    // Marks ions in flight at or beyond a rod as lost at `xi` and parks them there
+    void record_losses(double xi, double r0) {
+        for (std::size_t i = 0; i < size; ++i) {
+            if (live[i] == 0.0 || (std::abs(x[i]) < r0 && std::abs(y[i]) < r0))
+                continue;
+            lost_at[i] = xi;
+            live[i] = 0.0;
+            q[i] = a[i] = force[i] = coupling[i] = 0.0;
+            dx[i] = dy[i] = dz[i] = 0.0;
+        }
+    }
+
+    void write_back(IonEnsemble& ions) const {
+        for (std::size_t i = 0; i < size; ++i) {
+            const std::size_t j = index[i];
+            ions.x[j] = x[i];
+            ions.dx[j] = dx[i];
+            ions.y[j] = y[i];
+            ions.dy[j] = dy[i];
+            ions.z[j] = z[i];
+            ions.dz[j] = dz[i];
+            ions.lost_at[j] = lost_at[i];
+        }
+    }
+};
+
+/**
+ * @brief Elastic hard-sphere collisions with a Maxwellian gas, by null collisions: candidates
+ *        arrive at n sigma (|v| + W), and a candidate partner w is accepted with probability
+ *        |v - w| / (|v| + W), which makes the accepted rate n sigma |v - w| as for hard
+ *        spheres. W is 5 sqrt(k T / M); the gas speed exceeds it with probability 2e-5.
+ *        Accepted collisions scatter isotropically in the centre of mass.
+ */
+class GasCollider {
+   public:
+    GasCollider(const BufferGas& gas, double slope_to_velocity, std::uint64_t seed,
+                std::uint64_t stream)
+        : m_gas_mass(gas_mass(gas)),
+          m_thermal(std::sqrt(BOLTZMANN * gas.temperature / m_gas_mass)),
+          m_margin(5.0 * m_thermal),
+          m_density_sigma(number_density(gas) * gas.cross_section),
+          m_scale(slope_to_velocity),
+          m_random(stream_seed(seed, stream)) {}
+
+    auto free_path() -> double { return m_exponential(m_random); }
+
+    // Spends the optical depth of `seconds` at each ion's candidate rate; true if some ion is
+    // due a candidate collision
+    auto spend_free_path(IonBlock& block, double seconds) const -> bool {
+        const double base = m_density_sigma * m_margin * seconds;
+        const double per_slope = m_density_sigma * m_scale * seconds;
+        double due = 0.0;
+        for (std::size_t i = 0; i < block.size; ++i) {
+            const double slope = std::sqrt(block.dx[i] * block.dx[i] + block.dy[i] * block.dy[i] +
+                                           block.dz[i] * block.dz[i]);
+            block.free_path[i] -= base + per_slope * slope;
+            due += block.free_path[i] <= 0.0 ? 1.0 : 0.0;
+        }
+        return due > 0.0;
+    }
+
+    void collide_due(IonBlock& block) {
+        for (std::size_t i = 0; i < block.size; ++i) {
+            while (block.free_path[i] <= 0.0) {
+                if (block.live[i] != 0.0)
+                    collide(block, i);
+                block.free_path[i] += free_path();
+            }
+        }
+    }
+
+   private:
+    void collide(IonBlock& block, std::size_t i) {
+        const double m = block.mass[i];
+        const double v[3] = {block.dx[i] * m_scale, block.dy[i] * m_scale, block.dz[i] * m_scale};
+        const double w[3] = {m_thermal * m_normal(m_random), m_thermal * m_normal(m_random),
+                             m_thermal * m_normal(m_random)};
+        const double speed = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        const double g = std::sqrt((v[0] - w[0]) * (v[0] - w[0]) + (v[1] - w[1]) * (v[1] - w[1]) +
+                                   (v[2] - w[2]) * (v[2] - w[2]));
+        if (m_uniform(m_random) * (speed + m_margin) >= g)
+            return;
+        const double cos_theta = 2.0 * m_uniform(m_random) - 1.0;
+        const double sin_theta = std::sqrt(std::max(1.0 - cos_theta * cos_theta, 0.0));
+        const double phi = 2.0 * M_PI * m_uniform(m_random);
+        const double direction[3] = {sin_theta * std::cos(phi), sin_theta * std::sin(phi),
+                                     cos_theta};
+        // v' = v_cm + M / (m + M) g n
+        const double total = m + m_gas_mass;
+        double after[3];
+        for (int k = 0; k < 3; ++k)
+            after[k] = (m * v[k] + m_gas_mass * (w[k] + g * direction[k])) / total;
+        block.dx[i] = after[0] / m_scale;
+        block.dy[i] = after[1] / m_scale;
+        block.dz[i] = after[2] / m_scale;
+    }
+
+    double m_gas_mass;
+    double m_thermal;  // sqrt(k T / M), the spread of each gas velocity component
+    double m_margin;
+    double m_density_sigma;
+    double m_scale;  // velocity per unit slope, Omega / 2
+    std::mt19937_64 m_random;
+    std::normal_distribution<double> m_normal;
+    std::uniform_real_distribution<double> m_uniform;
+    std::exponential_distribution<double> m_exponential;
+};
+
+}  // namespace
+
+auto collision_rate(double mz, int charge_state, const BufferGas& gas) -> double {
+    const double m = ion_mass(mz, charge_state);
+    const double big_m = gas_mass(gas);
+    const double reduced = m * big_m / (m + big_m);
+    return number_density(gas) * gas.cross_section *
+           std::sqrt(8.0 * BOLTZMANN * gas.temperature / (M_PI * reduced));
+}
+
+auto drag_rate(double mz, int charge_state, const BufferGas& gas) -> double {
+    const double m = ion_mass(mz, charge_state);
+    const double big_m = gas_mass(gas);
+    return collision_rate(mz, charge_state, gas) * big_m / (m + big_m);
+}
+
+namespace {
+
+// Entrance fringe cycles after which the field is within 0.1% of its full value
+constexpr double FRINGE_LENGTHS = 7.0;
+
+// One entrance fringe cycle of one species: the transverse transfer matrices, and the axial
+// drift z += z_per_dz dz and slope scale under the viscous drag
+struct FringeCycle {
+    TransferMatrix x, y;
+    double z_per_dz = 0.0;
+    double dz_scale = 1.0;
+};
+
+/**
+ * @brief The constants of one run, shared by every block: the RF phase table, the conversions
+ *        from m/z to q, a and dipolar force, the step length and, with an entrance fringe, the
+ *        fringe cycles of each species.
+ */
+class Integrator {
+   public:
+    Integrator(const IonSimulationSpec& spec, const std::vector<double>& species_mz)
+        : m_spec(spec),
+          m_omega(2.0 * M_PI * spec.frequency),
+          m_h(M_PI / static_cast<double>(spec.steps_per_period)),
+          m_step_seconds(2.0 * m_h / m_omega),
+          m_cos_2xi(spec.steps_per_period + 1) {
+        const double r0 = spec.quad_radius;
+        const QuadrupoleParams params(spec.frequency, r0, 0.0);
+        // m/z is unsigned, so the sign of z goes onto q, a and the force: an anion sees the
+        // cation's x and y equations swapped and is pushed the other way by the excitation
+        const double sign = spec.charge_state < 0 ? -1.0 : 1.0;
+        const double per_mz = field_factor_times_mz<LinearQuadrupole>(params);
+        m_q_times_mz = sign * q_times_mz<LinearQuadrupole>(spec.voltage_rf, params);
+        m_a_times_mz = sign * a_times_mz<LinearQuadrupole>(spec.voltage_dc, params);
+        // 4 z e E / (m Omega^2) with the on-axis field E = V_ac / (2 r0)
+        m_force_times_mz = sign * 2.0 * spec.excitation.amplitude * r0 * per_mz;
+        m_ac_per_xi = 2.0 * spec.excitation.frequency / spec.frequency;
+        // 4 z e / (m Omega^2); the field is that of |z| e charges, so the force is z^2 e^2 > 0
+        if (spec.space_charge.ions_per_particle > 0.0)
+            m_coupling_times_mz = 4.0 * E_CHARGE * AVOGADRO_NUMBER * 1000 / (m_omega * m_omega);
+        for (std::size_t j = 0; j <= spec.steps_per_period; ++j)
+            m_cos_2xi[j] = std::cos(2.0 * (spec.start_phase + j * m_h));
+
+        const double longest = std::max(spec.fringe.rf_length, spec.fringe.dc_length);
+        if (longest > 0.0) {
+            m_fringe_cycles = static_cast<std::size_t>(
+                std::min(static_cast<double>(spec.periods), std::ceil(FRINGE_LENGTHS * longest)));
+        }
+        m_fringe.reserve(species_mz.size() * m_fringe_cycles);
+        for (double mz : species_mz) {
+            for (std::size_t n = 0; n < m_fringe_cycles; ++n)
+                m_fringe.push_back(fringe_cycle(mz, n));
+        }
+    }
+
+    auto omega() const -> double { return m_omega; }
+
+    // Gathers the ions in flight of [first, last) and sets their per-ion constants; `species`
+    // maps each ion of the ensemble to its entry in the run's distinct m/z
+    void load(IonBlock& block, const IonEnsemble& ions, const std::vector<std::size_t>& species,
+              std::size_t first, std::size_t last) const {
+        block.gather(ions, first, last);
+        for (std::size_t i = 0; i < block.size; ++i) {
+            const double mz = ions.mz[block.index[i]];
+            block.species[i] = species[block.index[i]];
+            block.q[i] = m_q_times_mz / mz;
+            block.a[i] = m_a_times_mz / mz;
+            block.force[i] = m_force_times_mz / mz;
+            block.coupling[i] = m_coupling_times_mz / mz;
+            block.mass[i] = ion_mass(mz, m_spec.charge_state);
+            block.damping[i] = damping(mz);
+        }
+    }
+
+    // Advances a loaded block through RF periods [begin, end) of the run, in the space-charge
+    // field of `grid` if given; collisions draw from stream `stream` of `seed`
+    void run(IonBlock& block, std::uint64_t seed, std::uint64_t stream, std::size_t begin,
+             std::size_t end, const SpaceChargeGrid* grid = nullptr) const {
+        const std::size_t steps = m_spec.steps_per_period;
+        const double r0 = m_spec.quad_radius;
+        const bool stochastic = m_spec.collisions == CollisionModel::HardSphere;
+        const bool excited = m_spec.excitation.amplitude != 0.0;
+        GasCollider collider(m_spec.gas, 0.5 * m_omega, seed, stream);
+        if (stochastic) {
+            for (std::size_t i = 0; i < block.size; ++i) block.free_path[i] = collider.free_path();
+        }
+        enter(block, begin, end);
+        begin = std::max(begin, m_fringe_cycles);
+        if (grid != nullptr)
+            grid->field(block.x.data(), block.y.data(), block.size, block.ex.data(),
+                        block.ey.data());
+
+        double e0 = excited ? drive(m_spec.start_phase + begin * steps * m_h) : 0.0;
+        for (std::size_t period = begin; period < end; ++period) {
+            for (std::size_t j = 0; j < steps; ++j) {
+                const double xi = m_spec.start_phase + (period * steps + j + 1) * m_h;
+                const double e1 = excited ? drive(xi) : 0.0;
+                const bool out =
+                    grid != nullptr
+                        ? block.advance_in_field(m_h, m_cos_2xi[j], m_cos_2xi[j + 1], e0, e1, r0,
+                                                 *grid)
+                        : block.advance(m_h, m_cos_2xi[j], m_cos_2xi[j + 1], e0, e1, r0);
+                if (out)
+                    block.record_losses(xi, r0);
+                if (stochastic && collider.spend_free_path(block, m_step_seconds))
+                    collider.collide_due(block);
+                e0 = e1;
+            }
+        }
+    }
+
+   private:
+    auto damping(double mz) const -> double {
+        if (m_spec.collisions != CollisionModel::Viscous)
+            return 1.0;
+        return std::exp(-drag_rate(mz, m_spec.charge_state, m_spec.gas) * m_step_seconds);
+    }
+
+    // Field amplitude 1 - exp(-t / length) at t RF cycles after launch
+    static auto ramp(double t, double length) -> double {
+        return length > 0.0 ? 1.0 - std::exp(-t / length) : 1.0;
+    }
+
+    // Entrance fringe cycle n of an ion of m/z `mz`, by the same leapfrog steps as advance()
+    // with q and a scaled by the ramps at each kick; collisions and the excitation are left out
+    auto fringe_cycle(double mz, std::size_t n) const -> FringeCycle {
+        const std::size_t steps = m_spec.steps_per_period;
+        const double q = m_q_times_mz / mz;
+        const double a = m_a_times_mz / mz;
+        const double d = damping(mz);
+        const auto k = [&](std::size_t j) {
+            const double t = n + static_cast<double>(j) / steps;
+            return ramp(t, m_spec.fringe.dc_length) * a -
+                   2.0 * ramp(t, m_spec.fringe.rf_length) * q * m_cos_2xi[j];
+        };
+        // Columns of the matrices are the images of (1, 0) and (0, 1)
+        std::array<double, 4> u = {1.0, 0.0, 1.0, 0.0};  // x then y
+        std::array<double, 4> v = {0.0, 1.0, 0.0, 1.0};
+        FringeCycle cycle;
+        for (std::size_t j = 0; j < steps; ++j) {
+            const double k0 = k(j);
+            const double k1 = k(j + 1);
+            for (std::size_t c = 0; c < 4; ++c) {
+                const double sign = c < 2 ? 1.0 : -1.0;  // k_y = -k_x
+                const double half = v[c] - 0.5 * m_h * sign * k0 * u[c];
+                u[c] += m_h * half;
+                v[c] = (half - 0.5 * m_h * sign * k1 * u[c]) * d;
+            }
+            cycle.z_per_dz += m_h * cycle.dz_scale;
+            cycle.dz_scale *= d;
+        }
+        cycle.x = TransferMatrix{u[0], u[1], v[0], v[1]};
+        cycle.y = TransferMatrix{u[2], u[3], v[2], v[3]};
+        return cycle;
+    }
+
+    // Carries the ions in flight through the entrance fringe cycles in [begin, end), checking
+    // for losses at the end of each cycle
+    void enter(IonBlock& block, std::size_t begin, std::size_t end) const {
+        const double r0 = m_spec.quad_radius;
+        for (std::size_t n = begin; n < std::min(end, m_fringe_cycles); ++n) {
+            bool out = false;
+            for (std::size_t i = 0; i < block.size; ++i) {
+                if (block.live[i] == 0.0)
+                    continue;
+                const FringeCycle& c = m_fringe[block.species[i] * m_fringe_cycles + n];
+                const double x = block.x[i];
+                const double y = block.y[i];
+                block.x[i] = c.x.m11 * x + c.x.m12 * block.dx[i];
+                block.dx[i] = c.x.m21 * x + c.x.m22 * block.dx[i];
+                block.y[i] = c.y.m11 * y + c.y.m12 * block.dy[i];
+                block.dy[i] = c.y.m21 * y + c.y.m22 * block.dy[i];
+                block.z[i] += c.z_per_dz * block.dz[i];
+                block.dz[i] *= c.dz_scale;
+                out |= std::abs(block.x[i]) >= r0 || std::abs(block.y[i]) >= r0;
+            }
+            if (out)
+                block.record_losses(m_spec.start_phase + (n + 1) * M_PI, r0);
+        }
+    }
+
+    // cos(omega t + phi) of the dipolar drive at phase xi, with t = 2 xi / Omega
+    auto drive(double xi) const -> double {
+        return std::cos(m_ac_per_xi * xi + m_spec.excitation.phase);
+    }
+
+    IonSimulationSpec m_spec;
+    double m_omega;
+    double m_h;
+    double m_step_seconds;
+    std::vector<double> m_cos_2xi;  // one period of cos 2xi at the step boundaries
+    double m_q_times_mz = 0.0;
+    double m_a_times_mz = 0.0;
+    double m_force_times_mz = 0.0;
+    double m_ac_per_xi = 0.0;
+    double m_coupling_times_mz = 0.0;
+    std::size_t m_fringe_cycles = 0;
+    std::vector<FringeCycle> m_fringe;  // species-major
+};
+
+void validate(const IonSimulationSpec& spec, const IonEnsemble& ions) {
+    if (spec.steps_per_period == 0)
+        throw std::invalid_argument("Ion simulation needs at least one step per period");
+    if (!(spec.quad_radius > 0.0))
+        throw std::invalid_argument("Ion simulation needs a positive quadrupole radius");
+    if (spec.charge_state == 0)
+        throw std::invalid_argument("Ion simulation needs a nonzero charge state");
+    if (!(spec.fringe.rf_length >= 0.0) || !(spec.fringe.dc_length >= 0.0))
+        throw std::invalid_argument("Fringe ramp lengths must be nonnegative");
+    const SpaceChargeCoupling& coupling = spec.space_charge;
+    if (!(coupling.ions_per_particle >= 0.0))
+        throw std::invalid_argument("Space charge needs a nonnegative ion count per particle");
+    if (coupling.ions_per_particle > 0.0 &&
+        (!(coupling.cloud_length > 0.0) || coupling.grid_nodes < 2 ||
+         coupling.update_periods == 0))
+        throw std::invalid_argument(
+            "Space charge needs a positive cloud length, two grid nodes and an update period");
+    const std::size_t count = ions.size();
+    for (const auto* column :
+         {&ions.x, &ions.dx, &ions.y, &ions.dy, &ions.z, &ions.dz, &ions.lost_at}) {
+        if (column->size() != count)
+            throw std::invalid_argument("Ion ensemble columns must have the same length");
+    }
+}
+
+auto block_count(const IonEnsemble& ions) -> std::size_t {
+    return (ions.size() + ION_BLOCK - 1) / ION_BLOCK;
+}
+
+// Distinct m/z of the ions in flight, ascending, and each such ion's index into them
+struct Species {
+    std::vector<double> mz;
+    std::vector<std::size_t> of_ion;  // 0 for ions already lost
+};
+
+auto distinct_species(const IonEnsemble& ions) -> Species {
+    Species species;
+    const std::size_t count = ions.size();
+    for (std::size_t i = 0; i < count; ++i) {
+        if (std::isnan(ions.lost_at[i]))
+            species.mz.push_back(ions.mz[i]);
+    }
+    std::sort(species.mz.begin(), species.mz.end());
+    species.mz.erase(std::unique(species.mz.begin(), species.mz.end()), species.mz.end());
+    species.of_ion.assign(count, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (std::isnan(ions.lost_at[i])) {
+            species.of_ion[i] = static_cast<std::size_t>(
+                std::lower_bound(species.mz.begin(), species.mz.end(), ions.mz[i]) -
+                species.mz.begin());
+        }
+    }
+    return species;
+}
+
+}  // namespace
+
+/**
+ * @brief Kick-drift-kick leapfrog in xi over blocks of ION_BLOCK ions on the thread pool.
+ *
+ * Every step runs as one loop across the ions of a block, with cos 2xi taken from a
+ * one-period table, so the collision-free path vectorizes. The dipolar excitation adds a
+ * force on x only and costs one cosine per step per block. Viscous drag scales the slopes by
+ * exp(-2 gamma h / Omega) after each step. Hard-sphere collisions spend an exponentially
+ * distributed optical depth per ion and are handled one ion at a time when it runs out; each
+ * block draws from its own generator, seeded from options.seed and the block number, so
+ * results do not depend on the thread count or on scheduling.
+ *
+ * The entrance fringe cycles are precomputed once per distinct m/z as transfer matrices of the
+ * same leapfrog steps, so crossing the fringe costs each ion one pair of 2x2 products per cycle
+ * instead of a full period of steps. Losses in the fringe are checked at cycle ends.
+ *
+ * @throws std::invalid_argument if steps_per_period is zero, the radius is not positive, the
+ *         charge state is zero, a fringe length is negative or the columns differ in length.
+ */
+auto simulate_ions(const IonSimulationSpec& spec, IonEnsemble& ions,
+                   const IonSimulationOptions& options) -> IonSimulationSummary {
+    validate(spec, ions);
+    const Species species = distinct_species(ions);
+    const Integrator integrator(spec, species.mz);
+    const std::size_t count = ions.size();
+    const std::size_t blocks = block_count(ions);
+
+    // Without space charge the blocks are independent and the run is one epoch; with it, each
+    // epoch starts from a field solved over every ion in flight
+    const SpaceChargeCoupling& coupling = spec.space_charge;
+    const bool coupled = coupling.ions_per_particle > 0.0;
+    const std::size_t epoch_periods = coupled ? coupling.update_periods : spec.periods;
+    const std::size_t epochs =
+        std::max<std::size_t>(1, (spec.periods + epoch_periods - 1) / epoch_periods);
+    std::unique_ptr<SpaceChargeGrid> grid;
+    if (coupled)
+        grid = std::make_unique<SpaceChargeGrid>(spec.quad_radius, coupling.grid_nodes);
+    const double line_charge = coupling.ions_per_particle * std::abs(spec.charge_state) *
+                               E_CHARGE / coupling.cloud_length;
+
+    ProgressReporter reporter(options.progress, blocks * epochs);
+    ThreadPool& pool = options.pool ? *options.pool : ThreadPool::global();
+    ParallelForOptions loop;
+    loop.grain = 1;
+    loop.cancel = options.cancel;
+    for (std::size_t epoch = 0; epoch < epochs; ++epoch) {
+        const std::size_t begin = epoch * epoch_periods;
+        const std::size_t end = std::min(spec.periods, begin + epoch_periods);
+        if (coupled) {
+            grid->clear();
+            for (std::size_t i = 0; i < count; ++i) {
+                if (std::isnan(ions.lost_at[i]))
+                    grid->deposit(ions.x[i], ions.y[i], line_charge);
+            }
+            grid->solve();
+        }
+        pool.parallel_for(0, blocks, [&](std::size_t first_block, std::size_t last_block) {
+            auto block = std::make_unique<IonBlock>();
+            for (std::size_t b = first_block; b < last_block; ++b) {
+                integrator.load(*block, ions, species.of_ion, b * ION_BLOCK,
+                                std::min(count, (b + 1) * ION_BLOCK));
+                integrator.run(*block, options.seed, epoch * blocks + b, begin, end, grid.get());
+                block->write_back(ions);
+                reporter.advance(1);
+            }
+        }, loop);
+        if (reporter.done() != (epoch + 1) * blocks)
+            break;
+    }
+
+    IonSimulationSummary summary;
+    summary.cancelled = reporter.done() != blocks * epochs;
+    for (double lost : ions.lost_at) {
+        if (std::isnan(lost))
+            ++summary.transmitted;
+        else
+            ++summary.lost;
+    }
+    return summary;
+}
+
+auto EjectionMap::index(std::size_t amplitude, std::size_t frequency, std::size_t species) const
+    -> std::size_t {
+    return (amplitude * frequencies.size() + frequency) * mz.size() + species;
+}
+
+/**
+ * @brief Runs the ensemble once per (amplitude, frequency) point, on the pool as one work item
+ *        per point and ion block, and tallies the ejections of each m/z.
+ *
+ * Every point starts from the same ions and every block uses the same collision stream at
+ * each point, so neighbouring cells differ by the drive alone and the map stays smooth. Only
+ * the block being integrated is held per work item; the ensemble is not copied per point.
+ *
+ * @throws std::invalid_argument as simulate_ions().
+ */
+auto sweep_excitation(const IonSimulationSpec& spec, const IonEnsemble& ions,
+                      const std::vector<double>& frequencies,
+                      const std::vector<double>& amplitudes, const IonSimulationOptions& options)
+    -> EjectionMap {
+    validate(spec, ions);
+    if (spec.space_charge.ions_per_particle > 0.0)
+        throw std::invalid_argument("Excitation sweeps do not support space-charge coupling");
+    EjectionMap map;
+    map.frequencies = frequencies;
+    map.amplitudes = amplitudes;
+    const Species species = distinct_species(ions);
+    map.mz = species.mz;
+    const std::size_t count = ions.size();
+    std::vector<double> launched(map.mz.size(), 0.0);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (std::isnan(ions.lost_at[i]))
+            launched[species.of_ion[i]] += 1.0;
+    }
+
+    std::vector<Integrator> points;
+    points.reserve(amplitudes.size() * frequencies.size());
+    for (double amplitude : amplitudes) {
+        for (double frequency : frequencies) {
+            IonSimulationSpec point = spec;
+            point.excitation.amplitude = amplitude;
+            point.excitation.frequency = frequency;
+            points.emplace_back(point, species.mz);
+        }
+    }
+    const std::size_t cells = points.size() * map.mz.size();
+    std::vector<double> ejected(cells, 0.0);
+    std::vector<double> time_sum(cells, 0.0);
+
+    const std::size_t blocks = block_count(ions);
+    const std::size_t items = points.size() * blocks;
+    ProgressReporter reporter(options.progress, items);
+    ThreadPool& pool = options.pool ? *options.pool : ThreadPool::global();
+    ParallelForOptions loop;
+    loop.grain = 1;
+    loop.cancel = options.cancel;
+    pool.parallel_for(0, items, [&](std::size_t first, std::size_t last) {
+        auto block = std::make_unique<IonBlock>();
+        for (std::size_t item = first; item < last; ++item) {
+            const std::size_t p = item / blocks;
+            const std::size_t b = item % blocks;
+            const Integrator& integrator = points[p];
+            integrator.load(*block, ions, species.of_ion, b * ION_BLOCK,
+                            std::min(count, (b + 1) * ION_BLOCK));
+            integrator.run(*block, options.seed, b, 0, spec.periods);
+            const double seconds_per_xi = 2.0 / integrator.omega();
+            reporter.advance(1, [&]() {
+                for (std::size_t i = 0; i < block->size; ++i) {
+                    if (block->live[i] != 0.0)
+                        continue;
+                    const std::size_t cell = p * map.mz.size() + species.of_ion[block->index[i]];
+                    ejected[cell] += 1.0;
+                    time_sum[cell] += (block->lost_at[i] - spec.start_phase) * seconds_per_xi;
+                }
+            });
+        }
+    }, loop);
+
+    map.efficiency.resize(cells);
+    map.ejection_time.resize(cells);
+    for (std::size_t cell = 0; cell < cells; ++cell) {
+        map.efficiency[cell] = ejected[cell] / launched[cell % map.mz.size()];
+        map.ejection_time[cell] = ejected[cell] > 0.0 ? time_sum[cell] / ejected[cell]
+                                                      : std::numeric_limits<double>::quiet_NaN();
+    }
+    map.cancelled = reporter.done() != items;
+    return map;
+}
+
+}  // namespace mathieu_lib
+
+// NOLINTEND(readability-magic-numbers)
@@ -0,0 +1,305 @@
+// NOLINTBEGIN(readability-magic-numbers)
+
+/**
+ * @file isotope_envelope.cpp
+ * @brief Isotope patterns from elemental formulas by pruned polynomial convolution.
+ */
+#include "mathieu_lib/isotope_envelope.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+#include <utility>
+
+#include "mathieu_lib/stability.h"
+
+namespace mathieu_lib {
+
+namespace {
+
+struct Isotope {
+    const char* symbol;
+    double mass;  // Da
+    double abundance;
+};
+
+// Isotopic compositions (IUPAC representative abundances, AME masses) of the elements
+// common in analytes, buffers and salts; isotopes of one element are adjacent
+constexpr Isotope ISOTOPES[] = {
+    {"H", 1.00782503207, 0.999885},   {"H", 2.0141017778, 0.000115},
+    {"Li", 6.015122795, 0.0759},      {"Li", 7.01600455, 0.9241},
+    {"B", 10.0129370, 0.199},         {"B", 11.0093054, 0.801},
+    {"C", 12.0, 0.9893},              {"C", 13.0033548378, 0.0107},
+    {"N", 14.0030740048, 0.99636},    {"N", 15.0001088982, 0.00364},
+    {"O", 15.99491461956, 0.99757},   {"O", 16.99913170, 0.00038},
+    {"O", 17.9991610, 0.00205},       {"F", 18.99840322, 1.0},
+    {"Na", 22.9897692809, 1.0},       {"Mg", 23.985041700, 0.7899},
+    {"Mg", 24.98583692, 0.1000},      {"Mg", 25.982592929, 0.1101},
+    {"Si", 27.9769265325, 0.92223},   {"Si", 28.976494700, 0.04685},
+    {"Si", 29.97377017, 0.03092},     {"P", 30.97376163, 1.0},
+    {"S", 31.97207100, 0.9499},       {"S", 32.97145876, 0.0075},
+    {"S", 33.96786690, 0.0425},       {"S", 35.96708076, 0.0001},
+    {"Cl", 34.96885268, 0.7576},      {"Cl", 36.96590259, 0.2424},
+    {"K", 38.96370668, 0.932581},     {"K", 39.96399848, 0.000117},
+    {"K", 40.96182576, 0.067302},     {"Ca", 39.96259098, 0.96941},
+    {"Ca", 41.95861801, 0.00647},     {"Ca", 42.9587666, 0.00135},
+    {"Ca", 43.9554818, 0.02086},      {"Ca", 45.9536926, 0.00004},
+    {"Ca", 47.952534, 0.00187},       {"Fe", 53.9396105, 0.05845},
+    {"Fe", 55.9349375, 0.91754},      {"Fe", 56.9353940, 0.02119},
+    {"Fe", 57.9332756, 0.00282},      {"Cu", 62.9295975, 0.6915},
+    {"Cu", 64.9277895, 0.3085},       {"Zn", 63.9291422, 0.48268},
+    {"Zn", 65.9260334, 0.27975},      {"Zn", 66.9271273, 0.04102},
+    {"Zn", 67.9248442, 0.19024},      {"Zn", 69.9253193, 0.00631},
+    {"Se", 73.9224764, 0.0089},       {"Se", 75.9192136, 0.0937},
+    {"Se", 76.9199140, 0.0763},       {"Se", 77.9173091, 0.2377},
+    {"Se", 79.9165213, 0.4961},       {"Se", 81.9166994, 0.0873},
+    {"Br", 78.9183371, 0.5069},       {"Br", 80.9162906, 0.4931},
+    {"I", 126.904473, 1.0},
+};
+
+// Most atoms of one element a formula may hold, after groups multiply and repeats merge
+constexpr long long MAX_ATOMS = 1000000;
+
+// (mass, abundance) pairs
+using Peaks = std::vector<std::pair<double, double>>;
+
+auto element_peaks(const std::string& symbol) -> Peaks {
+    Peaks peaks;
+    for (const Isotope& isotope : ISOTOPES) {
+        if (symbol == isotope.symbol)
+            peaks.emplace_back(isotope.mass, isotope.abundance);
+    }
+    return peaks;
+}
+
+/**
+ * @brief Recursive-descent formula parser: group := (element | '(' group ')') count? ...
+ */
+class FormulaParser {
+   public:
+    explicit FormulaParser(const std::string& formula) : m_text(formula) {}
+
+    auto parse() -> std::vector<ElementCount> {
+        std::vector<ElementCount> counts;
+        group(counts);
+        skip_space();
+        if (m_pos != m_text.size())
+            fail("unexpected '" + std::string(1, m_text[m_pos]) + "'");
+        if (counts.empty())
+            fail("no elements");
+        return counts;
+    }
+
+   private:
+    void group(std::vector<ElementCount>& counts) {
+        for (;;) {
+            skip_space();
+            if (m_pos == m_text.size() || m_text[m_pos] == ')')
+                return;
+            if (m_text[m_pos] == '(') {
+                ++m_pos;
+                std::vector<ElementCount> inner;
+                group(inner);
+                if (m_pos == m_text.size() || m_text[m_pos] != ')')
+                    fail("unbalanced '('");
+                ++m_pos;
+                const long long n = count();
+                for (const ElementCount& e : inner) add(counts, e.symbol, e.count * n);
+                continue;
+            }
+            if (std::isupper(static_cast<unsigned char>(m_text[m_pos])) == 0)
+                fail("expected an element symbol at '" + std::string(1, m_text[m_pos]) + "'");
+            std::string symbol(1, m_text[m_pos++]);
+            while (m_pos < m_text.size() &&
+                   std::islower(static_cast<unsigned char>(m_text[m_pos])) != 0)
+                symbol += m_text[m_pos++];
+            if (element_peaks(symbol).empty())
+                fail("unknown element " + symbol);
+            add(counts, symbol, count());
+        }
+    }
+
+    // Bounded by MAX_ATOMS, so a product with an element count fits in 64 bits
+    auto count() -> long long {
+        skip_space();
+        if (m_pos == m_text.size() || std::isdigit(static_cast<unsigned char>(m_text[m_pos])) == 0)
+            return 1;
+        long long value = 0;
+        while (m_pos < m_text.size() &&
+               std::isdigit(static_cast<unsigned char>(m_text[m_pos])) != 0) {
+            value = value * 10 + (m_text[m_pos++] - '0');
+            if (value > MAX_ATOMS)
+                fail("count too large");
+        }
+        return value;
+    }
+
+    // Adds n atoms of `symbol`; the combined count of the element is checked against MAX_ATOMS
+    void add(std::vector<ElementCount>& counts, const std::string& symbol, long long n) const {
+        for (ElementCount& e : counts) {
+            if (e.symbol == symbol) {
+                if (e.count + n > MAX_ATOMS)
+                    fail("count too large");
+                e.count += static_cast<int>(n);
+                return;
+            }
+        }
+        if (n > MAX_ATOMS)
+            fail("count too large");
+        counts.push_back(ElementCount{symbol, static_cast<int>(n)});
+    }
+
+    void skip_space() {
+        while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos])))
+            ++m_pos;
+    }
+
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::invalid_argument("Bad formula \"" + m_text + "\": " + what);
+    }
+
+    const std::string& m_text;
+    std::size_t m_pos = 0;
+};
+
+// Sorts by mass, merges peaks within merge_width of the first of their cluster at the
+// abundance-weighted mass, and drops those below min_abundance of the tallest
+void condense(Peaks& peaks, const IsotopeOptions& options) {
+    std::sort(peaks.begin(), peaks.end());
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < peaks.size();) {
+        const double start = peaks[i].first;
+        double weight = 0.0;
+        double moment = 0.0;
+        for (; i < peaks.size() && peaks[i].first - start < options.merge_width; ++i) {
+            weight += peaks[i].second;
+            moment += peaks[i].first * peaks[i].second;
+        }
+        peaks[kept++] = {weight > 0.0 ? moment / weight : start, weight};
+    }
+    peaks.resize(kept);
+    double tallest = 0.0;
+    for (const auto& peak : peaks) tallest = std::max(tallest, peak.second);
+    const double floor = options.min_abundance * tallest;
+    peaks.erase(std::remove_if(peaks.begin(), peaks.end(),
+                               [floor](const auto& peak) { return peak.second < floor; }),
+                peaks.end());
+}
+
+auto convolve(const Peaks& a, const Peaks& b, const IsotopeOptions& options) -> Peaks {
+    Peaks out;
+    out.reserve(a.size() * b.size());
+    for (const auto& pa : a) {
+        for (const auto& pb : b) out.emplace_back(pa.first + pb.first, pa.second * pb.second);
+    }
+    condense(out, options);
+    return out;
+}
+
+}  // namespace
+
+auto parse_formula(const std::string& formula) -> std::vector<ElementCount> {
+    return FormulaParser(formula).parse();
+}
+
+/**
+ * @brief Isotope pattern of a formula as the product of its elements' isotope polynomials.
+ *
+ * Each element's n-th power is formed by repeated squaring, so C_n costs log2(n)
+ * convolutions, and the element patterns are then multiplied together. After every
+ * convolution nearby peaks are merged and negligible ones pruned, which keeps the
+ * intermediate patterns to a few dozen peaks at nominal resolution and bounds them at fine
+ * resolution. Merging keeps the total abundance and mean mass of what it combines.
+ *
+ * @throws std::invalid_argument for a bad formula, one without atoms, or negative options.
+ */
+auto isotope_envelope(const std::string& formula, const IsotopeOptions& options)
+    -> IsotopeEnvelope {
+    if (!(options.merge_width >= 0.0) || !(options.min_abundance >= 0.0))
+        throw std::invalid_argument("Isotope options must be nonnegative");
+    Peaks pattern = {{0.0, 1.0}};
+    int atoms = 0;
+    for (const ElementCount& element : parse_formula(formula)) {
+        atoms += element.count;
+        Peaks power = element_peaks(element.symbol);
+        for (int n = element.count; n > 0; n >>= 1) {
+            if ((n & 1) != 0)
+                pattern = convolve(pattern, power, options);
+            if (n > 1)
+                power = convolve(power, power, options);
+        }
+    }
+    if (atoms == 0)
+        throw std::invalid_argument("Formula \"" + formula + "\" has no atoms");
+
+    IsotopeEnvelope envelope;
+    envelope.mass.reserve(pattern.size());
+    envelope.abundance.reserve(pattern.size());
+    for (const auto& [mass, abundance] : pattern) {
+        envelope.mass.push_back(mass);
+        envelope.abundance.push_back(abundance);
+    }
+    return envelope;
+}
+
+/**
+ * @brief Lays out the envelope once per charge state, charge state major.
+ *
+ * @throws std::invalid_argument for a zero charge state.
+ */
+auto envelope_mass_list(const IsotopeEnvelope& envelope, const std::vector<int>& charge_states,
+                        double adduct_mass) -> MassList {
+    MassList list;
+    const std::size_t total = envelope.size() * charge_states.size();
+    list.mz.reserve(total);
+    list.charge_state.reserve(total);
+    list.intensity.reserve(total);
+    for (int z : charge_states) {
+        if (z == 0)
+            throw std::invalid_argument("Envelope charge states must be nonzero");
+        const double shift = z * adduct_mass;
+        const double per_charge = 1.0 / std::abs(z);
+        for (std::size_t i = 0; i < envelope.size(); ++i) {
+            list.mz.push_back((envelope.mass[i] + shift) * per_charge);
+            list.charge_state.push_back(z);
+            list.intensity.push_back(envelope.abundance[i]);
+        }
+    }
+    return list;
+}
+
+/**
+ * @brief Transmitted fraction of each charge state's envelope.
+ *
+ * All charge states go through mathieu_q_from_mz(), mathieu_a_from_mz() and the batch
+ * classify_stability() as one column, since q and a depend only on m/z.
+ */
+auto envelope_transmission(const IsotopeEnvelope& envelope, const std::vector<int>& charge_states,
+                           double voltage_rf, double voltage_dc, const QuadrupoleParams& params,
+                           double adduct_mass) -> std::vector<double> {
+    const MassList list = envelope_mass_list(envelope, charge_states, adduct_mass);
+    const std::size_t count = list.size();
+    std::vector<double> q(count);
+    std::vector<double> a(count);
+    std::vector<StabilityClass> classes(count);
+    mathieu_q_from_mz(voltage_rf, params, list.mz.data(), count, q.data());
+    mathieu_a_from_mz(voltage_dc, params, list.mz.data(), count, a.data());
+    classify_stability(q.data(), a.data(), count, classes.data());
+
+    std::vector<double> transmission(charge_states.size(), 0.0);
+    double total = 0.0;
+    for (double abundance : envelope.abundance) total += abundance;
+    const std::size_t peaks = envelope.size();
+    for (std::size_t c = 0; c < charge_states.size(); ++c) {
+        double passed = 0.0;
+        for (std::size_t i = c * peaks; i < (c + 1) * peaks; ++i)
+            passed += classes[i] == StabilityClass::Both ? list.intensity[i] : 0.0;
+        transmission[c] = total > 0.0 ? passed / total : 0.0;
+    }
+    return transmission;
+}
+
+}  // namespace mathieu_lib
+
+// NOLINTEND(readability-magic-numbers)
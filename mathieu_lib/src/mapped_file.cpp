@@ -0,0 +1,141 @@
+/**
+ * @file mapped_file.cpp
+ * @brief Platform memory mapping for large input and result files.
+ */
+#include "mathieu_lib/mapped_file.h"
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mathieu_lib {
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& path, Access access) : m_access(access) {
+    const bool write = access == Access::ReadWrite;
+    HANDLE file = CreateFileA(path.c_str(), write ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+                              write ? FILE_SHARE_READ | FILE_SHARE_WRITE : FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Cannot open file: " + path);
+    m_file = file;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        release();
+        throw std::runtime_error("Cannot stat file: " + path);
+    }
+    m_size = static_cast<std::size_t>(size.QuadPart);
+    if (m_size == 0)
+        return;
+    m_mapping =
+        CreateFileMappingA(file, nullptr, write ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping) {
+        release();
+        throw std::runtime_error("Cannot map file: " + path);
+    }
+    m_data = static_cast<char*>(
+        MapViewOfFile(m_mapping, write ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+    if (!m_data) {
+        release();
+        throw std::runtime_error("Cannot map file: " + path);
+    }
+}
+
+void MappedFile::flush() {
+    if (m_data && writable() &&
+        (!FlushViewOfFile(m_data, 0) || !FlushFileBuffers(static_cast<HANDLE>(m_file))))
+        throw std::runtime_error("Cannot flush mapped file");
+}
+
+void MappedFile::release() {
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (m_file)
+        CloseHandle(m_file);
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+}
+#else
+MappedFile::MappedFile(const std::string& path, Access access) : m_access(access) {
+    const bool write = access == Access::ReadWrite;
+    m_fd = ::open(path.c_str(), write ? O_RDWR : O_RDONLY);
+    if (m_fd < 0)
+        throw std::runtime_error("Cannot open file: " + path);
+    struct stat info {};
+    if (::fstat(m_fd, &info) != 0) {
+        release();
+        throw std::runtime_error("Cannot stat file: " + path);
+    }
+    m_size = static_cast<std::size_t>(info.st_size);
+    if (m_size == 0)
+        return;
+    void* mapped = ::mmap(nullptr, m_size, write ? PROT_READ | PROT_WRITE : PROT_READ,
+                          write ? MAP_SHARED : MAP_PRIVATE, m_fd, 0);
+    if (mapped == MAP_FAILED) {
+        release();
+        throw std::runtime_error("Cannot map file: " + path);
+    }
+    if (!write)
+        ::madvise(mapped, m_size, MADV_SEQUENTIAL);
+    m_data = static_cast<char*>(mapped);
+}
+
+void MappedFile::flush() {
+    if (m_data && writable() && ::msync(m_data, m_size, MS_SYNC) != 0)
+        throw std::runtime_error("Cannot flush mapped file");
+}
+
+void MappedFile::release() {
+    if (m_data)
+        ::munmap(m_data, m_size);
+    if (m_fd >= 0)
+        ::close(m_fd);
+    m_data = nullptr;
+    m_fd = -1;
+    m_size = 0;
+}
+#endif
+
+MappedFile::~MappedFile() { release(); }
+
+auto MappedFile::mutable_data() -> char* {
+    if (!writable())
+        throw std::invalid_argument("File is mapped read-only");
+    return m_data;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+
+auto MappedFile::operator=(MappedFile&& other) noexcept -> MappedFile& {
+    if (this != &other) {
+        release();
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_access, other.m_access);
+#ifdef _WIN32
+        std::swap(m_file, other.m_file);
+        std::swap(m_mapping, other.m_mapping);
+#else
+        std::swap(m_fd, other.m_fd);
+#endif
+    }
+    return *this;
+}
+
+}  // namespace mathieu_lib
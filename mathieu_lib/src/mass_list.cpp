@@ -0,0 +1,153 @@
+/**
+ * @file mass_list.cpp
+ * @brief Chunked, parallel CSV/TSV mass-list parser over memory-mapped files.
+ */
+#include "mathieu_lib/mass_list.h"
+
+#include <algorithm>
+#include <charconv>
+#include <thread>
+
+#include "mathieu_lib/mapped_file.h"
+
+namespace mathieu_lib {
+
+namespace {
+
+auto is_separator(char c) -> bool { return c == ',' || c == '\t' || c == ';' || c == ' '; }
+
+/**
+ * @brief Parses the lines in [begin, end) into columns.
+ *
+ * Fields are split on comma, tab, semicolon or spaces. Lines whose m/z field is not a
+ * positive number (headers, comments, blank lines) are skipped.
+ */
+void parse_chunk(const char* begin, const char* end, const MassListImportOptions& options,
+                 MassList& out) {
+    constexpr int kMaxFields = 16;
+    const char* field_begin[kMaxFields];
+    const char* field_end[kMaxFields];
+    const char* line = begin;
+    while (line < end) {
+        const char* line_end = std::find(line, end, '\n');
+        int fields = 0;
+        const char* p = line;
+        while (p < line_end && fields < kMaxFields) {
+            while (p < line_end && (is_separator(*p) || *p == '\r')) ++p;
+            if (p >= line_end)
+                break;
+            field_begin[fields] = p;
+            while (p < line_end && !is_separator(*p) && *p != '\r') ++p;
+            field_end[fields++] = p;
+        }
+        line = line_end + 1;
+
+        auto number = [&](int column, double fallback, bool& ok) {
+            ok = column >= 0 && column < fields;
+            if (!ok)
+                return fallback;
+            const char* first = field_begin[column];
+            if (*first == '+')
+                ++first;
+            double value = fallback;
+            auto result = std::from_chars(first, field_end[column], value);
+            ok = result.ec == std::errc() && result.ptr == field_end[column];
+            return ok ? value : fallback;
+        };
+        bool ok = false;
+        double mz_val = number(options.mz_column, 0.0, ok);
+        if (!ok || !(mz_val > 0.0))
+            continue;
+        double charge_val = number(options.charge_column, 1.0, ok);
+        double intensity_val = number(options.intensity_column, 1.0, ok);
+        out.mz.push_back(mz_val);
+        out.charge_state.push_back(charge_val >= 1.0 ? static_cast<int>(charge_val) : 1);
+        out.intensity.push_back(intensity_val);
+    }
+}
+
+}  // namespace
+
+/**
+ * @brief Parses an in-memory CSV/TSV mass list (m/z, charge, intensity) into columns.
+ *
+ * The buffer is split into chunks of roughly options.chunk_bytes on line boundaries and the
+ * chunks are parsed in parallel; results are concatenated in file order.
+ *
+ * @param data Pointer to the text.
+ * @param size Number of bytes.
+ * @param options Column layout, chunking, progress and cancellation.
+ * @return The parsed columns.
+ * @throws ImportCancelled if options.cancel is raised before parsing completes.
+ */
+auto parse_mass_list(const char* data, std::size_t size, const MassListImportOptions& options)
+    -> MassList {
+    // Chunk boundaries always sit just after a newline (or at the end of the buffer)
+    std::vector<const char*> bounds{data};
+    const std::size_t chunk_bytes = std::max<std::size_t>(options.chunk_bytes, 1);
+    const char* end = data + size;
+    while (bounds.back() < end) {
+        const char* next = bounds.back() + std::min<std::size_t>(chunk_bytes, end - bounds.back());
+        next = next < end ? std::find(next, end, '\n') : end;
+        bounds.push_back(next < end ? next + 1 : end);
+    }
+    const std::size_t chunks = bounds.size() - 1;
+
+    std::vector<MassList> parts(chunks);
+    std::atomic<std::size_t> bytes_done{0};
+    // The calling thread takes part in the loop and is the only one reporting progress
+    const std::thread::id caller = std::this_thread::get_id();
+    ThreadPool& pool = options.pool ? *options.pool : ThreadPool::global();
+    ParallelForOptions loop;
+    loop.grain = 1;
+    loop.cancel = options.cancel;
+    pool.parallel_for(0, chunks, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            const std::size_t bytes = bounds[i + 1] - bounds[i];
+            // Rough upfront reservation: ~16 bytes per line
+            parts[i].mz.reserve(bytes / 16);
+            parts[i].charge_state.reserve(bytes / 16);
+            parts[i].intensity.reserve(bytes / 16);
+            parse_chunk(bounds[i], bounds[i + 1], options, parts[i]);
+            std::size_t done = bytes_done += bytes;
+            if (options.progress && std::this_thread::get_id() == caller)
+                options.progress(done, size);
+        }
+    }, loop);
+    if (cancel_requested(options.cancel))
+        throw ImportCancelled();
+    if (options.progress)
+        options.progress(size, size);
+
+    MassList result;
+    std::size_t total = 0;
+    for (const auto& part : parts) total += part.size();
+    result.mz.reserve(total);
+    result.charge_state.reserve(total);
+    result.intensity.reserve(total);
+    for (const auto& part : parts) {
+        result.mz.insert(result.mz.end(), part.mz.begin(), part.mz.end());
+        result.charge_state.insert(result.charge_state.end(), part.charge_state.begin(),
+                                   part.charge_state.end());
+        result.intensity.insert(result.intensity.end(), part.intensity.begin(),
+                                part.intensity.end());
+    }
+    return result;
+}
+
+/**
+ * @brief Memory-maps a CSV/TSV mass list and parses it in parallel.
+ *
+ * @param path File to import.
+ * @param options Column layout, chunking, progress and cancellation.
+ * @return The parsed columns.
+ * @throws std::runtime_error if the file cannot be mapped.
+ * @throws ImportCancelled if options.cancel is raised before parsing completes.
+ */
+auto import_mass_list(const std::string& path, const MassListImportOptions& options)
+    -> MassList {
+    MappedFile file(path);
+    return parse_mass_list(file.data(), file.size(), options);
+}
+
+}  // namespace mathieu_lib
@@ -12,6 +12,8 @@
 #include <vector>
 
 #include "Constants.h"
+#include "mathieu_factors.h"
+#include "mathieu_lib/geometry.h"
 
 /**
  * @namespace mathieu_lib
@@ -54,6 +56,17 @@ auto particle_mass(const std::vector<double>& molar_masses) -> std::vector<doubl
     return result;
 }
 
+namespace {
+
+// out[i] = scale / mzs[i]; one division per ion, so the loop vectorizes
+template <typename Real>
+void divide_by_mz(double scale, const Real* mzs, std::size_t count, Real* out) {
+    const auto scale_real = static_cast<Real>(scale);
+    for (std::size_t i = 0; i < count; ++i) out[i] = scale_real / mzs[i];
+}
+
+}  // namespace
+
 /**
  * @brief Calculates the Mathieu q parameter for an ion in a quadrupole field.
  *
@@ -128,6 +141,129 @@ auto mathieu_a(const std::vector<double>& voltage_dcs, const std::vector<int>& c
     return result;
 }
 
+/**
+ * @brief Calculates the Mathieu q parameter for a column of ions given by m/z.
+ *
+ * Inverse of mz(): \f$ q = \frac{4 (V_{rf}/2) e N_A}{(m/z) \omega^2 r_0^2} \f$ with m/z in
+ * g/mol (Da). The instrument-dependent factor is computed once, so each ion costs a single
+ * division and the loop vectorizes.
+ *
+ * @param voltage_rf Amplitude of the RF voltage in volts.
+ * @param params Struct containing frequency and quad_radius (molar_mass is ignored).
+ * @param mzs Pointer to count m/z values in Da.
+ * @param count Number of ions.
+ * @param out Destination for count q values.
+ */
+template <typename Real>
+void mathieu_q_from_mz(double voltage_rf, const QuadrupoleParams& params, const Real* mzs,
+                       std::size_t count, Real* out) {
+    divide_by_mz(q_times_mz<LinearQuadrupole>(voltage_rf, params), mzs, count, out);
+}
+template void mathieu_q_from_mz<float>(double, const QuadrupoleParams&, const float*,
+                                       std::size_t, float*);
+template void mathieu_q_from_mz<double>(double, const QuadrupoleParams&, const double*,
+                                        std::size_t, double*);
+auto mathieu_q_from_mz(double voltage_rf, const QuadrupoleParams& params,
+                       const std::vector<double>& mzs) -> std::vector<double> {
+    std::vector<double> result(mzs.size());
+    mathieu_q_from_mz(voltage_rf, params, mzs.data(), mzs.size(), result.data());
+    return result;
+}
+
+/**
+ * @brief Calculates the Mathieu a parameter for a column of ions given by m/z.
+ *
+ * \f$ a = \frac{8 V_{dc} e N_A}{(m/z) \omega^2 r_0^2} \f$ with m/z in g/mol (Da).
+ *
+ * @param voltage_dc Amplitude of the DC voltage in volts.
+ * @param params Struct containing frequency and quad_radius (molar_mass is ignored).
+ * @param mzs Pointer to count m/z values in Da.
+ * @param count Number of ions.
+ * @param out Destination for count a values.
+ */
+template <typename Real>
+void mathieu_a_from_mz(double voltage_dc, const QuadrupoleParams& params, const Real* mzs,
+                       std::size_t count, Real* out) {
+    divide_by_mz(a_times_mz<LinearQuadrupole>(voltage_dc, params), mzs, count, out);
+}
+template void mathieu_a_from_mz<float>(double, const QuadrupoleParams&, const float*,
+                                       std::size_t, float*);
+template void mathieu_a_from_mz<double>(double, const QuadrupoleParams&, const double*,
+                                        std::size_t, double*);
+auto mathieu_a_from_mz(double voltage_dc, const QuadrupoleParams& params,
+                       const std::vector<double>& mzs) -> std::vector<double> {
+    std::vector<double> result(mzs.size());
+    mathieu_a_from_mz(voltage_dc, params, mzs.data(), mzs.size(), result.data());
+    return result;
+}
+
+/**
+ * @brief Axial Mathieu q_z of an ion in a 3D Paul trap.
+ *
+ * \f$ q_z = \frac{8 z e (V_{rf}/2)}{m (r_0^2 + 2 z_0^2) \omega^2} \f$, which for the ideal
+ * trap (r_0^2 = 2 z_0^2) is the quadrupole formula with r_0. The radial q_r is -q_z / 2.
+ *
+ * @param voltage_rf Amplitude of the RF voltage on the ring in volts.
+ * @param charge_state Charge state of the ion (integer).
+ * @param params Frequency, ring radius r0, end-cap distance z0 and molar mass.
+ * @return The axial q_z (dimensionless).
+ */
+auto mathieu_q(double voltage_rf, int charge_state, const PaulTrapParams& params) -> double {
+    return PaulTrap3D::Q_FACTOR * charge_state * (voltage_rf / 2) *
+           field_factor<PaulTrap3D>(params) / particle_mass(params.molar_mass);
+}
+
+/**
+ * @brief Axial Mathieu a_z of an ion in a 3D Paul trap.
+ *
+ * \f$ a_z = -\frac{16 z e V_{dc}}{m (r_0^2 + 2 z_0^2) \omega^2} \f$ with V_dc on the ring
+ * relative to the end caps. The radial a_r is -a_z / 2.
+ *
+ * @param voltage_dc DC voltage of the ring in volts.
+ * @param charge_state Charge state of the ion (integer).
+ * @param params Frequency, ring radius r0, end-cap distance z0 and molar mass.
+ * @return The axial a_z (dimensionless).
+ */
+auto mathieu_a(double voltage_dc, int charge_state, const PaulTrapParams& params) -> double {
+    return PaulTrap3D::A_FACTOR * charge_state * voltage_dc * field_factor<PaulTrap3D>(params) /
+           particle_mass(params.molar_mass);
+}
+
+/**
+ * @brief q_z for a column of ions given by m/z (Da), with the same kernel as the quadrupole.
+ */
+template <typename Real>
+void mathieu_q_from_mz(double voltage_rf, const PaulTrapParams& params, const Real* mzs,
+                       std::size_t count, Real* out) {
+    divide_by_mz(q_times_mz<PaulTrap3D>(voltage_rf, params), mzs, count, out);
+}
+template void mathieu_q_from_mz<float>(double, const PaulTrapParams&, const float*, std::size_t,
+                                       float*);
+template void mathieu_q_from_mz<double>(double, const PaulTrapParams&, const double*,
+                                        std::size_t, double*);
+
+/**
+ * @brief a_z for a column of ions given by m/z (Da).
+ */
+template <typename Real>
+void mathieu_a_from_mz(double voltage_dc, const PaulTrapParams& params, const Real* mzs,
+                       std::size_t count, Real* out) {
+    divide_by_mz(a_times_mz<PaulTrap3D>(voltage_dc, params), mzs, count, out);
+}
+template void mathieu_a_from_mz<float>(double, const PaulTrapParams&, const float*, std::size_t,
+                                       float*);
+template void mathieu_a_from_mz<double>(double, const PaulTrapParams&, const double*,
+                                        std::size_t, double*);
+
+/**
+ * @brief m/z (Da) of the ion at axial q_z in a 3D Paul trap; at q_z = MAX_Q this is the
+ *        low-mass cutoff of the trap.
+ */
+auto mz(double voltage_rf, int /*charge_state*/, const PaulTrapParams& params, double mathieu_q)
+    -> double {
+    return q_times_mz<PaulTrap3D>(voltage_rf, params) / mathieu_q;
+}
+
 /**
  * @brief Calculates the m/z (mass-to-charge ratio) for a given Mathieu q parameter.
  *
@@ -257,7 +393,12 @@ auto max_mz(const std::vector<double>& voltage_rfs, const std::vector<int>& char
  * @param mathieu_q The Mathieu q parameter (dimensionless).
  * @return The stability parameter beta (dimensionless).
  */
-auto beta(double mathieu_q) -> double { return (std::sqrt(2.0) / 2.0) * mathieu_q; }
+template <typename Real>
+auto beta(Real mathieu_q) -> Real {
+    return (std::sqrt(Real(2)) / Real(2)) * mathieu_q;
+}
+template auto beta<float>(float) -> float;
+template auto beta<double>(double) -> double;
 auto beta(const std::vector<double>& mathieu_qs) -> std::vector<double> {
     std::vector<double> result;
     result.reserve(mathieu_qs.size());
@@ -281,9 +422,12 @@ auto beta(const std::vector<double>& mathieu_qs) -> std::vector<double> {
  * @param mathieu_q The Mathieu q parameter (dimensionless).
  * @return The secular frequency in kHz.
  */
-auto secular_frequency(double frequency, double mathieu_q) -> double {
-    return (omega(frequency) / (2 * M_PI) * (beta(mathieu_q) / 2)) / 1000;  // in kHz
+template <typename Real>
+auto secular_frequency(Real frequency, Real mathieu_q) -> Real {
+    return frequency * (beta(mathieu_q) / Real(2)) / Real(1000);  // in kHz
 }
+template auto secular_frequency<float>(float, float) -> float;
+template auto secular_frequency<double>(double, double) -> double;
 auto secular_frequency(const std::vector<double>& frequencies,
                        const std::vector<double>& mathieu_qs) -> std::vector<double> {
     if (frequencies.size() != mathieu_qs.size())
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Constants.h"
+#include "mathieu_lib/geometry.h"
+
+// Instrument factors behind mathieu_q() and mathieu_a(), shared with the modules that derive
+// q and a per ion (pseudopotential, space charge, trajectories) so they all follow one
+// convention. Internal to the library; not installed.
+
+namespace mathieu_lib {
+
+// e / (Omega^2 d^2), the instrument factor shared by q, a and m/z of every geometry
+template <typename Geometry>
+auto field_factor(const typename Geometry::Params& params) -> double {
+    const double omega_val = omega(params.frequency);
+    return E_CHARGE / (omega_val * omega_val * Geometry::field_size_sq(params));
+}
+
+// e / (m Omega^2 d^2) times m/z in Da
+template <typename Geometry>
+auto field_factor_times_mz(const typename Geometry::Params& params) -> double {
+    return AVOGADRO_NUMBER * 1000 * field_factor<Geometry>(params);
+}
+
+// q times m/z (Da) and a times m/z: the per-setting constants of the m/z kernels
+template <typename Geometry>
+auto q_times_mz(double voltage_rf, const typename Geometry::Params& params) -> double {
+    return Geometry::Q_FACTOR * (voltage_rf / 2) * field_factor_times_mz<Geometry>(params);
+}
+template <typename Geometry>
+auto a_times_mz(double voltage_dc, const typename Geometry::Params& params) -> double {
+    return Geometry::A_FACTOR * voltage_dc * field_factor_times_mz<Geometry>(params);
+}
+
+}  // namespace mathieu_lib
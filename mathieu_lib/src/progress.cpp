@@ -0,0 +1,45 @@
+/**
+ * @file progress.cpp
+ * @brief Progress reporting shared by the sweep, rasterization and import engines.
+ */
+#include "mathieu_lib/progress.h"
+
+#include <utility>
+
+namespace mathieu_lib {
+
+ProgressReporter::ProgressReporter(ProgressCallback callback, std::uint64_t total,
+                                   std::uint64_t done)
+    : m_callback(std::move(callback)), m_total(total), m_done(done) {}
+
+void ProgressReporter::report() {
+    if (!m_callback)
+        return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_callback(m_done.load(std::memory_order_relaxed), m_total);
+}
+
+/**
+ * @brief Records finished work and notifies the observers.
+ *
+ * The unobserved case takes no lock, so engines can call this per block unconditionally.
+ *
+ * @param units Units finished since the last call from this worker.
+ * @param partial Optional hook run before the count is published, e.g. to hand a finished
+ *        chunk to the caller.
+ * @return The updated count.
+ */
+auto ProgressReporter::advance(std::uint64_t units, const std::function<void()>& partial)
+    -> std::uint64_t {
+    if (!m_callback && !partial)
+        return m_done.fetch_add(units, std::memory_order_relaxed) + units;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (partial)
+        partial();
+    const std::uint64_t done = m_done.fetch_add(units, std::memory_order_relaxed) + units;
+    if (m_callback)
+        m_callback(done, m_total);
+    return done;
+}
+
+}  // namespace mathieu_lib
@@ -0,0 +1,150 @@
+// NOLINTBEGIN(readability-magic-numbers)
+
+/**
+ * @file pseudopotential.cpp
+ * @brief Dehmelt pseudopotential well depths, adiabaticity and storable energy.
+ */
+#include "mathieu_lib/pseudopotential.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+#include "Constants.h"
+#include "mathieu_factors.h"
+#include "mathieu_lib/stability.h"
+
+namespace mathieu_lib {
+
+/**
+ * @brief beta^2 to order q^6 from the continued fraction of the characteristic equation:
+ *
+ * \f$ \beta^2 = a - \frac{(a-1) q^2}{2 (a-1)^2 - q^2}
+ *              - \frac{(5a+7) q^4}{32 (a-1)^3 (a-4)}
+ *              - \frac{(9a^2+58a+29) q^6}{64 (a-1)^5 (a-4)(a-9)} \f$
+ *
+ * Within a few 1e-4 of the exact value for q <= 0.4 in the first stability region; the
+ * lowest-order Dehmelt value is a + q^2 / 2. Branch-free, so batch loops vectorize.
+ */
+template <typename Real>
+auto adiabatic_beta_squared(Real mathieu_q, Real mathieu_a) -> Real {
+    const Real a = mathieu_a;
+    const Real q2 = mathieu_q * mathieu_q;
+    const Real am1 = a - Real(1);
+    const Real am1_2 = am1 * am1;
+    const Real am1_3 = am1_2 * am1;
+    return a - am1 * q2 / (Real(2) * am1_2 - q2) -
+           (Real(5) * a + Real(7)) * q2 * q2 / (Real(32) * am1_3 * (a - Real(4))) -
+           (Real(9) * a * a + Real(58) * a + Real(29)) * q2 * q2 * q2 /
+               (Real(64) * am1_3 * am1_2 * (a - Real(4)) * (a - Real(9)));
+}
+template auto adiabatic_beta_squared<float>(float, float) -> float;
+template auto adiabatic_beta_squared<double>(double, double) -> double;
+
+/**
+ * @brief Well depths along x and y, adiabaticity and the largest storable radial energy of
+ *        one ion.
+ *
+ * The depth of each direction is m Omega^2 r0^2 beta^2 / (8 |z| e), with y seeing -a. A
+ * direction that classify_stability() finds unconfined reports depth 0: the expansion of
+ * beta^2 does not see the upper edge of the region, where beta reaches 1.
+ *
+ * @param voltage_rf RF voltage in volts, as for mathieu_q().
+ * @param voltage_dc DC voltage in volts, as for mathieu_a().
+ * @param charge_state Charge state of the ion (nonzero).
+ * @param params Struct containing frequency, quad_radius, and molar_mass.
+ * @throws std::invalid_argument if charge_state is zero.
+ */
+auto pseudopotential(double voltage_rf, double voltage_dc, int charge_state,
+                     const QuadrupoleParams& params) -> Pseudopotential {
+    if (charge_state == 0)
+        throw std::invalid_argument("Pseudopotential needs a nonzero charge state");
+    const double q = mathieu_q(voltage_rf, charge_state, params);
+    const double a = mathieu_a(voltage_dc, charge_state, params);
+    const double scale = particle_mass(params.molar_mass) /
+                         (8.0 * std::abs(charge_state) * field_factor<LinearQuadrupole>(params));
+    const auto confined = static_cast<unsigned>(classify_stability(q, a));
+    Pseudopotential result{};
+    if ((confined & static_cast<unsigned>(StabilityClass::X)) != 0)
+        result.depth_x = std::max(adiabatic_beta_squared(q, a), 0.0) * scale;
+    if ((confined & static_cast<unsigned>(StabilityClass::Y)) != 0)
+        result.depth_y = std::max(adiabatic_beta_squared(q, -a), 0.0) * scale;
+    result.adiabaticity = std::abs(q);
+    result.max_energy = std::abs(charge_state) * std::min(result.depth_x, result.depth_y);
+    return result;
+}
+
+/**
+ * @brief Depth of the shallower direction for a column of ions given by m/z.
+ *
+ * q, a and the depth scale are all linear in m/z or its inverse, so each ion costs two
+ * divisions, one multiply and the two beta^2 polynomials. Ions are taken in blocks so that
+ * the stability mask comes from the batch classify_stability(); none of the loops branch.
+ *
+ * @param voltage_rf RF voltage in volts.
+ * @param voltage_dc DC voltage in volts.
+ * @param params Struct containing frequency and quad_radius (molar_mass is ignored).
+ * @param mzs Pointer to count m/z values in Da.
+ * @param count Number of ions.
+ * @param out Destination for count depths in volts.
+ */
+template <typename Real>
+void well_depth_from_mz(double voltage_rf, double voltage_dc, const QuadrupoleParams& params,
+                        const Real* mzs, std::size_t count, Real* out) {
+    const auto q_scale = static_cast<Real>(q_times_mz<LinearQuadrupole>(voltage_rf, params));
+    const auto a_scale = static_cast<Real>(a_times_mz<LinearQuadrupole>(voltage_dc, params));
+    const auto depth_scale =
+        static_cast<Real>(1.0 / (8.0 * field_factor_times_mz<LinearQuadrupole>(params)));
+    constexpr std::size_t BLOCK = 256;
+    std::array<Real, BLOCK> qs{};
+    std::array<Real, BLOCK> as{};
+    std::array<StabilityClass, BLOCK> classes{};
+    for (std::size_t start = 0; start < count; start += BLOCK) {
+        const std::size_t n = std::min(BLOCK, count - start);
+        for (std::size_t i = 0; i < n; ++i) {
+            qs[i] = q_scale / mzs[start + i];
+            as[i] = a_scale / mzs[start + i];
+        }
+        classify_stability(qs.data(), as.data(), n, classes.data());
+        for (std::size_t i = 0; i < n; ++i) {
+            const Real beta2 = std::min(adiabatic_beta_squared(qs[i], as[i]),
+                                        adiabatic_beta_squared(qs[i], -as[i]));
+            const Real mask = classes[i] == StabilityClass::Both ? Real(1) : Real(0);
+            out[start + i] = mask * std::max(beta2, Real(0)) * depth_scale * mzs[start + i];
+        }
+    }
+}
+template void well_depth_from_mz<float>(double, double, const QuadrupoleParams&, const float*,
+                                        std::size_t, float*);
+template void well_depth_from_mz<double>(double, double, const QuadrupoleParams&, const double*,
+                                         std::size_t, double*);
+auto well_depth_from_mz(double voltage_rf, double voltage_dc, const QuadrupoleParams& params,
+                        const std::vector<double>& mzs) -> std::vector<double> {
+    std::vector<double> result(mzs.size());
+    well_depth_from_mz(voltage_rf, voltage_dc, params, mzs.data(), mzs.size(), result.data());
+    return result;
+}
+
+/**
+ * @brief Pseudopotential depth and adiabaticity of a 2n-pole at r / r0 (Gerlich).
+ *
+ * Higher multipoles have flatter, steeper-walled wells: the depth grows as (r / r0)^(2n - 2)
+ * and the adiabaticity as (r / r0)^(n - 2), so eta stays small over most of the trap.
+ *
+ * @throws std::invalid_argument if poles_half < 2.
+ */
+auto multipole_pseudopotential(int poles_half, double voltage_rf, double mathieu_q,
+                               double r_over_r0) -> MultipolePseudopotential {
+    if (poles_half < 2)
+        throw std::invalid_argument("A multipole needs n >= 2 (n = 2 is the quadrupole)");
+    const double n = poles_half;
+    MultipolePseudopotential result{};
+    result.depth = n * n * mathieu_q * voltage_rf / 32.0 * std::pow(r_over_r0, 2.0 * n - 2.0);
+    result.adiabaticity = n * (n - 1.0) * std::abs(mathieu_q) / 2.0 * std::pow(r_over_r0, n - 2.0);
+    return result;
+}
+
+}  // namespace mathieu_lib
+
+// NOLINTEND(readability-magic-numbers)
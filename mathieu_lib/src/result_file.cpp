@@ -0,0 +1,378 @@
+/**
+ * @file result_file.cpp
+ * @brief Versioned little-endian columnar result files: streaming writer and mmap reader.
+ */
+#include "mathieu_lib/result_file.h"
+
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <utility>
+
+namespace mathieu_lib {
+
+namespace {
+
+constexpr char HEADER_MAGIC[8] = {'T', 'R', 'A', 'P', 'R', 'E', 'S', '\0'};
+constexpr char TRAILER_MAGIC[8] = {'T', 'R', 'A', 'P', 'E', 'N', 'D', '\0'};
+constexpr std::uint32_t FLAG_STATISTICS = 1u;
+
+// Values are stored in host order, so only little-endian hosts can read or write files.
+void require_little_endian() {
+    const std::uint16_t probe = 1;
+    unsigned char first = 0;
+    std::memcpy(&first, &probe, 1);
+    if (first != 1)
+        throw std::runtime_error("Result files require a little-endian host");
+}
+
+auto padded(std::uint64_t bytes) -> std::uint64_t { return (bytes + 7) & ~std::uint64_t(7); }
+
+template <typename T>
+void put(std::vector<char>& out, T value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+auto get(const char* data, std::size_t size, std::size_t& pos) -> T {
+    if (pos + sizeof(T) > size)
+        throw std::runtime_error("Invalid result file: truncated footer");
+    T value;
+    std::memcpy(&value, data + pos, sizeof(T));
+    pos += sizeof(T);
+    return value;
+}
+
+template <typename T>
+void min_max(const T* values, std::size_t rows, double& lo, double& hi) {
+    lo = std::numeric_limits<double>::infinity();
+    hi = -std::numeric_limits<double>::infinity();
+    for (std::size_t i = 0; i < rows; ++i) {
+        const double v = static_cast<double>(values[i]);
+        if (v < lo)
+            lo = v;
+        if (v > hi)
+            hi = v;
+    }
+}
+
+auto encode_header(std::size_t column_count, std::uint64_t rows, std::uint64_t chunk_count,
+                   std::uint64_t footer_offset, bool statistics) -> std::vector<char> {
+    std::vector<char> header;
+    header.insert(header.end(), HEADER_MAGIC, HEADER_MAGIC + sizeof(HEADER_MAGIC));
+    put<std::uint16_t>(header, RESULT_FILE_MAJOR_VERSION);
+    put<std::uint16_t>(header, RESULT_FILE_MINOR_VERSION);
+    put<std::uint32_t>(header, statistics ? FLAG_STATISTICS : 0u);
+    put<std::uint32_t>(header, static_cast<std::uint32_t>(column_count));
+    put<std::uint32_t>(header, 0u);
+    put<std::uint64_t>(header, rows);
+    put<std::uint64_t>(header, chunk_count);
+    put<std::uint64_t>(header, footer_offset);
+    header.resize(RESULT_FILE_HEADER_SIZE, '\0');
+    return header;
+}
+
+// Footer followed by the trailer
+auto encode_footer(const std::vector<ColumnSpec>& columns,
+                   const std::vector<ResultChunkInfo>& chunks, std::uint64_t footer_offset)
+    -> std::vector<char> {
+    std::vector<char> footer;
+    put<std::uint32_t>(footer, static_cast<std::uint32_t>(columns.size()));
+    for (const ColumnSpec& column : columns) {
+        put<std::uint32_t>(footer, static_cast<std::uint32_t>(column.type));
+        put<std::uint32_t>(footer, static_cast<std::uint32_t>(column.name.size()));
+        footer.insert(footer.end(), column.name.begin(), column.name.end());
+    }
+    put<std::uint64_t>(footer, chunks.size());
+    for (const ResultChunkInfo& chunk : chunks) {
+        put<std::uint64_t>(footer, chunk.first_row);
+        put<std::uint64_t>(footer, chunk.rows);
+        for (const ColumnChunkInfo& column : chunk.columns) {
+            put<std::uint64_t>(footer, column.offset);
+            put<double>(footer, column.min);
+            put<double>(footer, column.max);
+        }
+    }
+    put<std::uint64_t>(footer, footer_offset);
+    footer.insert(footer.end(), TRAILER_MAGIC, TRAILER_MAGIC + sizeof(TRAILER_MAGIC));
+    return footer;
+}
+
+// Chunk directory of a preallocated file: one chunk without statistics (none when empty)
+auto single_chunk(const ResultFileLayout& layout, std::uint64_t rows)
+    -> std::vector<ResultChunkInfo> {
+    if (rows == 0)
+        return {};
+    ResultChunkInfo chunk{0, rows, {}};
+    for (std::uint64_t offset : layout.column_offsets)
+        chunk.columns.push_back({offset, std::numeric_limits<double>::quiet_NaN(),
+                                 std::numeric_limits<double>::quiet_NaN()});
+    return {chunk};
+}
+
+}  // namespace
+
+auto column_type_size(ColumnType type) -> std::size_t {
+    switch (type) {
+        case ColumnType::Float64:
+            return sizeof(double);
+        case ColumnType::Int32:
+            return sizeof(std::int32_t);
+        case ColumnType::UInt8:
+            return sizeof(std::uint8_t);
+    }
+    throw std::invalid_argument("Unknown column type");
+}
+
+ResultFileWriter::ResultFileWriter(const std::string& path, std::vector<ColumnSpec> columns,
+                                   bool chunk_statistics)
+    : m_columns(std::move(columns)), m_statistics(chunk_statistics) {
+    require_little_endian();
+    if (m_columns.empty())
+        throw std::invalid_argument("Result file needs at least one column");
+    for (const ColumnSpec& column : m_columns) column_type_size(column.type);
+    m_file = std::fopen(path.c_str(), "wb");
+    if (!m_file)
+        throw std::runtime_error("Cannot open file: " + path);
+    // Placeholder header; counts and the footer offset are patched in close()
+    const char zeros[RESULT_FILE_HEADER_SIZE] = {};
+    if (std::fwrite(zeros, 1, sizeof(zeros), m_file) != sizeof(zeros)) {
+        std::fclose(m_file);
+        throw std::runtime_error("Cannot write file: " + path);
+    }
+    m_offset = RESULT_FILE_HEADER_SIZE;
+}
+
+ResultFileWriter::~ResultFileWriter() {
+    try {
+        close();
+    } catch (...) {  // NOLINT(bugprone-empty-catch) destructors must not throw
+    }
+}
+
+/**
+ * @brief Appends one chunk of `rows` rows, column by column, and records its statistics.
+ */
+void ResultFileWriter::write_chunk(const std::vector<const void*>& columns, std::size_t rows) {
+    if (!m_file)
+        throw std::invalid_argument("Result file is closed");
+    if (columns.size() != m_columns.size())
+        throw std::invalid_argument("Chunk column count does not match the file");
+    if (rows == 0)
+        return;
+    static const char padding[8] = {};
+    ResultChunkInfo info{m_rows, rows, {}};
+    info.columns.reserve(columns.size());
+    for (std::size_t c = 0; c < columns.size(); ++c) {
+        const std::size_t bytes = rows * column_type_size(m_columns[c].type);
+        double lo = std::numeric_limits<double>::quiet_NaN();
+        double hi = lo;
+        if (m_statistics) {
+            switch (m_columns[c].type) {
+                case ColumnType::Float64:
+                    min_max(static_cast<const double*>(columns[c]), rows, lo, hi);
+                    break;
+                case ColumnType::Int32:
+                    min_max(static_cast<const std::int32_t*>(columns[c]), rows, lo, hi);
+                    break;
+                case ColumnType::UInt8:
+                    min_max(static_cast<const std::uint8_t*>(columns[c]), rows, lo, hi);
+                    break;
+            }
+        }
+        info.columns.push_back({m_offset, lo, hi});
+        const std::size_t pad = padded(bytes) - bytes;
+        if (std::fwrite(columns[c], 1, bytes, m_file) != bytes ||
+            std::fwrite(padding, 1, pad, m_file) != pad)
+            throw std::runtime_error("Cannot write result chunk");
+        m_offset += bytes + pad;
+    }
+    m_rows += rows;
+    m_chunks.push_back(std::move(info));
+}
+
+/**
+ * @brief Writes the footer and trailer and patches the header. Safe to call more than once.
+ */
+void ResultFileWriter::close() {
+    if (!m_file)
+        return;
+    const std::uint64_t footer_offset = m_offset;
+    const std::vector<char> footer = encode_footer(m_columns, m_chunks, footer_offset);
+    const std::vector<char> header =
+        encode_header(m_columns.size(), m_rows, m_chunks.size(), footer_offset, m_statistics);
+
+    std::FILE* file = m_file;
+    m_file = nullptr;
+    bool ok = std::fwrite(footer.data(), 1, footer.size(), file) == footer.size();
+    ok = ok && std::fseek(file, 0, SEEK_SET) == 0;
+    ok = ok && std::fwrite(header.data(), 1, header.size(), file) == header.size();
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok)
+        throw std::runtime_error("Cannot finish result file");
+}
+
+/**
+ * @brief Byte layout of a single-chunk file holding `rows` rows of `columns`.
+ */
+auto result_file_layout(const std::vector<ColumnSpec>& columns, std::uint64_t rows)
+    -> ResultFileLayout {
+    ResultFileLayout layout;
+    std::uint64_t offset = RESULT_FILE_HEADER_SIZE;
+    for (const ColumnSpec& column : columns) {
+        layout.column_offsets.push_back(offset);
+        offset += padded(rows * column_type_size(column.type));
+    }
+    layout.footer_offset = offset;
+    layout.file_size = offset + encode_footer(columns, single_chunk(layout, rows), offset).size();
+    return layout;
+}
+
+/**
+ * @brief Creates a complete single-chunk file of zero-filled columns at its final size.
+ *
+ * Writers (threads or processes) then fill disjoint row ranges in place through a ReadWrite
+ * MappedFile at the offsets from result_file_layout(); no coordination is needed. Chunk
+ * statistics are not recorded for preallocated files.
+ */
+auto create_preallocated_result_file(const std::string& path,
+                                     const std::vector<ColumnSpec>& columns, std::uint64_t rows)
+    -> ResultFileLayout {
+    require_little_endian();
+    if (columns.empty())
+        throw std::invalid_argument("Result file needs at least one column");
+    const ResultFileLayout layout = result_file_layout(columns, rows);
+    const std::vector<ResultChunkInfo> chunks = single_chunk(layout, rows);
+    const std::vector<char> header =
+        encode_header(columns.size(), rows, chunks.size(), layout.footer_offset, false);
+    const std::vector<char> footer = encode_footer(columns, chunks, layout.footer_offset);
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        throw std::runtime_error("Cannot open file: " + path);
+    const bool ok = std::fwrite(header.data(), 1, header.size(), file) == header.size();
+    if ((std::fclose(file) != 0) || !ok)
+        throw std::runtime_error("Cannot write file: " + path);
+    // Extending the file leaves the column area zero-filled (sparse where supported)
+    std::filesystem::resize_file(path, layout.file_size);
+    MappedFile mapping(path, MappedFile::Access::ReadWrite);
+    std::memcpy(mapping.mutable_data() + layout.footer_offset, footer.data(), footer.size());
+    mapping.flush();
+    return layout;
+}
+
+ResultFileReader::ResultFileReader(const std::string& path) : m_file(path) {
+    require_little_endian();
+    const char* data = m_file.data();
+    const std::size_t size = m_file.size();
+    if (size < RESULT_FILE_HEADER_SIZE + RESULT_FILE_TRAILER_SIZE ||
+        std::memcmp(data, HEADER_MAGIC, sizeof(HEADER_MAGIC)) != 0 ||
+        std::memcmp(data + size - sizeof(TRAILER_MAGIC), TRAILER_MAGIC, sizeof(TRAILER_MAGIC)) !=
+            0)
+        throw std::runtime_error("Not a trappable result file: " + path);
+
+    std::size_t pos = sizeof(HEADER_MAGIC);
+    m_major = get<std::uint16_t>(data, size, pos);
+    m_minor = get<std::uint16_t>(data, size, pos);
+    if (m_major != RESULT_FILE_MAJOR_VERSION)
+        throw std::runtime_error("Unsupported result file version " + std::to_string(m_major));
+    m_statistics = (get<std::uint32_t>(data, size, pos) & FLAG_STATISTICS) != 0;
+    const auto column_count = get<std::uint32_t>(data, size, pos);
+    pos += sizeof(std::uint32_t);
+    m_rows = get<std::uint64_t>(data, size, pos);
+    const auto chunk_count = get<std::uint64_t>(data, size, pos);
+    const auto footer_offset = get<std::uint64_t>(data, size, pos);
+    if (footer_offset < RESULT_FILE_HEADER_SIZE || footer_offset > size - RESULT_FILE_TRAILER_SIZE)
+        throw std::runtime_error("Invalid result file: bad footer offset");
+
+    const std::size_t footer_end = size - RESULT_FILE_TRAILER_SIZE;
+    pos = static_cast<std::size_t>(footer_offset);
+    if (get<std::uint32_t>(data, footer_end, pos) != column_count)
+        throw std::runtime_error("Invalid result file: column count mismatch");
+    m_columns.reserve(column_count);
+    for (std::uint32_t c = 0; c < column_count; ++c) {
+        const auto type = static_cast<ColumnType>(get<std::uint32_t>(data, footer_end, pos));
+        column_type_size(type);
+        const auto length = get<std::uint32_t>(data, footer_end, pos);
+        if (pos + length > footer_end)
+            throw std::runtime_error("Invalid result file: truncated footer");
+        m_columns.push_back({std::string(data + pos, length), type});
+        pos += length;
+    }
+    if (get<std::uint64_t>(data, footer_end, pos) != chunk_count)
+        throw std::runtime_error("Invalid result file: chunk count mismatch");
+    m_chunks.reserve(static_cast<std::size_t>(chunk_count));
+    std::uint64_t rows = 0;
+    for (std::uint64_t k = 0; k < chunk_count; ++k) {
+        ResultChunkInfo info;
+        info.first_row = get<std::uint64_t>(data, footer_end, pos);
+        info.rows = get<std::uint64_t>(data, footer_end, pos);
+        info.columns.resize(column_count);
+        for (std::uint32_t c = 0; c < column_count; ++c) {
+            ColumnChunkInfo& column = info.columns[c];
+            column.offset = get<std::uint64_t>(data, footer_end, pos);
+            column.min = get<double>(data, footer_end, pos);
+            column.max = get<double>(data, footer_end, pos);
+            // Row count checked by division, so a corrupt count cannot wrap the byte size
+            const std::uint64_t type_size = column_type_size(m_columns[c].type);
+            if (column.offset % 8 != 0 || column.offset < RESULT_FILE_HEADER_SIZE ||
+                column.offset > footer_offset ||
+                info.rows > (footer_offset - column.offset) / type_size)
+                throw std::runtime_error("Invalid result file: column data out of range");
+        }
+        if (info.first_row != rows)
+            throw std::runtime_error("Invalid result file: chunks out of order");
+        rows += info.rows;
+        m_chunks.push_back(std::move(info));
+    }
+    if (rows != m_rows)
+        throw std::runtime_error("Invalid result file: row count mismatch");
+}
+
+auto ResultFileReader::find_column(const std::string& name) const -> int {
+    for (std::size_t c = 0; c < m_columns.size(); ++c)
+        if (m_columns[c].name == name)
+            return static_cast<int>(c);
+    return -1;
+}
+
+template <typename Out>
+auto ResultFileReader::gather(const std::string& name) const -> std::vector<Out> {
+    const int column = find_column(name);
+    if (column < 0)
+        throw std::invalid_argument("No such column: " + name);
+    std::vector<Out> out;
+    out.reserve(static_cast<std::size_t>(m_rows));
+    for (std::size_t k = 0; k < m_chunks.size(); ++k) {
+        const std::size_t rows = static_cast<std::size_t>(m_chunks[k].rows);
+        switch (m_columns[column].type) {
+            case ColumnType::Float64: {
+                const double* values = column_data<double>(column, k);
+                out.insert(out.end(), values, values + rows);
+                break;
+            }
+            case ColumnType::Int32: {
+                const std::int32_t* values = column_data<std::int32_t>(column, k);
+                out.insert(out.end(), values, values + rows);
+                break;
+            }
+            case ColumnType::UInt8: {
+                const std::uint8_t* values = column_data<std::uint8_t>(column, k);
+                out.insert(out.end(), values, values + rows);
+                break;
+            }
+        }
+    }
+    return out;
+}
+
+auto ResultFileReader::read_f64(const std::string& name) const -> std::vector<double> {
+    return gather<double>(name);
+}
+
+auto ResultFileReader::read_i32(const std::string& name) const -> std::vector<int> {
+    return gather<int>(name);
+}
+
+}  // namespace mathieu_lib
@@ -0,0 +1,291 @@
+// NOLINTBEGIN(readability-magic-numbers)
+
+/**
+ * @file space_charge.cpp
+ * @brief Mean-field space-charge shifts of q/a and a grid Poisson solver for the cloud field.
+ */
+#include "mathieu_lib/space_charge.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "Constants.h"
+#include "mathieu_factors.h"
+
+namespace mathieu_lib {
+
+/**
+ * @brief Linear field gradients inside a cloud.
+ *
+ * A uniform ellipse of semi-axes X, Y and line charge lambda has
+ * G_x = lambda / (pi eps0 X (X + Y)), and likewise for y. A Gaussian cloud is replaced by the
+ * uniform ellipse with the same second moments, X = 2 sigma_x (Sacherer's rms equivalence),
+ * which gives the right mean tune shift; its on-axis gradient is twice this.
+ *
+ * @throws std::invalid_argument for a negative ion count or a nonpositive length or size.
+ */
+auto space_charge_gradient(const IonCloud& cloud) -> SpaceChargeGradient {
+    if (!(cloud.ions >= 0.0))
+        throw std::invalid_argument("An ion cloud needs a nonnegative ion count");
+    if (!(cloud.length > 0.0) || !(cloud.size_x > 0.0) || !(cloud.size_y > 0.0))
+        throw std::invalid_argument("An ion cloud needs a positive length and size");
+    const double line_charge = cloud.ions * std::abs(cloud.charge_state) * E_CHARGE / cloud.length;
+    const double scale = cloud.profile == CloudProfile::Gaussian ? 2.0 : 1.0;
+    const double sx = scale * cloud.size_x;
+    const double sy = scale * cloud.size_y;
+    const double common = line_charge / (M_PI * EPSILON_0 * (sx + sy));
+    return SpaceChargeGradient{common / sx, common / sy};
+}
+
+auto space_charge_gradient(const std::vector<IonCloud>& clouds) -> SpaceChargeGradient {
+    SpaceChargeGradient total;
+    for (const IonCloud& cloud : clouds) {
+        const SpaceChargeGradient g = space_charge_gradient(cloud);
+        total.x += g.x;
+        total.y += g.y;
+    }
+    return total;
+}
+
+namespace {
+
+// Instrument factors times m/z: q, a and the space-charge shifts delta_x, delta_y
+struct ShiftFactors {
+    double q, a, dx, dy;
+};
+
+auto shift_factors(double voltage_rf, double voltage_dc, const QuadrupoleParams& params,
+                   const SpaceChargeGradient& gradient) -> ShiftFactors {
+    // A restoring gradient g enters a as 4 e g / (m Omega^2); space charge defocuses
+    const double omega_val = omega(params.frequency);
+    const double delta_per_g = 4.0 * E_CHARGE * AVOGADRO_NUMBER * 1000 / (omega_val * omega_val);
+    return ShiftFactors{q_times_mz<LinearQuadrupole>(voltage_rf, params),
+                        a_times_mz<LinearQuadrupole>(voltage_dc, params), delta_per_g * gradient.x,
+                        delta_per_g * gradient.y};
+}
+
+}  // namespace
+
+/**
+ * @brief q and the space-charge-shifted a_x, a_y for a column of ions given by m/z.
+ *
+ * @param voltage_rf RF voltage in volts.
+ * @param voltage_dc DC voltage in volts.
+ * @param params Struct containing frequency and quad_radius (molar_mass is ignored).
+ * @param gradient Cloud field gradients from space_charge_gradient().
+ * @param mzs Pointer to count m/z values in Da.
+ * @param count Number of ions.
+ * @param q, a_x, a_y Destinations for count values each.
+ */
+template <typename Real>
+void space_charge_qa_from_mz(double voltage_rf, double voltage_dc, const QuadrupoleParams& params,
+                             const SpaceChargeGradient& gradient, const Real* mzs,
+                             std::size_t count, Real* q, Real* a_x, Real* a_y) {
+    const ShiftFactors f = shift_factors(voltage_rf, voltage_dc, params, gradient);
+    const auto q_scale = static_cast<Real>(f.q);
+    const auto ax_scale = static_cast<Real>(f.a - f.dx);
+    const auto ay_scale = static_cast<Real>(f.a + f.dy);
+    for (std::size_t i = 0; i < count; ++i) {
+        const Real inverse = Real(1) / mzs[i];
+        q[i] = q_scale * inverse;
+        a_x[i] = ax_scale * inverse;
+        a_y[i] = ay_scale * inverse;
+    }
+}
+template void space_charge_qa_from_mz<float>(double, double, const QuadrupoleParams&,
+                                             const SpaceChargeGradient&, const float*,
+                                             std::size_t, float*, float*, float*);
+template void space_charge_qa_from_mz<double>(double, double, const QuadrupoleParams&,
+                                              const SpaceChargeGradient&, const double*,
+                                              std::size_t, double*, double*, double*);
+
+/**
+ * @brief Stability class of each ion in the shifted diagram: X from (q, a_x), Y from (q, a_y).
+ *
+ * Ions are taken in blocks so that both lookups go through the batch classify_stability().
+ */
+template <typename Real>
+void classify_space_charge_from_mz(double voltage_rf, double voltage_dc,
+                                   const QuadrupoleParams& params,
+                                   const SpaceChargeGradient& gradient, const Real* mzs,
+                                   std::size_t count, StabilityClass* out) {
+    constexpr std::size_t BLOCK = 256;
+    std::array<Real, BLOCK> qs{};
+    std::array<Real, BLOCK> axs{};
+    std::array<Real, BLOCK> ays{};
+    std::array<StabilityClass, BLOCK> x_classes{};
+    std::array<StabilityClass, BLOCK> y_classes{};
+    for (std::size_t start = 0; start < count; start += BLOCK) {
+        const std::size_t n = std::min(BLOCK, count - start);
+        space_charge_qa_from_mz(voltage_rf, voltage_dc, params, gradient, mzs + start, n,
+                                qs.data(), axs.data(), ays.data());
+        classify_stability(qs.data(), axs.data(), n, x_classes.data());
+        classify_stability(qs.data(), ays.data(), n, y_classes.data());
+        for (std::size_t i = 0; i < n; ++i)
+            out[start + i] = merge_stability(x_classes[i], y_classes[i]);
+    }
+}
+template void classify_space_charge_from_mz<float>(double, double, const QuadrupoleParams&,
+                                                   const SpaceChargeGradient&, const float*,
+                                                   std::size_t, StabilityClass*);
+template void classify_space_charge_from_mz<double>(double, double, const QuadrupoleParams&,
+                                                    const SpaceChargeGradient&, const double*,
+                                                    std::size_t, StabilityClass*);
+
+auto space_charge_qa_from_mz(double voltage_rf, double voltage_dc, const QuadrupoleParams& params,
+                             const SpaceChargeGradient& gradient, const std::vector<double>& mzs)
+    -> SpaceChargeColumns {
+    SpaceChargeColumns result;
+    const std::size_t count = mzs.size();
+    result.q.resize(count);
+    result.a_x.resize(count);
+    result.a_y.resize(count);
+    result.stability.resize(count);
+    space_charge_qa_from_mz(voltage_rf, voltage_dc, params, gradient, mzs.data(), count,
+                            result.q.data(), result.a_x.data(), result.a_y.data());
+    classify_space_charge_from_mz(voltage_rf, voltage_dc, params, gradient, mzs.data(), count,
+                                  result.stability.data());
+    return result;
+}
+
+/**
+ * @brief Grid of `nodes` interior nodes per direction over |x|, |y| <= half_width.
+ *
+ * The sine modes sin(i k pi / (N + 1)) diagonalize the 5-point Laplacian with a grounded
+ * boundary, with eigenvalues -mu_kl = -(4 / d^2) (sin^2(k pi / 2(N + 1)) +
+ * sin^2(l pi / 2(N + 1))); the transform is its own inverse up to (2 / (N + 1))^2.
+ *
+ * @throws std::invalid_argument if half_width is not positive or nodes < 2.
+ */
+SpaceChargeGrid::SpaceChargeGrid(double half_width, std::size_t nodes)
+    : m_half_width(half_width),
+      m_nodes(nodes),
+      m_spacing(2.0 * half_width / static_cast<double>(nodes + 1)) {
+    if (!(half_width > 0.0))
+        throw std::invalid_argument("A space-charge grid needs a positive half width");
+    if (nodes < 2)
+        throw std::invalid_argument("A space-charge grid needs at least two nodes");
+    const std::size_t n = nodes;
+    const double angle = M_PI / static_cast<double>(n + 1);
+    m_sine.resize(n * n);
+    std::vector<double> half_sine_squared(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t k = 0; k < n; ++k)
+            m_sine[i * n + k] = std::sin(static_cast<double>((i + 1) * (k + 1)) * angle);
+        const double s = std::sin(0.5 * static_cast<double>(i + 1) * angle);
+        half_sine_squared[i] = s * s;
+    }
+    const double norm = 4.0 / static_cast<double>((n + 1) * (n + 1));
+    m_inverse.resize(n * n);
+    for (std::size_t k = 0; k < n; ++k) {
+        for (std::size_t l = 0; l < n; ++l) {
+            const double mu =
+                4.0 / (m_spacing * m_spacing) * (half_sine_squared[k] + half_sine_squared[l]);
+            m_inverse[k * n + l] = norm / (EPSILON_0 * mu);
+        }
+    }
+    m_charge.assign((n + 2) * (n + 2), 0.0);
+    m_ex.assign((n + 2) * (n + 2), 0.0);
+    m_ey.assign((n + 2) * (n + 2), 0.0);
+}
+
+void SpaceChargeGrid::clear() { std::fill(m_charge.begin(), m_charge.end(), 0.0); }
+
+void SpaceChargeGrid::deposit(double x, double y, double charge_per_length) {
+    const double sx = (x + m_half_width) / m_spacing;
+    const double sy = (y + m_half_width) / m_spacing;
+    const auto last = static_cast<double>(m_nodes + 1);
+    if (!(sx >= 0.0 && sx < last && sy >= 0.0 && sy < last))
+        return;
+    const auto i = static_cast<std::size_t>(sx);
+    const auto j = static_cast<std::size_t>(sy);
+    const double fx = sx - static_cast<double>(i);
+    const double fy = sy - static_cast<double>(j);
+    const std::size_t row = m_nodes + 2;
+    double* node = &m_charge[i * row + j];
+    node[0] += (1.0 - fx) * (1.0 - fy) * charge_per_length;
+    node[1] += (1.0 - fx) * fy * charge_per_length;
+    node[row] += fx * (1.0 - fy) * charge_per_length;
+    node[row + 1] += fx * fy * charge_per_length;
+}
+
+void SpaceChargeGrid::sine_transform(std::vector<double>& grid) const {
+    const std::size_t n = m_nodes;
+    std::vector<double> scratch(n * n, 0.0);
+    // Along the first index, then along the second
+    for (std::size_t k = 0; k < n; ++k) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const double s = m_sine[k * n + i];
+            for (std::size_t j = 0; j < n; ++j) scratch[k * n + j] += s * grid[i * n + j];
+        }
+    }
+    for (std::size_t k = 0; k < n; ++k) {
+        for (std::size_t l = 0; l < n; ++l) {
+            double sum = 0.0;
+            for (std::size_t j = 0; j < n; ++j) sum += scratch[k * n + j] * m_sine[j * n + l];
+            grid[k * n + l] = sum;
+        }
+    }
+}
+
+void SpaceChargeGrid::solve() {
+    const std::size_t n = m_nodes;
+    const std::size_t row = n + 2;
+    const double area = m_spacing * m_spacing;
+    std::vector<double> grid(n * n);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < n; ++j)
+            grid[i * n + j] = m_charge[(i + 1) * row + j + 1] / area;
+    }
+    sine_transform(grid);
+    for (std::size_t k = 0; k < n * n; ++k) grid[k] *= m_inverse[k];
+    sine_transform(grid);
+
+    std::vector<double> potential(row * row, 0.0);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < n; ++j) potential[(i + 1) * row + j + 1] = grid[i * n + j];
+    }
+    // Central differences inside, one-sided on the boundary
+    for (std::size_t i = 0; i < row; ++i) {
+        const std::size_t lo = i == 0 ? 0 : i - 1;
+        const std::size_t hi = i + 1 == row ? i : i + 1;
+        for (std::size_t j = 0; j < row; ++j) {
+            const std::size_t left = j == 0 ? 0 : j - 1;
+            const std::size_t right = j + 1 == row ? j : j + 1;
+            m_ex[i * row + j] = -(potential[hi * row + j] - potential[lo * row + j]) /
+                                (static_cast<double>(hi - lo) * m_spacing);
+            m_ey[i * row + j] = -(potential[i * row + right] - potential[i * row + left]) /
+                                (static_cast<double>(right - left) * m_spacing);
+        }
+    }
+}
+
+void SpaceChargeGrid::field(const double* x, const double* y, std::size_t count, double* ex,
+                            double* ey) const {
+    const std::size_t row = m_nodes + 2;
+    const double top = static_cast<double>(m_nodes);
+    for (std::size_t p = 0; p < count; ++p) {
+        const double sx = std::clamp((x[p] + m_half_width) / m_spacing, 0.0, top + 1.0);
+        const double sy = std::clamp((y[p] + m_half_width) / m_spacing, 0.0, top + 1.0);
+        const double i = std::min(std::floor(sx), top);
+        const double j = std::min(std::floor(sy), top);
+        const double fx = sx - i;
+        const double fy = sy - j;
+        const std::size_t at = static_cast<std::size_t>(i) * row + static_cast<std::size_t>(j);
+        const double w00 = (1.0 - fx) * (1.0 - fy);
+        const double w01 = (1.0 - fx) * fy;
+        const double w10 = fx * (1.0 - fy);
+        const double w11 = fx * fy;
+        ex[p] = w00 * m_ex[at] + w01 * m_ex[at + 1] + w10 * m_ex[at + row] +
+                w11 * m_ex[at + row + 1];
+        ey[p] = w00 * m_ey[at] + w01 * m_ey[at + 1] + w10 * m_ey[at + row] +
+                w11 * m_ey[at + row + 1];
+    }
+}
+
+}  // namespace mathieu_lib
+
+// NOLINTEND(readability-magic-numbers)
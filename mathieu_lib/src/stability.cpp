@@ -0,0 +1,308 @@
+// NOLINTBEGIN(readability-magic-numbers)
+
+/**
+ * @file stability.cpp
+ * @brief Upper boundary of the first stability region and distances to it.
+ */
+#include "mathieu_lib/stability.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "Constants.h"
+#include "mathieu_lib/boundary_lut.h"
+
+namespace mathieu_lib {
+
+namespace {
+
+/**
+ * @brief a_0 and b_1 at |q|: interpolated from the boundary tables up to MAX_Q, where the
+ *        region of joint stability ends, and from the Chebyshev/exact path beyond.
+ *
+ * a_0 <= 0 is enforced so that the x and y bands always meet on the q axis inside MAX_Q,
+ * consistent with the clamp in upper_boundary().
+ */
+template <typename Real>
+void first_band(Real q, Real& a0, Real& b1) {
+    q = std::abs(q);
+    if (q <= Real(MAX_Q)) {
+        Real minus_a0 = 0;
+        boundary_lut_curves(q, minus_a0, b1);
+        a0 = std::min(-minus_a0, Real(0));
+    } else {
+        a0 = std::min(characteristic_a0(q), Real(0));
+        b1 = characteristic_b1(q);
+    }
+}
+
+/**
+ * @brief Lower and upper a of the first region of `Geometry` at 0 <= q <= FIRST_REGION_Q_MAX.
+ *
+ * For the linear quadrupole this is [0, min(-a_0, b_1)], one table lookup. Otherwise the
+ * secondary band [a_0, b_1](|k| q) is mapped back through a = a_s / k (k < 0 swaps its ends)
+ * and intersected with the primary band.
+ */
+template <typename Real, typename Geometry>
+void first_region(Real q, Real& lower, Real& upper) {
+    if constexpr (Geometry::SECONDARY_RATIO == -1.0) {
+        lower = Real(0);
+        upper = boundary_lut_upper(q);
+    } else {
+        constexpr Real k = Real(Geometry::SECONDARY_RATIO);
+        Real a0 = 0;
+        Real b1 = 0;
+        Real a0_s = 0;
+        Real b1_s = 0;
+        first_band(q, a0, b1);
+        first_band(k * q, a0_s, b1_s);
+        lower = std::max(a0, b1_s / k);
+        upper = std::min(b1, a0_s / k);
+    }
+}
+
+}  // namespace
+
+/**
+ * @brief Evaluates the upper boundary a(q) of the first stability region.
+ *
+ * For the linear quadrupole the boundary is min(-a_0(q), b_1(q)): -a_0 on the rising flank up
+ * to the apex near (0.706, 0.237) and b_1 down to its zero at MAX_Q. Both curves are read from
+ * the compile-time tables of boundary_lut.h by cubic Hermite interpolation, entirely in `Real`.
+ * For the Paul trap it is min(b_1(q_z), -2 a_0(q_z / 2)), with the apex near (0.781, 0.150).
+ *
+ * @param q The Mathieu q parameter (q_z for the Paul trap).
+ * @return Boundary a value, or 0 outside [0, FIRST_REGION_Q_MAX].
+ */
+template <typename Real, typename Geometry>
+auto upper_boundary(Real q) -> Real {
+    if (!(q >= Real(0) && q <= Real(Geometry::FIRST_REGION_Q_MAX)))
+        return Real(0);
+    Real lower = 0;
+    Real upper = 0;
+    first_region<Real, Geometry>(q, lower, upper);
+    return upper;
+}
+template auto upper_boundary<float, LinearQuadrupole>(float) -> float;
+template auto upper_boundary<double, LinearQuadrupole>(double) -> double;
+template auto upper_boundary<float, PaulTrap3D>(float) -> float;
+template auto upper_boundary<double, PaulTrap3D>(double) -> double;
+
+/**
+ * @brief Evaluates the lower boundary a(q) of the first stability region: the q axis for the
+ *        linear quadrupole, max(a_0(q_z), -2 b_1(q_z / 2)) for the Paul trap.
+ */
+template <typename Real, typename Geometry>
+auto lower_boundary(Real q) -> Real {
+    if (!(q >= Real(0) && q <= Real(Geometry::FIRST_REGION_Q_MAX)))
+        return Real(0);
+    Real lower = 0;
+    Real upper = 0;
+    first_region<Real, Geometry>(q, lower, upper);
+    return lower;
+}
+template auto lower_boundary<float, LinearQuadrupole>(float) -> float;
+template auto lower_boundary<double, LinearQuadrupole>(double) -> double;
+template auto lower_boundary<float, PaulTrap3D>(float) -> float;
+template auto lower_boundary<double, PaulTrap3D>(double) -> double;
+
+/**
+ * @brief Whether (q, a) lies inside the first stability region (for the linear quadrupole,
+ *        its a >= 0 half).
+ */
+template <typename Real, typename Geometry>
+auto is_stable(Real q, Real a) -> bool {
+    if (!(q >= Real(0) && q <= Real(Geometry::FIRST_REGION_Q_MAX)))
+        return false;
+    Real lower = 0;
+    Real upper = 0;
+    first_region<Real, Geometry>(q, lower, upper);
+    return a >= lower && a <= upper;
+}
+template auto is_stable<float, LinearQuadrupole>(float, float) -> bool;
+template auto is_stable<double, LinearQuadrupole>(double, double) -> bool;
+template auto is_stable<float, PaulTrap3D>(float, float) -> bool;
+template auto is_stable<double, PaulTrap3D>(double, double) -> bool;
+
+/**
+ * @brief Classifies a column of (q, a) points.
+ *
+ * The table lookup clamps q, so it runs unconditionally and the range and boundary tests
+ * are combined without short-circuiting; the only data-dependent work is the table load.
+ * The geometry is fixed at compile time, so nothing is dispatched per point. The result
+ * agrees exactly with the scalar classifier.
+ */
+template <typename Real, typename Geometry>
+void is_stable(const Real* qs, const Real* as, std::size_t count, std::uint8_t* out) {
+    constexpr Real q_max = Real(Geometry::FIRST_REGION_Q_MAX);
+    for (std::size_t i = 0; i < count; ++i) {
+        const Real q = qs[i];
+        const Real a = as[i];
+        Real lower = 0;
+        Real upper = 0;
+        // Clamped into [0, q_max], NaN to 0, so that far-out and non-finite points never reach
+        // the exact solver or index the tables out of range; they fail in_range
+        first_region<Real, Geometry>(q > Real(0) ? std::min(q, q_max) : Real(0), lower, upper);
+        // Non-short-circuit & keeps the body free of branches
+        const bool in_range = (q >= Real(0)) & (q <= q_max);
+        out[i] = static_cast<std::uint8_t>(in_range & (a >= lower) & (a <= upper));
+    }
+}
+template void is_stable<float, LinearQuadrupole>(const float*, const float*, std::size_t,
+                                                std::uint8_t*);
+template void is_stable<double, LinearQuadrupole>(const double*, const double*, std::size_t,
+                                                 std::uint8_t*);
+template void is_stable<float, PaulTrap3D>(const float*, const float*, std::size_t,
+                                          std::uint8_t*);
+template void is_stable<double, PaulTrap3D>(const double*, const double*, std::size_t,
+                                           std::uint8_t*);
+
+namespace {
+
+/**
+ * @brief Stability bits from the primary band [a0, b1] at a and the secondary band
+ *        [a0_s, b1_s] at the secondary a_s.
+ */
+template <typename Real>
+auto classify_in_bands(Real a0, Real b1, Real a, Real a0_s, Real b1_s, Real a_s)
+    -> StabilityClass {
+    const bool x = (a >= a0) & (a <= b1);
+    const bool y = (a_s >= a0_s) & (a_s <= b1_s);
+    return make_stability_class(x, y);
+}
+
+}  // namespace
+
+/**
+ * @brief Classifies (q, a) against the four curves bounding the first stability region:
+ *        a_0 and b_1 of the primary direction (beta = 0 and 1) and of the secondary one,
+ *        evaluated at k q and compared with k a for k = SECONDARY_RATIO. For the linear
+ *        quadrupole (k = -1) one band serves both directions.
+ *
+ * Boundaries count as stable, as in is_stable(); for 0 <= q <= FIRST_REGION_Q_MAX (and a >= 0
+ * for the linear quadrupole) the result is Both exactly when is_stable() holds. NaN inputs,
+ * and q that is infinite or beyond EXACT_SOLVER_Q_MAX, classify as None.
+ */
+template <typename Real, typename Geometry>
+auto classify_stability(Real q, Real a) -> StabilityClass {
+    // NaN, infinite and absurdly large q never reach the exact solver behind first_band()
+    if (!(std::abs(q) <= Real(EXACT_SOLVER_Q_MAX)))
+        return StabilityClass::None;
+    constexpr Real k = Real(Geometry::SECONDARY_RATIO);
+    Real a0 = 0;
+    Real b1 = 0;
+    first_band(q, a0, b1);
+    Real a0_s = a0;
+    Real b1_s = b1;
+    if constexpr (Geometry::SECONDARY_RATIO != -1.0)
+        first_band(k * q, a0_s, b1_s);
+    return classify_in_bands(a0, b1, a, a0_s, b1_s, k * a);
+}
+template auto classify_stability<float, LinearQuadrupole>(float, float) -> StabilityClass;
+template auto classify_stability<double, LinearQuadrupole>(double, double) -> StabilityClass;
+template auto classify_stability<float, PaulTrap3D>(float, float) -> StabilityClass;
+template auto classify_stability<double, PaulTrap3D>(double, double) -> StabilityClass;
+
+/**
+ * @brief Classifies a column of (q, a) points; identical to the scalar form point by point.
+ *
+ * Points with |q| <= MAX_Q, the common case, cost one table lookup each (two for the Paul
+ * trap), so a million points classify in a few milliseconds.
+ */
+template <typename Real, typename Geometry>
+void classify_stability(const Real* qs, const Real* as, std::size_t count, StabilityClass* out) {
+    for (std::size_t i = 0; i < count; ++i)
+        out[i] = classify_stability<Real, Geometry>(qs[i], as[i]);
+}
+template void classify_stability<float, LinearQuadrupole>(const float*, const float*, std::size_t,
+                                                         StabilityClass*);
+template void classify_stability<double, LinearQuadrupole>(const double*, const double*,
+                                                          std::size_t, StabilityClass*);
+template void classify_stability<float, PaulTrap3D>(const float*, const float*, std::size_t,
+                                                   StabilityClass*);
+template void classify_stability<double, PaulTrap3D>(const double*, const double*, std::size_t,
+                                                    StabilityClass*);
+
+namespace {
+
+/**
+ * @brief Boundary values at the BOUNDARY_LUT grid nodes, the vertices of the polyline that
+ *        nearest-point queries scan. Built at compile time like the table itself.
+ */
+constexpr auto make_boundary_nodes() -> std::array<double, BOUNDARY_LUT_SEGMENTS + 1> {
+    std::array<double, BOUNDARY_LUT_SEGMENTS + 1> nodes{};
+    for (int i = 0; i <= BOUNDARY_LUT_SEGMENTS; ++i)
+        nodes[i] = std::max(std::min(BOUNDARY_LUT[i].minus_a0, BOUNDARY_LUT[i].b1), 0.0);
+    return nodes;
+}
+constexpr std::array<double, BOUNDARY_LUT_SEGMENTS + 1> BOUNDARY_NODES = make_boundary_nodes();
+
+// Node segment holding q, clamped to [0, BOUNDARY_LUT_SEGMENTS] in double before the cast so
+// huge and non-finite q stay defined; NaN maps to 0
+auto node_segment(double q) -> int {
+    const double segment = std::floor(q / BOUNDARY_LUT_STEP);
+    if (!(segment > 0.0))
+        return 0;
+    return static_cast<int>(std::min(segment, static_cast<double>(BOUNDARY_LUT_SEGMENTS)));
+}
+
+}  // namespace
+
+/**
+ * @brief Finds the point on the upper boundary closest to (q, a).
+ *
+ * Scans only the few segments of the node polyline that can contain the answer instead of
+ * re-evaluating the boundary thousands of times.
+ *
+ * @param q The Mathieu q parameter.
+ * @param a The Mathieu a parameter.
+ * @return (q_b, a_b) on the boundary, with q_b in [0, MAX_Q].
+ */
+auto nearest_boundary_point(double q, double a) -> std::pair<double, double> {
+    constexpr double step = BOUNDARY_LUT_STEP;
+    // The vertical drop to the curve bounds the true distance, which limits the q window
+    // that has to be scanned.
+    double q_clamped = std::clamp(q, 0.0, MAX_Q);
+    double bound = std::hypot(q - q_clamped, a - upper_boundary(q_clamped));
+    int first = std::max(0, node_segment(q - bound) - 1);
+    int last = std::min(BOUNDARY_LUT_SEGMENTS - 1, node_segment(q + bound) + 1);
+    double min_dist_sq = std::numeric_limits<double>::max();
+    double best_q = q_clamped;
+    for (int i = first; i <= last; ++i) {
+        const double q_i = step * i;
+        const double a_i = BOUNDARY_NODES[i];
+        const double da = BOUNDARY_NODES[i + 1] - a_i;
+        double t = ((q - q_i) * step + (a - a_i) * da) / (step * step + da * da);
+        t = std::clamp(t, 0.0, 1.0);
+        double q_s = q_i + t * step;
+        double a_s = a_i + t * da;
+        double dist_sq = (q - q_s) * (q - q_s) + (a - a_s) * (a - a_s);
+        if (dist_sq < min_dist_sq) {
+            min_dist_sq = dist_sq;
+            best_q = q_s;
+        }
+    }
+    // Snap back onto the exact curve so on-boundary points stay self-consistent.
+    return {best_q, upper_boundary(best_q)};
+}
+
+/**
+ * @brief Stability state and distances from (q, a) to the nearest upper-boundary point.
+ */
+auto boundary_margins(double q, double a) -> BoundaryMargins {
+    BoundaryMargins margins{};
+    margins.stable = is_stable(q, a);
+    auto [q_b, a_b] = nearest_boundary_point(q, a);
+    margins.q_boundary = q_b;
+    margins.a_boundary = a_b;
+    margins.delta_a = a_b - a;
+    margins.delta_q = std::abs(q_b - q);
+    margins.delta_e = std::sqrt((q - q_b) * (q - q_b) + (a - a_b) * (a - a_b));
+    return margins;
+}
+
+}  // namespace mathieu_lib
+
+// NOLINTEND(readability-magic-numbers)
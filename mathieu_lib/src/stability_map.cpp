@@ -0,0 +1,72 @@
+/**
+ * @file stability_map.cpp
+ * @brief Parallel, progressive rasterization of the stability margin over a (q, a) grid.
+ */
+#include "mathieu_lib/stability_map.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "mathieu_lib/stability.h"
+
+namespace mathieu_lib {
+
+auto StabilityMapSpec::cell_q(std::size_t column) const -> double {
+    return q_cells <= 1 ? q_min : q_min + (q_max - q_min) * column / (q_cells - 1);
+}
+
+auto StabilityMapSpec::cell_a(std::size_t row) const -> double {
+    return a_cells <= 1 ? a_min : a_min + (a_max - a_min) * row / (a_cells - 1);
+}
+
+/**
+ * @brief Evaluates boundary_margins() for every grid cell, band by band on the thread pool.
+ *
+ * Each finished band is passed to options.on_rows straight away, so a viewer can paint the
+ * map while the remaining bands are still being computed.
+ *
+ * @throws std::invalid_argument if the grid is empty or a range is reversed.
+ */
+auto rasterize_stability(const StabilityMapSpec& spec, const StabilityMapOptions& options)
+    -> StabilityMap {
+    if (spec.q_cells == 0 || spec.a_cells == 0)
+        throw std::invalid_argument("Stability map needs at least one cell per axis");
+    if (spec.q_max < spec.q_min || spec.a_max < spec.a_min)
+        throw std::invalid_argument("Stability map range is reversed");
+
+    StabilityMap map;
+    map.spec = spec;
+    map.margin.assign(spec.cell_count(), std::numeric_limits<double>::quiet_NaN());
+    const std::size_t band_rows = std::max<std::size_t>(options.band_rows, 1);
+    const std::size_t bands = spec.a_cells / band_rows + (spec.a_cells % band_rows != 0 ? 1 : 0);
+
+    ProgressReporter reporter(options.progress, spec.a_cells);
+    ThreadPool& pool = options.pool ? *options.pool : ThreadPool::global();
+    ParallelForOptions loop;
+    loop.grain = 1;
+    loop.cancel = options.cancel;
+    pool.parallel_for(0, bands, [&](std::size_t first, std::size_t last) {
+        for (std::size_t band = first; band < last; ++band) {
+            const std::size_t row_begin = band * band_rows;
+            const std::size_t rows = std::min(band_rows, spec.a_cells - row_begin);
+            double* out = map.margin.data() + row_begin * spec.q_cells;
+            for (std::size_t row = 0; row < rows; ++row) {
+                const double a = spec.cell_a(row_begin + row);
+                for (std::size_t column = 0; column < spec.q_cells; ++column) {
+                    const BoundaryMargins margins = boundary_margins(spec.cell_q(column), a);
+                    out[row * spec.q_cells + column] =
+                        margins.stable ? margins.delta_e : -margins.delta_e;
+                }
+            }
+            if (options.on_rows)
+                reporter.advance(rows, [&]() { options.on_rows(row_begin, rows, out); });
+            else
+                reporter.advance(rows);
+        }
+    }, loop);
+    map.complete = reporter.done() == spec.a_cells;
+    return map;
+}
+
+}  // namespace mathieu_lib
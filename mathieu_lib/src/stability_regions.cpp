@@ -0,0 +1,225 @@
+// NOLINTBEGIN(readability-magic-numbers)
+
+/**
+ * @file stability_regions.cpp
+ * @brief Stability regions of any order from the exact characteristic-value curves.
+ */
+#include "mathieu_lib/stability_regions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "mathieu_lib/characteristic.h"
+
+namespace mathieu_lib {
+
+namespace {
+
+constexpr int BISECTION_STEPS = 50;
+
+struct Bounds {
+    double lower;
+    double upper;
+
+    auto open() const -> bool { return lower <= upper; }
+};
+
+// a bounds of region `id` at q >= 0
+auto region_bounds(RegionId id, double q) -> Bounds {
+    const double lower = std::max(characteristic_a(id.x_order, q),
+                                  -characteristic_b(id.y_order + 1, q));
+    const double upper = std::min(characteristic_b(id.x_order + 1, q),
+                                  -characteristic_a(id.y_order, q));
+    return {lower, upper};
+}
+
+/**
+ * @brief Where the region closes between q_open (bounds ordered) and q_closed (crossed): the
+ *        point at which lower and upper meet, by bisection.
+ */
+auto closing_point(RegionId id, double q_open, double q_closed) -> std::pair<double, double> {
+    for (int step = 0; step < BISECTION_STEPS; ++step) {
+        const double mid = 0.5 * (q_open + q_closed);
+        if (region_bounds(id, mid).open())
+            q_open = mid;
+        else
+            q_closed = mid;
+    }
+    const Bounds bounds = region_bounds(id, q_open);
+    return {q_open, 0.5 * (bounds.lower + bounds.upper)};
+}
+
+}  // namespace
+
+/**
+ * @brief Finds the band of each motion that contains (q, a), scanning bands upwards from 0.
+ *
+ * The bands of one motion are disjoint and ordered in a, so the scan stops at the first band
+ * whose lower edge lies above a.
+ */
+auto locate_stability_region(double q, double a, int max_order) -> RegionId {
+    q = std::abs(q);
+    auto band_of = [q, max_order](double value) {
+        for (int r = 0; r <= max_order; ++r) {
+            if (value < characteristic_a(r, q))
+                return -1;
+            if (value <= characteristic_b(r + 1, q))
+                return r;
+        }
+        return -1;
+    };
+    return {band_of(a), band_of(-a)};
+}
+
+/**
+ * @throws std::invalid_argument if q_max is not positive or there are fewer than two samples.
+ */
+StabilityRegionCache::StabilityRegionCache(double q_max, std::size_t samples)
+    : m_q_max(q_max), m_samples(samples) {
+    if (!(q_max > 0.0))
+        throw std::invalid_argument("Stability regions need q_max > 0");
+    if (samples < 2)
+        throw std::invalid_argument("Stability regions need at least two q samples");
+}
+
+auto StabilityRegionCache::cached_count() const -> std::size_t {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_regions.size();
+}
+
+/**
+ * @brief Returns the cached curve, sampling it on the q grid in parallel first if needed.
+ */
+auto StabilityRegionCache::curve(bool sine, int order, const StabilityRegionOptions& options)
+    -> Curve {
+    const std::pair<bool, int> key(sine, order);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto found = m_curves.find(key);
+        if (found != m_curves.end())
+            return found->second;
+    }
+    auto values = std::make_shared<std::vector<double>>(m_samples);
+    ThreadPool& pool = options.pool ? *options.pool : ThreadPool::global();
+    ParallelForOptions loop;
+    loop.cancel = options.cancel;
+    const bool finished = pool.parallel_for(0, m_samples, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            const double q = grid_q(i);
+            (*values)[i] = sine ? characteristic_b(order, q) : characteristic_a(order, q);
+        }
+    }, loop);
+    if (!finished)
+        return nullptr;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_curves.emplace(key, std::move(values)).first->second;
+}
+
+/**
+ * @brief Combines the four bounding curves on the q grid, splits the grid into the spans
+ *        where the bounds are ordered and closes each span at its exact tips.
+ */
+auto StabilityRegionCache::compute(RegionId id, const StabilityRegionOptions& options)
+    -> std::shared_ptr<const StabilityRegion> {
+    const Curve x_lower = curve(false, id.x_order, options);
+    const Curve x_upper = curve(true, id.x_order + 1, options);
+    const Curve y_lower = curve(false, id.y_order, options);
+    const Curve y_upper = curve(true, id.y_order + 1, options);
+    if (!x_lower || !x_upper || !y_lower || !y_upper)
+        return nullptr;
+    std::vector<Bounds> grid(m_samples);
+    for (std::size_t i = 0; i < m_samples; ++i)
+        grid[i] = {std::max((*x_lower)[i], -(*y_upper)[i]),
+                   std::min((*x_upper)[i], -(*y_lower)[i])};
+
+    auto region = std::make_shared<StabilityRegion>();
+    region->id = id;
+    for (std::size_t i = 0; i < m_samples;) {
+        if (!grid[i].open()) {
+            ++i;
+            continue;
+        }
+        RegionSpan span;
+        if (i > 0) {
+            const auto [q, a] = closing_point(id, grid_q(i), grid_q(i - 1));
+            span.q.push_back(q);
+            span.a_lower.push_back(a);
+            span.a_upper.push_back(a);
+        }
+        for (; i < m_samples && grid[i].open(); ++i) {
+            span.q.push_back(grid_q(i));
+            span.a_lower.push_back(grid[i].lower);
+            span.a_upper.push_back(grid[i].upper);
+        }
+        if (i < m_samples) {
+            const auto [q, a] = closing_point(id, grid_q(i - 1), grid_q(i));
+            span.q.push_back(q);
+            span.a_lower.push_back(a);
+            span.a_upper.push_back(a);
+        }
+        region->spans.push_back(std::move(span));
+    }
+    return region;
+}
+
+/**
+ * @brief Returns the cached region, computing it first if needed.
+ *
+ * Two threads asking for the same missing region or curve may both compute it; the first
+ * result is kept. Cancelled computations are not cached.
+ *
+ * @throws std::invalid_argument for a negative band order.
+ */
+auto StabilityRegionCache::region(RegionId id, const StabilityRegionOptions& options)
+    -> std::shared_ptr<const StabilityRegion> {
+    if (id.x_order < 0 || id.y_order < 0)
+        throw std::invalid_argument("Stability region orders must be >= 0");
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto found = m_regions.find(id);
+        if (found != m_regions.end())
+            return found->second;
+    }
+    std::shared_ptr<const StabilityRegion> computed = compute(id, options);
+    if (!computed)
+        return nullptr;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_regions.emplace(id, std::move(computed)).first->second;
+}
+
+auto StabilityRegionCache::regions(int max_order, const StabilityRegionOptions& options)
+    -> std::vector<std::shared_ptr<const StabilityRegion>> {
+    std::vector<RegionId> ids;
+    for (int r = 0; r <= max_order; ++r)
+        for (int s = 0; s <= max_order; ++s) ids.push_back({r, s});
+
+    ThreadPool& pool = options.pool ? *options.pool : ThreadPool::global();
+    ParallelForOptions loop;
+    loop.grain = 1;
+    loop.cancel = options.cancel;
+    // Sample every bounding curve first (a_0..a_N and b_1..b_N+1), one task per curve, so that
+    // no two regions race to compute a shared curve
+    const std::size_t curves = 2 * static_cast<std::size_t>(max_order + 1);
+    pool.parallel_for(0, curves, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            const bool sine = i % 2 == 1;
+            curve(sine, static_cast<int>(i / 2) + (sine ? 1 : 0), options);
+        }
+    }, loop);
+
+    std::vector<std::shared_ptr<const StabilityRegion>> found(ids.size());
+    pool.parallel_for(0, ids.size(), [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) found[i] = region(ids[i], options);
+    }, loop);
+
+    std::vector<std::shared_ptr<const StabilityRegion>> result;
+    for (auto& region : found)
+        if (region && !region->spans.empty())
+            result.push_back(std::move(region));
+    return result;
+}
+
+}  // namespace mathieu_lib
+
+// NOLINTEND(readability-magic-numbers)
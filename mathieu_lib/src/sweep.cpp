@@ -0,0 +1,293 @@
+/**
+ * @file sweep.cpp
+ * @brief Chunked, checkpointed parameter sweeps over the batch kernels.
+ *
+ * A sweep directory holds a manifest describing the sweep and one result file per finished
+ * chunk. Chunks are written to a temporary name and renamed into place, so a chunk file that
+ * exists is complete; a restarted sweep only computes the chunks that are missing.
+ * Alternatively a sweep is split into shards that fill one preallocated result file in place.
+ */
+#include "mathieu_lib/sweep.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "mathieu_lib/mathieu.h"
+#include "mathieu_lib/stability.h"
+
+namespace mathieu_lib {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr const char* MANIFEST_NAME = "sweep.manifest";
+
+template <typename T>
+void append_axis(std::string& out, const char* name, const std::vector<T>& values) {
+    out += name;
+    for (T value : values) {
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out += ' ';
+        out.append(buffer, result.ptr);
+    }
+    out += '\n';
+}
+
+/**
+ * @brief Exact textual identity of a sweep; resuming requires an identical manifest.
+ */
+auto manifest_text(const SweepSpec& spec, std::uint64_t chunk_points) -> std::string {
+    std::string out = "trappable-sweep 1\nchunk_points " + std::to_string(chunk_points) + "\n";
+    append_axis(out, "frequency", spec.frequency);
+    append_axis(out, "quad_radius", spec.quad_radius);
+    append_axis(out, "voltage_rf", spec.voltage_rf);
+    append_axis(out, "voltage_dc", spec.voltage_dc);
+    append_axis(out, "charge_state", spec.charge_state);
+    append_axis(out, "mass", spec.mass);
+    return out;
+}
+
+void write_file_atomically(const fs::path& path, const std::string& text) {
+    const fs::path tmp = path.string() + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        if (!(out << text))
+            throw std::runtime_error("Cannot write file: " + tmp.string());
+    }
+    fs::rename(tmp, path);
+}
+
+void prepare_directory(const SweepSpec& spec, const fs::path& directory,
+                       std::uint64_t chunk_points) {
+    fs::create_directories(directory);
+    const fs::path manifest = directory / MANIFEST_NAME;
+    const std::string expected = manifest_text(spec, chunk_points);
+    if (fs::exists(manifest)) {
+        std::ifstream in(manifest, std::ios::binary);
+        const std::string existing((std::istreambuf_iterator<char>(in)),
+                                   std::istreambuf_iterator<char>());
+        if (existing != expected)
+            throw std::runtime_error("Sweep directory holds a different sweep: " +
+                                     directory.string());
+    } else {
+        write_file_atomically(manifest, expected);
+    }
+    // Leftovers from chunks that were being written when a previous run died
+    for (const auto& entry : fs::directory_iterator(directory))
+        if (entry.path().extension() == ".tmp")
+            fs::remove(entry.path());
+}
+
+}  // namespace
+
+auto SweepSpec::point_count() const -> std::uint64_t {
+    return static_cast<std::uint64_t>(frequency.size()) * quad_radius.size() * voltage_rf.size() *
+           voltage_dc.size() * charge_state.size() * mass.size();
+}
+
+auto SweepColumns::column_pointers() const -> std::vector<const void*> {
+    return {frequency.data(), quad_radius.data(), voltage_rf.data(), voltage_dc.data(),
+            charge_state.data(), mass.data(), mz.data(), q.data(), a.data(), beta.data(),
+            secular_khz.data(), stable.data(), delta_a.data(), delta_q.data(), delta_e.data()};
+}
+
+auto sweep_result_columns() -> std::vector<ColumnSpec> {
+    return {{"frequency", ColumnType::Float64},   {"quad_radius", ColumnType::Float64},
+            {"voltage_rf", ColumnType::Float64},  {"voltage_dc", ColumnType::Float64},
+            {"charge", ColumnType::Int32},        {"mass", ColumnType::Float64},
+            {"mz", ColumnType::Float64},          {"q", ColumnType::Float64},
+            {"a", ColumnType::Float64},           {"beta", ColumnType::Float64},
+            {"secular_khz", ColumnType::Float64}, {"stable", ColumnType::UInt8},
+            {"delta_a", ColumnType::Float64},     {"delta_q", ColumnType::Float64},
+            {"delta_e", ColumnType::Float64}};
+}
+
+/**
+ * @brief Evaluates sweep points [first, first + count).
+ *
+ * Runs of consecutive masses share one operating point, so q and a for each run come from a
+ * single call to the broadcast m/z kernels.
+ */
+auto compute_sweep_range(const SweepSpec& spec, std::uint64_t first, std::size_t count)
+    -> SweepColumns {
+    if (first + count > spec.point_count())
+        throw std::invalid_argument("Sweep range exceeds the number of points");
+    SweepColumns out;
+    for (auto* column : {&out.frequency, &out.quad_radius, &out.voltage_rf, &out.voltage_dc,
+                         &out.mass, &out.mz, &out.q, &out.a, &out.beta, &out.secular_khz,
+                         &out.delta_a, &out.delta_q, &out.delta_e})
+        column->resize(count);
+    out.charge_state.resize(count);
+    out.stable.resize(count);
+
+    const std::uint64_t nm = spec.mass.size();
+    const std::uint64_t nz = spec.charge_state.size();
+    const std::uint64_t nd = spec.voltage_dc.size();
+    const std::uint64_t nv = spec.voltage_rf.size();
+    const std::uint64_t nr = spec.quad_radius.size();
+    std::size_t pos = 0;
+    while (pos < count) {
+        std::uint64_t index = first + pos;
+        const std::size_t im = static_cast<std::size_t>(index % nm);
+        index /= nm;
+        const int charge = spec.charge_state[static_cast<std::size_t>(index % nz)];
+        index /= nz;
+        const double vdc = spec.voltage_dc[static_cast<std::size_t>(index % nd)];
+        index /= nd;
+        const double vrf = spec.voltage_rf[static_cast<std::size_t>(index % nv)];
+        index /= nv;
+        const double radius = spec.quad_radius[static_cast<std::size_t>(index % nr)];
+        index /= nr;
+        const double frequency = spec.frequency[static_cast<std::size_t>(index)];
+
+        const std::size_t run = std::min<std::size_t>(static_cast<std::size_t>(nm) - im,
+                                                      count - pos);
+        const QuadrupoleParams params(frequency, radius, 0.0);
+        for (std::size_t i = 0; i < run; ++i) {
+            out.mass[pos + i] = spec.mass[im + i];
+            out.mz[pos + i] = spec.mass[im + i] / charge;
+        }
+        mathieu_q_from_mz(vrf, params, out.mz.data() + pos, run, out.q.data() + pos);
+        mathieu_a_from_mz(vdc, params, out.mz.data() + pos, run, out.a.data() + pos);
+        for (std::size_t i = pos; i < pos + run; ++i) {
+            out.frequency[i] = frequency;
+            out.quad_radius[i] = radius;
+            out.voltage_rf[i] = vrf;
+            out.voltage_dc[i] = vdc;
+            out.charge_state[i] = charge;
+            out.beta[i] = beta(out.q[i]);
+            out.secular_khz[i] = secular_frequency(frequency, out.q[i]);
+            const BoundaryMargins margins = boundary_margins(out.q[i], out.a[i]);
+            out.stable[i] = margins.stable ? 1 : 0;
+            out.delta_a[i] = margins.delta_a;
+            out.delta_q[i] = margins.delta_q;
+            out.delta_e[i] = margins.delta_e;
+        }
+        pos += run;
+    }
+    return out;
+}
+
+auto sweep_chunk_count(const SweepSpec& spec, std::uint64_t chunk_points) -> std::size_t {
+    if (chunk_points == 0)
+        throw std::invalid_argument("chunk_points must be positive");
+    const std::uint64_t points = spec.point_count();
+    // Rounded up without forming points + chunk_points - 1, which wraps for huge chunks
+    return static_cast<std::size_t>(points / chunk_points + (points % chunk_points != 0 ? 1 : 0));
+}
+
+auto sweep_chunk_path(const std::string& directory, std::size_t chunk) -> std::string {
+    char name[32];
+    std::snprintf(name, sizeof(name), "chunk_%06zu.trb", chunk);
+    return (fs::path(directory) / name).string();
+}
+
+/**
+ * @brief Runs (or resumes) a sweep into `directory`, one result file per chunk.
+ *
+ * Chunks whose files already exist are skipped; the rest are spread over the thread pool and
+ * handed to options.on_chunk as they complete. Finished chunks are kept when the sweep is
+ * cancelled or a chunk fails (the first error is rethrown), so the next run picks up where
+ * this one stopped.
+ */
+auto run_sweep(const SweepSpec& spec, const std::string& directory, const SweepOptions& options)
+    -> SweepSummary {
+    SweepSummary summary;
+    summary.total_chunks = sweep_chunk_count(spec, options.chunk_points);
+    prepare_directory(spec, directory, options.chunk_points);
+
+    std::vector<std::size_t> pending;
+    for (std::size_t chunk = 0; chunk < summary.total_chunks; ++chunk)
+        if (!fs::exists(sweep_chunk_path(directory, chunk)))
+            pending.push_back(chunk);
+    summary.skipped_chunks = summary.total_chunks - pending.size();
+    ProgressReporter reporter(options.progress, summary.total_chunks, summary.skipped_chunks);
+    reporter.report();
+    if (pending.empty())
+        return summary;
+
+    const std::uint64_t total_points = spec.point_count();
+    const std::vector<ColumnSpec> columns = sweep_result_columns();
+    ThreadPool& pool = options.pool ? *options.pool : ThreadPool::global();
+    ParallelForOptions loop;
+    loop.grain = 1;
+    loop.cancel = options.cancel;
+    pool.parallel_for(0, pending.size(), [&](std::size_t first, std::size_t last) {
+        for (std::size_t k = first; k < last; ++k) {
+            const std::size_t chunk = pending[k];
+            const std::uint64_t begin = chunk * options.chunk_points;
+            const auto count = static_cast<std::size_t>(
+                std::min<std::uint64_t>(options.chunk_points, total_points - begin));
+            const SweepColumns results = compute_sweep_range(spec, begin, count);
+            const std::string path = sweep_chunk_path(directory, chunk);
+            const std::string tmp = path + ".tmp";
+            {
+                ResultFileWriter writer(tmp, columns);
+                writer.write_chunk(results.column_pointers(), count);
+                writer.close();
+            }
+            fs::rename(tmp, path);
+            if (options.on_chunk)
+                reporter.advance(1, [&]() { options.on_chunk(begin, results); });
+            else
+                reporter.advance(1);
+        }
+    }, loop);
+    const auto finished = static_cast<std::size_t>(reporter.done()) - summary.skipped_chunks;
+    summary.computed_chunks = finished;
+    summary.cancelled = finished < pending.size();
+    return summary;
+}
+
+auto sweep_shard(std::uint64_t total, unsigned shard, unsigned shards) -> SweepShard {
+    if (shards == 0 || shard >= shards)
+        throw std::invalid_argument("Shard index out of range");
+    const std::uint64_t first = total * shard / shards;
+    const std::uint64_t last = total * (shard + 1) / shards;
+    return {first, last - first};
+}
+
+/**
+ * @brief Computes sweep points [first, first + count) block by block and stores each column
+ *        at its precomputed offset in a ReadWrite-mapped file from
+ *        create_preallocated_result_file(path, sweep_result_columns(), spec.point_count()).
+ *
+ * Writers with disjoint ranges never touch the same bytes, so any number of threads or
+ * processes can fill one file concurrently.
+ */
+void write_sweep_range(const SweepSpec& spec, std::uint64_t first, std::uint64_t count,
+                       MappedFile& file, const std::function<void(std::uint64_t)>& progress,
+                       std::size_t block_points) {
+    const std::vector<ColumnSpec> columns = sweep_result_columns();
+    const ResultFileLayout layout = result_file_layout(columns, spec.point_count());
+    if (file.size() != layout.file_size)
+        throw std::invalid_argument("Mapped file does not match the sweep layout");
+    if (first + count > spec.point_count())
+        throw std::invalid_argument("Sweep range exceeds the number of points");
+    char* base = file.mutable_data();
+    block_points = std::max<std::size_t>(block_points, 1);
+    for (std::uint64_t done = 0; done < count;) {
+        const auto rows =
+            static_cast<std::size_t>(std::min<std::uint64_t>(block_points, count - done));
+        const SweepColumns results = compute_sweep_range(spec, first + done, rows);
+        const std::vector<const void*> pointers = results.column_pointers();
+        for (std::size_t c = 0; c < columns.size(); ++c) {
+            const std::size_t size = column_type_size(columns[c].type);
+            std::memcpy(base + layout.column_offsets[c] + (first + done) * size, pointers[c],
+                        rows * size);
+        }
+        done += rows;
+        if (progress)
+            progress(done);
+    }
+}
+
+}  // namespace mathieu_lib
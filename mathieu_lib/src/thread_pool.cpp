@@ -0,0 +1,213 @@
+/**
+ * @file thread_pool.cpp
+ * @brief Work-stealing scheduler and adaptive parallel_for shared by all parallel engines.
+ */
+#include "mathieu_lib/thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+namespace mathieu_lib {
+
+namespace {
+
+// Which pool (if any) the current thread works for, and its queue index there
+thread_local const ThreadPool* t_pool = nullptr;
+thread_local std::size_t t_index = 0;
+
+std::mutex g_global_mutex;
+unsigned g_global_threads = 0;
+std::unique_ptr<ThreadPool> g_global_pool;
+
+// Shared bookkeeping for one parallel_for call
+struct LoopState {
+    const std::function<void(std::size_t, std::size_t)>* body;
+    const std::atomic<bool>* cancel;
+    std::size_t grain;
+    std::atomic<std::size_t> outstanding{1};  // the caller's own range counts as one
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable done;
+
+    auto stopped() const -> bool {
+        return failed.load(std::memory_order_relaxed) ||
+               (cancel && cancel->load(std::memory_order_relaxed));
+    }
+
+    void finish_range() {
+        if (--outstanding == 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            done.notify_all();
+        }
+    }
+};
+
+}  // namespace
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    threads = std::min(threads, MAX_THREADS);
+    for (unsigned i = 0; i <= threads; ++i) m_queues.push_back(std::make_unique<Queue>());
+    m_threads.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) m_threads.emplace_back([this, i]() { worker_loop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& thread : m_threads) thread.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    Queue& queue = t_pool == this ? *m_queues[t_index] : *m_queues.back();
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    ++m_queued;
+    {
+        // Taking the sleep mutex orders this wake-up after any worker's predicate check
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+    }
+    m_wake.notify_one();
+}
+
+/**
+ * @brief Pops from the back of the calling worker's own deque (most recently split, still
+ *        cache-warm work), otherwise steals the oldest task from another queue.
+ */
+auto ThreadPool::try_pop(std::function<void()>& task) -> bool {
+    if (m_queued.load(std::memory_order_relaxed) == 0)
+        return false;
+    const std::size_t count = m_queues.size();
+    const std::size_t own = t_pool == this ? t_index : count - 1;
+    if (t_pool == this) {
+        Queue& queue = *m_queues[own];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            --m_queued;
+            return true;
+        }
+    }
+    for (std::size_t k = 1; k <= count; ++k) {
+        Queue& queue = *m_queues[(own + k) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            --m_queued;
+            return true;
+        }
+    }
+    return false;
+}
+
+auto ThreadPool::run_pending_task() -> bool {
+    std::function<void()> task;
+    if (!try_pop(task))
+        return false;
+    task();
+    return true;
+}
+
+void ThreadPool::worker_loop(std::size_t index) {
+    t_pool = this;
+    t_index = index;
+    while (true) {
+        if (run_pending_task())
+            continue;
+        std::unique_lock<std::mutex> lock(m_sleep_mutex);
+        m_wake.wait(lock, [this]() { return m_stop || m_queued.load() > 0; });
+        if (m_stop && m_queued.load() == 0)
+            return;
+    }
+}
+
+/**
+ * @brief Parallel loop with lazy binary splitting.
+ *
+ * A thread working on a range splits off its upper half as a stealable task only while
+ * there are fewer queued tasks than workers, i.e. while some thread could be idle; otherwise
+ * it walks its range in grain-sized blocks. Balanced loops therefore cost a handful of tasks,
+ * and skewed ones keep splitting where the work actually is. Cancellation and failures are
+ * checked between blocks.
+ */
+auto ThreadPool::parallel_for(std::size_t begin, std::size_t end,
+                              const std::function<void(std::size_t, std::size_t)>& body,
+                              const ParallelForOptions& options) -> bool {
+    if (begin >= end)
+        return true;
+    const std::size_t n = end - begin;
+    auto state = std::make_shared<LoopState>();
+    state->body = &body;
+    state->cancel = options.cancel;
+    state->grain = options.grain ? options.grain
+                                 : std::max<std::size_t>(1, n / (8 * std::size_t(thread_count())));
+
+    // Runs [first, last); split-off halves are submitted as tasks that call back into it
+    std::function<void(std::size_t, std::size_t)> run;
+    run = [this, state, &run](std::size_t first, std::size_t last) {
+        while (first < last && !state->stopped()) {
+            if (last - first > state->grain && m_queued.load(std::memory_order_relaxed) <
+                                                   thread_count()) {
+                const std::size_t mid = first + (last - first) / 2;
+                ++state->outstanding;
+                submit([state, &run, mid, last]() {
+                    run(mid, last);
+                    state->finish_range();
+                });
+                last = mid;
+                continue;
+            }
+            const std::size_t stop = std::min(last, first + state->grain);
+            try {
+                (*state->body)(first, stop);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->error)
+                    state->error = std::current_exception();
+                state->failed = true;
+            }
+            first = stop;
+        }
+    };
+    run(begin, end);
+    state->finish_range();
+
+    // Help with queued work (ours or anyone's) until every split-off range has finished
+    while (state->outstanding.load() != 0) {
+        if (run_pending_task())
+            continue;
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait_for(lock, std::chrono::milliseconds(1),
+                             [&state]() { return state->outstanding.load() == 0; });
+    }
+    if (state->error)
+        std::rethrow_exception(state->error);
+    return !(options.cancel && options.cancel->load(std::memory_order_relaxed));
+}
+
+auto ThreadPool::global() -> ThreadPool& {
+    std::lock_guard<std::mutex> lock(g_global_mutex);
+    if (!g_global_pool)
+        g_global_pool = std::make_unique<ThreadPool>(g_global_threads);
+    return *g_global_pool;
+}
+
+auto ThreadPool::set_global_thread_count(unsigned threads) -> bool {
+    std::lock_guard<std::mutex> lock(g_global_mutex);
+    if (g_global_pool)
+        return false;
+    g_global_threads = std::min(threads, MAX_THREADS);
+    return true;
+}
+
+}  // namespace mathieu_lib
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "mathieu_lib/acceptance.h"
+using namespace mathieu_lib;
+
+namespace {
+
+auto mathieu_drive(std::size_t steps = 128) -> HillEquation {
+    FourierWaveform cosine;
+    cosine.cosines = {1.0};
+    return HillEquation(cosine, steps);
+}
+
+const double R0 = 0.004;
+
+}  // namespace
+
+TEST(AcceptanceTest, TwissTablesAreConsistent) {
+    const AcceptanceTable table(mathieu_drive(), 0.7, 0.02, R0);
+    ASSERT_TRUE(table.x().stable());
+    ASSERT_TRUE(table.y().stable());
+    EXPECT_EQ(table.phases(), 128u);
+    for (const TwissTable* t : {&table.x(), &table.y()}) {
+        ASSERT_EQ(t->twiss.size(), 128u);
+        double max_beta = 0.0;
+        for (const Twiss& twiss : t->twiss) {
+            EXPECT_GT(twiss.beta, 0.0);
+            EXPECT_NEAR(twiss.beta * twiss.gamma - twiss.alpha * twiss.alpha, 1.0, 1e-9);
+            max_beta = std::max(max_beta, twiss.beta);
+        }
+        EXPECT_NEAR(t->acceptance, R0 * R0 / max_beta, 1e-18);
+    }
+    // cos mu = cos(pi beta_x)
+    EXPECT_NEAR(table.x().phase_advance, M_PI * mathieu_drive().beta(0.7, 0.02), 1e-12);
+    EXPECT_EQ(table.index(M_PI), 0u);
+    EXPECT_EQ(table.index(-M_PI / 128.0), 127u);
+}
+
+TEST(AcceptanceTest, InvariantIsConservedAlongTrajectory) {
+    const HillEquation hill = mathieu_drive();
+    const AcceptanceTable table(hill, 0.5, 0.03, R0);
+    const std::size_t start = 40;
+    const PhaseSpacePoint p = AcceptanceTable::launch(table.x(), start, 0.6, 0.3);
+    const double invariant = table.x().twiss[start].invariant(p.u, p.du);
+    EXPECT_NEAR(invariant, 0.6 * table.x().acceptance, 1e-12 * table.x().acceptance);
+
+    // Integrate from phase `start` by applying the step matrices in turn
+    const std::vector<TransferMatrix> steps = hill.step_matrices(0.5, 0.03);
+    double u = p.u;
+    double du = p.du;
+    double max_u = 0.0;
+    for (std::size_t i = 0; i < 5 * steps.size(); ++i) {
+        const std::size_t k = (start + i) % steps.size();
+        const TransferMatrix& m = steps[k];
+        const double next_u = m.m11 * u + m.m12 * du;
+        du = m.m21 * u + m.m22 * du;
+        u = next_u;
+        const std::size_t row = (k + 1) % steps.size();
+        EXPECT_NEAR(table.x().twiss[row].invariant(u, du), invariant, 1e-9 * invariant);
+        max_u = std::max(max_u, std::abs(u));
+    }
+    EXPECT_LT(max_u, std::sqrt(0.6) * R0 * (1.0 + 1e-9));
+}
+
+TEST(AcceptanceTest, AcceptsMatchesInvariants) {
+    const AcceptanceTable table(mathieu_drive(), 0.6, 0.0, R0);
+    const std::vector<double> xi = {0.0, 1.0, 2.0, 3.0};
+    const std::vector<double> x = {0.0, 0.5 * R0, 1.1 * R0, 0.2 * R0};
+    const std::vector<double> dx = {0.0, 0.0, 0.0, 0.1 * R0};
+    const std::vector<double> y = {0.0, 0.0, 0.0, 0.3 * R0};
+    const std::vector<double> dy = {0.0, 0.0, 0.0, -0.1 * R0};
+    std::vector<std::uint8_t> out(xi.size());
+    table.accepts(xi.data(), x.data(), dx.data(), y.data(), dy.data(), xi.size(), out.data());
+    for (std::size_t i = 0; i < xi.size(); ++i)
+        EXPECT_EQ(out[i] != 0, table.accepts(table.index(xi[i]), x[i], dx[i], y[i], dy[i])) << i;
+    EXPECT_EQ(out[0], 1);
+    EXPECT_EQ(out[2], 0);  // outside the rods
+
+    const AcceptanceTable unstable(mathieu_drive(), 0.95, 0.0, R0);
+    EXPECT_FALSE(unstable.x().stable());
+    EXPECT_EQ(unstable.x().acceptance, 0.0);
+    EXPECT_FALSE(unstable.accepts(0, 0.0, 0.0, 0.0, 0.0));
+    EXPECT_THROW(AcceptanceTable(mathieu_drive(), 0.5, 0.0, 0.0), std::invalid_argument);
+}
+
+TEST(AcceptanceTest, UniformLaunchesHaveAcceptanceRmsEllipse) {
+    // A uniformly filled ellipse of invariant A has rms emittance A / 4 and the same Twiss
+    const AcceptanceTable table(mathieu_drive(), 0.4, 0.01, R0);
+    const std::size_t phase = 17;
+    const TwissTable& y = table.y();
+    std::vector<double> u;
+    std::vector<double> du;
+    const int grid = 200;
+    for (int i = 0; i < grid; ++i) {
+        for (int j = 0; j < grid; ++j) {
+            const PhaseSpacePoint p =
+                AcceptanceTable::launch(y, phase, (i + 0.5) / grid, (j + 0.5) / grid);
+            u.push_back(p.u);
+            du.push_back(p.du);
+        }
+    }
+    const BeamEllipse beam = rms_ellipse(u, du);
+    EXPECT_NEAR(beam.emittance, y.acceptance / 4.0, 1e-3 * y.acceptance);
+    EXPECT_NEAR(beam.twiss.alpha, y.twiss[phase].alpha, 1e-3 * (1.0 + std::abs(beam.twiss.alpha)));
+    EXPECT_NEAR(beam.twiss.beta, y.twiss[phase].beta, 1e-3 * beam.twiss.beta);
+
+    // Matched beams reach exactly their emittance; mismatched ones reach further
+    EXPECT_NEAR(max_invariant(beam, y.twiss[phase]), beam.emittance, 1e-3 * beam.emittance);
+    BeamEllipse round = beam;
+    round.twiss = Twiss{};
+    EXPECT_GT(max_invariant(round, y.twiss[phase]), 1.01 * round.emittance);
+    EXPECT_THROW(rms_ellipse(nullptr, nullptr, 0), std::invalid_argument);
+}
+
+TEST(AcceptanceTest, CacheBuildsEachOperatingPointOnce) {
+    AcceptanceCache cache(mathieu_drive(64));
+    const auto first = cache.table(0.7, 0.1, R0);
+    const auto again = cache.table(0.7, 0.1, R0);
+    const auto other = cache.table(0.7, 0.12, R0);
+    EXPECT_EQ(first.get(), again.get());
+    EXPECT_NE(first.get(), other.get());
+    EXPECT_EQ(cache.cached_count(), 2u);
+    EXPECT_EQ(first->phases(), 64u);
+    cache.clear();
+    EXPECT_EQ(cache.cached_count(), 0u);
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "mathieu_lib/characteristic.h"
+using namespace mathieu_lib;
+
+TEST(CharacteristicTest, MatchesTabulatedValues) {
+    // Abramowitz & Stegun / DLMF reference values at q = 1
+    EXPECT_NEAR(characteristic_a(0, 1.0), -0.455138604107414, 1e-13);
+    EXPECT_NEAR(characteristic_b(1, 1.0), -0.110248816992095, 1e-13);
+    EXPECT_NEAR(characteristic_a(1, 1.0), 1.859108072514363, 1e-13);
+    EXPECT_NEAR(characteristic_b(2, 1.0), 3.917024772998471, 1e-13);
+}
+
+TEST(CharacteristicTest, ReducesToSquaresAtZeroQ) {
+    for (int r = 0; r < 8; ++r) {
+        EXPECT_NEAR(characteristic_a(r, 0.0), r * r, 1e-12);
+        if (r > 0) {
+            EXPECT_NEAR(characteristic_b(r, 0.0), r * r, 1e-12);
+        }
+    }
+}
+
+TEST(CharacteristicTest, ValuesInterlace) {
+    for (double q : {0.1, 0.7, 2.0, 10.0}) {
+        double previous = characteristic_a(0, q);
+        for (int r = 1; r < 6; ++r) {
+            const double b = characteristic_b(r, q);
+            const double a = characteristic_a(r, q);
+            EXPECT_LT(previous, b) << "q=" << q << " r=" << r;
+            EXPECT_LT(b, a) << "q=" << q << " r=" << r;
+            previous = a;
+        }
+    }
+}
+
+TEST(CharacteristicTest, SymmetryInQ) {
+    // a_0 is even in q; b_1(-q) = a_1(q)
+    EXPECT_NEAR(characteristic_a(0, -0.8), characteristic_a(0, 0.8), 1e-14);
+    EXPECT_NEAR(characteristic_b(1, -0.8), characteristic_a(1, 0.8), 1e-14);
+}
+
+TEST(CharacteristicTest, RejectsInvalidOrder) {
+    EXPECT_THROW(characteristic_a(-1, 0.5), std::invalid_argument);
+    EXPECT_THROW(characteristic_b(0, 0.5), std::invalid_argument);
+    EXPECT_THROW(characteristic_a(EXACT_SOLVER_ORDER_MAX + 1, 0.5), std::invalid_argument);
+}
+
+TEST(CharacteristicTest, RejectsNonFiniteOrHugeQ) {
+    const double inf = std::numeric_limits<double>::infinity();
+    for (double q : {inf, -inf, std::nan(""), 1e20}) {
+        EXPECT_THROW(characteristic_a(0, q), std::invalid_argument) << q;
+        EXPECT_THROW(characteristic_b(1, q), std::invalid_argument) << q;
+    }
+    EXPECT_NO_THROW(characteristic_a(0, EXACT_SOLVER_Q_MAX));
+}
+
+TEST(CharacteristicTest, TablesWithinErrorBound) {
+    for (int i = 0; i <= 2000; ++i) {
+        const double q = CHEBYSHEV_Q_MAX * i / 2000.0;
+        ASSERT_NEAR(characteristic_a0(q), characteristic_a(0, q), CHEBYSHEV_ERROR_BOUND) << q;
+        ASSERT_NEAR(characteristic_b1(q), characteristic_b(1, q), CHEBYSHEV_ERROR_BOUND) << q;
+    }
+    // Beyond the table the exact solver takes over
+    EXPECT_DOUBLE_EQ(characteristic_a0(20.0), characteristic_a(0, 20.0));
+    EXPECT_DOUBLE_EQ(characteristic_b1(-0.5), characteristic_b(1, -0.5));
+}
+
+TEST(CharacteristicTest, FirstRegionApexAndTail) {
+    // -a_0 and b_1 cross at the apex of the first stability region and b_1 reaches zero at
+    // its right-hand corner
+    EXPECT_NEAR(-characteristic_a0(0.706), 0.2370, 5e-4);
+    EXPECT_NEAR(characteristic_b1(0.706), 0.2370, 5e-4);
+    EXPECT_NEAR(characteristic_b1(0.908046), 0.0, 1e-5);
+}
+
+TEST(CharacteristicTest, FloatAndBatchFormsAgree) {
+    std::vector<double> qs;
+    for (int i = 0; i <= 400; ++i) qs.push_back(CHEBYSHEV_Q_MAX * i / 400.0);
+    std::vector<float> qf(qs.begin(), qs.end());
+    std::vector<double> a0(qs.size()), b1(qs.size());
+    std::vector<float> a0f(qs.size()), b1f(qs.size());
+    characteristic_a0(qs.data(), qs.size(), a0.data());
+    characteristic_b1(qs.data(), qs.size(), b1.data());
+    characteristic_a0(qf.data(), qf.size(), a0f.data());
+    characteristic_b1(qf.data(), qf.size(), b1f.data());
+    for (std::size_t i = 0; i < qs.size(); ++i) {
+        EXPECT_EQ(a0[i], characteristic_a0(qs[i]));
+        EXPECT_EQ(b1[i], characteristic_b1(qs[i]));
+        EXPECT_NEAR(a0f[i], a0[i], 1e-5);
+        EXPECT_NEAR(b1f[i], b1[i], 1e-5);
+    }
+}
@@ -0,0 +1,300 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mathieu_lib/result_file.h"
+#include "mathieu_lib/sweep.h"
+#include "process.h"
+using namespace mathieu_lib;
+
+// Drives the trappable-cli executable (path from the build) through its commands
+
+namespace {
+
+// Runs trappable-cli with `args` and returns its exit code
+auto run_cli(const std::vector<std::string>& args) -> int {
+    trappable::cli::ChildProcess child = trappable::cli::spawn_process(TRAPPABLE_CLI_PATH, args);
+    for (;;) {
+        if (const std::optional<int> code = trappable::cli::poll_process(child))
+            return *code;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+auto fresh_directory(const std::string& name) -> std::string {
+    const std::string dir = ::testing::TempDir() + name;
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    return dir + "/";
+}
+
+void write_text(const std::string& path, const std::string& text) {
+    std::ofstream(path) << text;
+}
+
+auto read_lines(const std::string& path) -> std::vector<std::string> {
+    std::ifstream in(path);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);) lines.push_back(line);
+    return lines;
+}
+
+// Sets an environment variable for the children started afterwards; empty clears it
+void set_environment(const char* name, const std::string& value) {
+#ifdef _WIN32
+    _putenv_s(name, value.c_str());
+#else
+    if (value.empty())
+        ::unsetenv(name);
+    else
+        ::setenv(name, value.c_str(), 1);
+#endif
+}
+
+// Every column of two result files holds the same values (NaN matching NaN)
+void expect_same_results(const std::string& path, const std::string& expected_path) {
+    const ResultFileReader actual(path);
+    const ResultFileReader expected(expected_path);
+    ASSERT_EQ(actual.row_count(), expected.row_count());
+    ASSERT_EQ(actual.columns().size(), expected.columns().size());
+    for (const ColumnSpec& column : expected.columns()) {
+        const std::vector<double> a = actual.read_f64(column.name);
+        const std::vector<double> b = expected.read_f64(column.name);
+        ASSERT_EQ(a.size(), b.size()) << column.name;
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            if (!(std::isnan(a[i]) && std::isnan(b[i]))) {
+                ASSERT_EQ(a[i], b[i]) << column.name << " row " << i;
+            }
+        }
+    }
+}
+
+// First `count` comma-separated fields of a CSV row
+auto fields(const std::string& line, std::size_t count) -> std::vector<std::string> {
+    std::istringstream in(line);
+    std::vector<std::string> out;
+    for (std::string field; out.size() < count && std::getline(in, field, ',');)
+        out.push_back(field);
+    return out;
+}
+
+}  // namespace
+
+TEST(CliTest, BatchStreamsRowsInInputOrder) {
+    const std::string dir = fresh_directory("cli_batch");
+    write_text(dir + "configs.txt", "1e6,0.004,500,0\n1.2e6,0.004,800,10\n");
+    std::string ions;
+    for (int i = 1; i <= 40; ++i) ions += std::to_string(50 * i) + (i % 3 == 0 ? ",2\n" : "\n");
+    write_text(dir + "ions.txt", ions);
+    ASSERT_EQ(run_cli({"batch", "--config", dir + "configs.txt", "--ions", dir + "ions.txt",
+                       "--threads", "4", "--output", dir + "out.csv"}),
+              0);
+
+    const std::vector<std::string> lines = read_lines(dir + "out.csv");
+    ASSERT_EQ(lines.size(), 81u);
+    EXPECT_EQ(fields(lines[0], 3), (std::vector<std::string>{"config", "mz", "charge"}));
+    for (std::size_t row = 0; row < 80; ++row) {
+        const int i = static_cast<int>(row % 40) + 1;
+        const std::vector<std::string> expected = {std::to_string(row / 40),
+                                                   std::to_string(50 * i), i % 3 == 0 ? "2" : "1"};
+        EXPECT_EQ(fields(lines[row + 1], 3), expected) << "row " << row;
+    }
+
+    // The single-configuration flags give the same rows as a one-line config file
+    ASSERT_EQ(run_cli({"batch", "--frequency", "1e6", "--radius", "0.004", "--vrf", "500",
+                       "--ions", dir + "ions.txt", "--output", dir + "single.csv"}),
+              0);
+    const std::vector<std::string> single = read_lines(dir + "single.csv");
+    ASSERT_EQ(single.size(), 41u);
+    EXPECT_EQ(single, std::vector<std::string>(lines.begin(), lines.begin() + 41));
+}
+
+TEST(CliTest, BatchRejectsBadArguments) {
+    const std::string dir = fresh_directory("cli_batch_bad");
+    write_text(dir + "ions.txt", "100\n1000\n");
+    const std::vector<std::string> single = {"--frequency", "1e6", "--radius", "0.004",
+                                             "--vrf",       "500", "--ions",   dir + "ions.txt"};
+    const auto with = [&](std::vector<std::string> extra) {
+        std::vector<std::string> args = {"batch"};
+        args.insert(args.end(), single.begin(), single.end());
+        args.insert(args.end(), extra.begin(), extra.end());
+        return args;
+    };
+    EXPECT_NE(run_cli(with({"--threads", "-1"})), 0);
+    EXPECT_NE(run_cli(with({"--threads", "0"})), 0);
+    EXPECT_NE(run_cli(with({"--threads", "2.5"})), 0);
+    EXPECT_NE(run_cli(with({"--threads", "99999999999999999999"})), 0);
+    EXPECT_NE(run_cli(with({"--format", "binary"})), 0);  // binary needs --output
+    EXPECT_NE(run_cli(with({"--bogus", "1"})), 0);
+    EXPECT_NE(run_cli(with({"--threads"})), 0);
+    EXPECT_NE(run_cli({"batch", "--vdc", "5", "--ions", dir + "ions.txt"}), 0);
+    EXPECT_NE(run_cli({"batch", "--frequency", "-1e6", "--radius", "0.004", "--vrf", "500",
+                       "--ions", dir + "ions.txt"}),
+              0);
+    EXPECT_NE(run_cli({"batch", "--config", dir + "missing.txt", "--ions", dir + "ions.txt"}),
+              0);
+    EXPECT_NE(run_cli({"no-such-command"}), 0);
+    EXPECT_EQ(run_cli(with({"--threads", "2", "--output", dir + "ok.csv"})), 0);
+}
+
+TEST(CliTest, SweepWritesEveryPointInOrder) {
+    const std::string dir = fresh_directory("cli_sweep");
+    const std::vector<std::string> args = {
+        "sweep", "--out", dir + "sweep", "--frequency", "1e6,1.2e6", "--radius", "0.004",
+        "--vrf", "100:500:5", "--vdc", "0,10", "--mass", "100:2000:7", "--chunk-points", "16",
+        "--threads", "3"};
+    ASSERT_EQ(run_cli(args), 0);
+
+    SweepSpec spec;
+    spec.frequency = {1e6, 1.2e6};
+    spec.quad_radius = {0.004};
+    spec.voltage_rf = {100.0, 200.0, 300.0, 400.0, 500.0};
+    spec.voltage_dc = {0.0, 10.0};
+    spec.charge_state = {1};
+    spec.mass = {100.0, 416.6666666666667, 733.3333333333334, 1050.0, 1366.6666666666667,
+                 1683.3333333333335, 2000.0};
+    ASSERT_EQ(spec.point_count(), 140u);
+    const std::uint64_t chunks = sweep_chunk_count(spec, 16);
+    ASSERT_EQ(chunks, 9u);
+    std::vector<double> mass;
+    for (std::uint64_t chunk = 0; chunk < chunks; ++chunk) {
+        const ResultFileReader reader(sweep_chunk_path(dir + "sweep", chunk));
+        const std::vector<double> part = reader.read_f64("mass");
+        mass.insert(mass.end(), part.begin(), part.end());
+    }
+    ASSERT_EQ(mass.size(), 140u);
+    for (std::size_t i = 0; i < mass.size(); ++i)
+        EXPECT_NEAR(mass[i], spec.mass[i % spec.mass.size()], 1e-9) << i;
+
+    // Re-running the finished sweep only confirms it
+    EXPECT_EQ(run_cli(args), 0);
+}
+
+TEST(CliTest, SweepRejectsBadArguments) {
+    const std::string dir = fresh_directory("cli_sweep_bad");
+    const std::vector<std::string> axes = {"--frequency", "1e6", "--radius", "0.004",
+                                           "--vrf",       "500", "--mass",   "100,200"};
+    const auto with = [&](std::vector<std::string> extra) {
+        std::vector<std::string> args = {"sweep", "--out", dir + "sweep"};
+        args.insert(args.end(), axes.begin(), axes.end());
+        args.insert(args.end(), extra.begin(), extra.end());
+        return args;
+    };
+    EXPECT_NE(run_cli(with({"--chunk-points", "-1"})), 0);
+    EXPECT_NE(run_cli(with({"--chunk-points", "0"})), 0);
+    EXPECT_NE(run_cli(with({"--chunk-points", "1e3"})), 0);
+    EXPECT_NE(run_cli(with({"--threads", "-1"})), 0);
+    EXPECT_NE(run_cli(with({"--mass", "100:200:x"})), 0);
+    EXPECT_NE(run_cli({"sweep", "--frequency", "1e6", "--radius", "0.004", "--vrf", "500",
+                       "--mass", "100"}),
+              0);  // no --out
+    EXPECT_FALSE(std::filesystem::exists(sweep_chunk_path(dir + "sweep", 0)));
+}
+
+TEST(CliTest, StabilityMapRowsAreOrdered) {
+    const std::string dir = fresh_directory("cli_map");
+    ASSERT_EQ(run_cli({"stability-map", "--q", "0:0.9:10", "--a", "0:0.2:7", "--band-rows", "1",
+                       "--threads", "3", "--output", dir + "map.csv"}),
+              0);
+    const std::vector<std::string> lines = read_lines(dir + "map.csv");
+    ASSERT_EQ(lines.size(), 71u);
+    EXPECT_EQ(lines[0], "q,a,margin,stable");
+    for (std::size_t row = 0; row < 70; ++row) {
+        const std::vector<std::string> cell = fields(lines[row + 1], 4);
+        ASSERT_EQ(cell.size(), 4u) << lines[row + 1];
+        EXPECT_NEAR(std::stod(cell[0]), 0.1 * static_cast<double>(row % 10), 1e-5) << row;
+        EXPECT_NEAR(std::stod(cell[1]), 0.2 / 6 * static_cast<double>(row / 10), 1e-5) << row;
+        EXPECT_EQ(cell[3] == "1", std::stod(cell[2]) >= 0.0) << lines[row + 1];
+    }
+}
+
+TEST(CliTest, StabilityMapRejectsBadArguments) {
+    EXPECT_NE(run_cli({"stability-map", "--band-rows", "2.5"}), 0);
+    EXPECT_NE(run_cli({"stability-map", "--band-rows", "0"}), 0);
+    EXPECT_NE(run_cli({"stability-map", "--band-rows", "-8"}), 0);
+    EXPECT_NE(run_cli({"stability-map", "--threads", "-1"}), 0);
+    EXPECT_NE(run_cli({"stability-map", "--q", "0:0.9"}), 0);
+    EXPECT_NE(run_cli({"stability-map", "--a", "0:0.2:x"}), 0);
+}
+
+namespace {
+
+const std::vector<std::string> SHARD_AXES = {"--frequency", "1e6,1.2e6", "--radius", "0.004",
+                                             "--vrf",       "100:500:5", "--vdc",    "0,10",
+                                             "--charge",    "1,2",       "--mass",   "100:2000:7"};
+
+// Single-process sweep of SHARD_AXES in one chunk, the reference for the sharded runs
+auto reference_sweep(const std::string& dir) -> std::string {
+    std::vector<std::string> args = {"sweep", "--out", dir + "reference"};
+    args.insert(args.end(), SHARD_AXES.begin(), SHARD_AXES.end());
+    EXPECT_EQ(run_cli(args), 0);
+    return sweep_chunk_path(dir + "reference", 0);
+}
+
+auto shard_args(const std::string& output, std::vector<std::string> options)
+    -> std::vector<std::string> {
+    std::vector<std::string> args = {"shard", "--output", output};
+    args.insert(args.end(), options.begin(), options.end());
+    args.insert(args.end(), SHARD_AXES.begin(), SHARD_AXES.end());
+    return args;
+}
+
+}  // namespace
+
+TEST(CliTest, ShardMatchesSingleProcessSweep) {
+    const std::string dir = fresh_directory("cli_shard");
+    const std::string reference = reference_sweep(dir);
+    const std::string output = dir + "sharded.trb";
+    ASSERT_EQ(run_cli(shard_args(output, {"--workers", "2"})), 0);
+    expect_same_results(output, reference);
+    EXPECT_FALSE(std::filesystem::exists(output + ".partial"));
+    EXPECT_FALSE(std::filesystem::exists(output + ".progress"));
+}
+
+TEST(CliTest, ShardRetriesAFailedWorker) {
+    const std::string dir = fresh_directory("cli_shard_retry");
+    const std::string reference = reference_sweep(dir);
+    const std::string fault = dir + "fault";
+    set_environment("TRAPPABLE_SHARD_FAULT", fault);
+
+    // One worker dies halfway through its slice; the re-run slice completes the file
+    write_text(fault, "");
+    const std::string output = dir + "retried.trb";
+    const int code = run_cli(shard_args(output, {"--workers", "2", "--retries", "1"}));
+    EXPECT_FALSE(std::filesystem::exists(fault));  // the failure did happen
+    ASSERT_EQ(code, 0);
+    expect_same_results(output, reference);
+
+    // Without retries the failure is final and no output is left behind
+    write_text(fault, "");
+    const std::string failed = dir + "failed.trb";
+    EXPECT_NE(run_cli(shard_args(failed, {"--workers", "2", "--retries", "0"})), 0);
+    EXPECT_FALSE(std::filesystem::exists(fault));
+    EXPECT_FALSE(std::filesystem::exists(failed));
+    EXPECT_FALSE(std::filesystem::exists(failed + ".partial"));
+    EXPECT_FALSE(std::filesystem::exists(failed + ".progress"));
+    set_environment("TRAPPABLE_SHARD_FAULT", "");
+}
+
+TEST(CliTest, ShardRejectsBadArguments) {
+    const std::string dir = fresh_directory("cli_shard_bad");
+    const std::string output = dir + "out.trb";
+    EXPECT_NE(run_cli(shard_args(output, {"--workers", "0"})), 0);
+    EXPECT_NE(run_cli(shard_args(output, {"--workers", "-1"})), 0);
+    EXPECT_NE(run_cli(shard_args(output, {"--workers", "1.5"})), 0);
+    EXPECT_NE(run_cli(shard_args(output, {"--retries", "-1"})), 0);
+    EXPECT_NE(run_cli({"shard", "--workers", "2", "--frequency", "1e6"}), 0);  // no --output
+    EXPECT_NE(run_cli({"shard-worker", "--shard", "2/2", "--output", output, "--progress",
+                       output + ".progress"}),
+              0);
+    EXPECT_FALSE(std::filesystem::exists(output));
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "mathieu_lib/characteristic.h"
+#include "mathieu_lib/digital_drive.h"
+using namespace mathieu_lib;
+
+namespace {
+
+// cos 2xi sampled at the midpoints of `segments` equal stretches
+auto sampled_cosine(int segments) -> PiecewiseWaveform {
+    std::vector<DriveSegment> steps;
+    for (int i = 0; i < segments; ++i)
+        steps.push_back({1.0, std::cos(2.0 * M_PI * (i + 0.5) / segments)});
+    return PiecewiseWaveform(steps);
+}
+
+}  // namespace
+
+TEST(DigitalDriveTest, SquareWaveCutoffOnQAxis) {
+    // At a = 0 the symmetric square wave gives trace = 2 cos(t) cosh(t), t = (pi / 2) sqrt(2q),
+    // so the first region ends where cos(t) cosh(t) = -1, t = 1.8751040687119611
+    const double t = 1.8751040687119611;
+    const double q_edge = 2.0 * t * t / (M_PI * M_PI);
+    const PiecewiseWaveform square = PiecewiseWaveform::rectangular(0.5);
+    EXPECT_NEAR(digital_monodromy(square, q_edge, 0.0).trace(), -2.0, 1e-9);
+    EXPECT_EQ(classify_digital_stability(square, q_edge - 1e-6, 0.0), StabilityClass::Both);
+    EXPECT_EQ(classify_digital_stability(square, q_edge + 1e-6, 0.0), StabilityClass::None);
+    EXPECT_NEAR(digital_beta(square, q_edge - 1e-9, 0.0), 1.0, 1e-3);
+}
+
+TEST(DigitalDriveTest, MonodromyIsUnimodular) {
+    const PiecewiseWaveform waveform({{0.2, 1.0}, {0.3, -0.4}, {0.5, -0.8}});
+    for (double q : {0.1, 0.5, 2.0}) {
+        for (double a : {-0.3, 0.0, 0.7}) {
+            const TransferMatrix m = digital_monodromy(waveform, q, a);
+            EXPECT_NEAR(m.m11 * m.m22 - m.m12 * m.m21, 1.0, 1e-10) << q << " " << a;
+        }
+    }
+}
+
+TEST(DigitalDriveTest, SampledCosineConvergesToMathieu) {
+    const PiecewiseWaveform cosine = sampled_cosine(2000);
+    for (double q : {0.2, 0.5, 0.8}) {
+        // beta = 0 on a_0 and beta = 1 on b_1
+        EXPECT_NEAR(digital_monodromy(cosine, q, characteristic_a(0, q)).trace(), 2.0, 1e-4);
+        EXPECT_NEAR(digital_monodromy(cosine, q, characteristic_b(1, q)).trace(), -2.0, 1e-4);
+        for (double a : {-0.2, -0.05, 0.05, 0.2}) {
+            const StabilityClass exact = classify_stability(q, a);
+            EXPECT_EQ(classify_digital_stability(cosine, q, a), exact) << q << " " << a;
+        }
+    }
+}
+
+TEST(DigitalDriveTest, DutyCycleMirrorsDriveSign) {
+    // Swapping the duty cycle flips the drive, which is the same as flipping q
+    const PiecewiseWaveform narrow = PiecewiseWaveform::rectangular(0.3);
+    const PiecewiseWaveform wide = PiecewiseWaveform::rectangular(0.7);
+    for (double q : {0.2, 0.4, 0.6}) {
+        for (double a : {-0.1, 0.0, 0.1}) {
+            EXPECT_NEAR(digital_monodromy(narrow, q, a).trace(),
+                        digital_monodromy(wide, -q, a).trace(), 1e-12);
+        }
+    }
+}
+
+TEST(DigitalDriveTest, MapMatchesScalarClassifier) {
+    const PiecewiseWaveform waveform = PiecewiseWaveform::rectangular(0.4);
+    const StabilityMapSpec spec{0.0, 1.0, 41, -0.4, 0.4, 23};
+    DigitalStabilityMapOptions options;
+    options.band_rows = 3;
+    std::size_t rows_seen = 0;
+    options.on_rows = [&](std::size_t, std::size_t rows, const StabilityClass*) {
+        rows_seen += rows;
+    };
+    const DigitalStabilityMap map = rasterize_digital_stability(waveform, spec, options);
+    ASSERT_TRUE(map.complete);
+    EXPECT_EQ(rows_seen, spec.a_cells);
+    for (std::size_t row = 0; row < spec.a_cells; ++row) {
+        for (std::size_t column = 0; column < spec.q_cells; ++column) {
+            const double q = spec.cell_q(column);
+            const double a = spec.cell_a(row);
+            ASSERT_EQ(map.at(column, row), classify_digital_stability(waveform, q, a));
+            const double beta = map.beta_x[row * spec.q_cells + column];
+            const double expected = digital_beta(waveform, q, a);
+            if (std::isnan(expected))
+                EXPECT_TRUE(std::isnan(beta));
+            else
+                EXPECT_DOUBLE_EQ(beta, expected);
+        }
+    }
+
+    const DigitalStabilityMap trap = rasterize_digital_stability<PaulTrap3D>(waveform, spec);
+    EXPECT_EQ(trap.at(20, 11), classify_digital_stability<PaulTrap3D>(waveform, 0.5, 0.0));
+}
+
+TEST(DigitalDriveTest, CancelLeavesMapIncomplete) {
+    std::atomic<bool> cancel(true);
+    DigitalStabilityMapOptions options;
+    options.cancel = &cancel;
+    const DigitalStabilityMap map = rasterize_digital_stability(
+        PiecewiseWaveform::rectangular(0.5), StabilityMapSpec{0.0, 1.0, 10, 0.0, 0.2, 10},
+        options);
+    EXPECT_FALSE(map.complete);
+}
+
+TEST(DigitalDriveTest, RejectsInvalidWaveforms) {
+    EXPECT_THROW(PiecewiseWaveform({}), std::invalid_argument);
+    EXPECT_THROW(PiecewiseWaveform({{0.0, 1.0}}), std::invalid_argument);
+    EXPECT_THROW(PiecewiseWaveform({{0.5, NAN}}), std::invalid_argument);
+    EXPECT_THROW(PiecewiseWaveform::rectangular(1.0), std::invalid_argument);
+    EXPECT_THROW(rasterize_digital_stability(PiecewiseWaveform::rectangular(0.5),
+                                             StabilityMapSpec{0.0, 1.0, 0, 0.0, 0.2, 10}),
+                 std::invalid_argument);
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "mathieu_lib/characteristic.h"
+#include "mathieu_lib/hill_equation.h"
+using namespace mathieu_lib;
+
+namespace {
+
+auto pure_cosine() -> FourierWaveform {
+    FourierWaveform waveform;
+    waveform.cosines = {1.0};
+    return waveform;
+}
+
+}  // namespace
+
+TEST(HillEquationTest, CosineBandEdgesAreCharacteristicValues) {
+    const HillEquation hill(pure_cosine());
+    for (double q : {0.0, 0.3, 0.706, 1.0, 5.0}) {
+        for (int r = 0; r < 4; ++r) {
+            const auto [lower, upper] = hill.band_edges(r, q);
+            EXPECT_NEAR(lower, characteristic_a(r, q), 1e-10) << r << " " << q;
+            EXPECT_NEAR(upper, characteristic_b(r + 1, q), 1e-10) << r << " " << q;
+        }
+    }
+}
+
+TEST(HillEquationTest, PhaseShiftLeavesBandsUnchanged) {
+    // cos 2(xi + phi) has sine terms but the same spectrum as cos 2xi
+    const double phi = 0.4;
+    FourierWaveform shifted;
+    shifted.cosines = {std::cos(2.0 * phi)};
+    shifted.sines = {-std::sin(2.0 * phi)};
+    const HillEquation hill(shifted);
+    for (double q : {0.4, 0.8}) {
+        const auto [lower, upper] = hill.band_edges(0, q);
+        EXPECT_NEAR(lower, characteristic_a(0, q), 1e-10);
+        EXPECT_NEAR(upper, characteristic_b(1, q), 1e-10);
+        EXPECT_NEAR(hill.beta(q, 0.5 * (lower + upper)),
+                    HillEquation(pure_cosine()).beta(q, 0.5 * (lower + upper)), 1e-9);
+    }
+}
+
+TEST(HillEquationTest, MonodromyMatchesBandEdges) {
+    // 5% third harmonic, the kind of distortion that moves the apex
+    FourierWaveform distorted;
+    distorted.cosines = {1.0, 0.0, 0.05};
+    distorted.sines = {0.0, 0.02};
+    const HillEquation hill(distorted);
+    for (double q : {0.3, 0.7, 0.85}) {
+        const auto [lower, upper] = hill.band_edges(0, q);
+        EXPECT_NEAR(hill.monodromy(q, lower).trace(), 2.0, 1e-7) << q;
+        EXPECT_NEAR(hill.monodromy(q, upper).trace(), -2.0, 1e-7) << q;
+        const TransferMatrix m = hill.monodromy(q, 0.5 * (lower + upper));
+        EXPECT_NEAR(m.m11 * m.m22 - m.m12 * m.m21, 1.0, 1e-12);
+    }
+    // The distortion moves the first region's edges away from the Mathieu ones
+    EXPECT_GT(std::abs(hill.band_edges(0, 0.7).second - characteristic_b(1, 0.7)), 1e-4);
+}
+
+TEST(HillEquationTest, ClassifyMatchesMathieuForCosine) {
+    const HillEquation hill(pure_cosine());
+    for (double q : {0.2, 0.5, 0.8}) {
+        for (double a : {-0.2, -0.05, 0.05, 0.2}) {
+            EXPECT_EQ(hill.classify(q, a), classify_stability(q, a)) << q << " " << a;
+            EXPECT_EQ(hill.classify<PaulTrap3D>(q, a),
+                      (classify_stability<double, PaulTrap3D>(q, a)))
+                << q << " " << a;
+        }
+    }
+}
+
+TEST(HillEquationTest, TrajectoryFollowsMonodromy) {
+    const HillEquation hill(pure_cosine(), 128);
+    const HillTrajectory path = hill.trajectory(0.5, 0.05, 1.0, 0.0, 3);
+    ASSERT_EQ(path.u.size(), 3 * 128 + 1u);
+    EXPECT_NEAR(path.xi.back(), 3.0 * M_PI, 1e-12);
+    const TransferMatrix m = hill.monodromy(0.5, 0.05);
+    EXPECT_NEAR(path.u[128], m.m11, 1e-12);
+    EXPECT_NEAR(path.du[128], m.m21, 1e-12);
+    // Stable motion stays bounded
+    for (double u : path.u) EXPECT_LT(std::abs(u), 10.0);
+}
+
+TEST(HillEquationTest, RejectsInvalidInput) {
+    EXPECT_THROW(HillEquation(pure_cosine(), 0), std::invalid_argument);
+    FourierWaveform bad;
+    bad.cosines = {NAN};
+    EXPECT_THROW(HillEquation{bad}, std::invalid_argument);
+    EXPECT_THROW(HillEquation(pure_cosine()).band_edges(-1, 0.5), std::invalid_argument);
+}
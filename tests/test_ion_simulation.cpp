@@ -0,0 +1,327 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "mathieu_lib/acceptance.h"
+#include "mathieu_lib/ion_simulation.h"
+#include "mathieu_lib/mathieu.h"
+using namespace mathieu_lib;
+
+namespace {
+
+// Spec putting an ion of m/z 1000 at (q, a)
+auto spec_for(double q, double a) -> IonSimulationSpec {
+    IonSimulationSpec spec;
+    const QuadrupoleParams params(spec.frequency, spec.quad_radius, 1.0);
+    spec.voltage_rf = q / mathieu_q(1.0, 1, params);
+    spec.voltage_dc = a / mathieu_a(1.0, 1, params);
+    return spec;
+}
+
+}  // namespace
+
+TEST(IonSimulationTest, CollisionFreeMotionFollowsMathieu) {
+    IonSimulationSpec spec = spec_for(0.6, 0.02);
+    spec.steps_per_period = 256;
+    spec.periods = 3;
+    IonEnsemble ions;
+    ions.resize(1);
+    ions.mz[0] = 1000.0;
+    ions.x[0] = 1e-4;
+    ions.y[0] = 2e-4;
+    ions.dz[0] = 1e-3;
+    const IonSimulationSummary summary = simulate_ions(spec, ions);
+    EXPECT_EQ(summary.transmitted, 1u);
+
+    const HillEquation hill(FourierWaveform{0.0, {1.0}, {}}, 256);
+    const HillTrajectory x = hill.trajectory(0.6, 0.02, 1e-4, 0.0, 3);
+    const HillTrajectory y = hill.trajectory(-0.6, -0.02, 2e-4, 0.0, 3);
+    EXPECT_NEAR(ions.x[0], x.u.back(), 1e-3 * 1e-4);
+    EXPECT_NEAR(ions.dx[0], x.du.back(), 1e-3 * 1e-4);
+    EXPECT_NEAR(ions.y[0], y.u.back(), 1e-3 * 2e-4);
+    EXPECT_NEAR(ions.z[0], 3.0 * M_PI * 1e-3, 1e-12);
+}
+
+TEST(IonSimulationTest, AnionsSwapTheXAndYEquations) {
+    // z = -1 flips the signs of q and a, so with DC on an anion's x motion follows the
+    // cation's y equation and vice versa
+    IonSimulationSpec spec = spec_for(0.6, 0.02);
+    spec.steps_per_period = 256;
+    spec.periods = 3;
+    spec.charge_state = -1;
+    IonEnsemble ions;
+    ions.resize(1);
+    ions.mz[0] = 1000.0;
+    ions.x[0] = 1e-4;
+    ions.y[0] = 2e-4;
+    EXPECT_EQ(simulate_ions(spec, ions).transmitted, 1u);
+
+    const HillEquation hill(FourierWaveform{0.0, {1.0}, {}}, 256);
+    const HillTrajectory x = hill.trajectory(-0.6, -0.02, 1e-4, 0.0, 3);
+    const HillTrajectory y = hill.trajectory(0.6, 0.02, 2e-4, 0.0, 3);
+    EXPECT_NEAR(ions.x[0], x.u.back(), 1e-3 * 1e-4);
+    EXPECT_NEAR(ions.dx[0], x.du.back(), 1e-3 * 1e-4);
+    EXPECT_NEAR(ions.y[0], y.u.back(), 1e-3 * 2e-4);
+
+    // ... which differs from the cation's trajectory from the same start
+    spec.charge_state = 1;
+    IonEnsemble cations;
+    cations.resize(1);
+    cations.mz[0] = 1000.0;
+    cations.x[0] = 1e-4;
+    cations.y[0] = 2e-4;
+    simulate_ions(spec, cations);
+    EXPECT_GT(std::abs(ions.x[0] - cations.x[0]), 1e-2 * 1e-4);
+}
+
+TEST(IonSimulationTest, UnstableIonsAreLost) {
+    IonSimulationSpec spec = spec_for(0.95, 0.0);
+    IonEnsemble ions;
+    ions.resize(3);
+    ions.mz = {1000.0, 1000.0, 5000.0};  // the heavy ion sits at q = 0.19
+    ions.x = {1e-5, 0.0, 1e-5};
+    ions.y = {0.0, 1e-5, 1e-5};
+    const IonSimulationSummary summary = simulate_ions(spec, ions);
+    EXPECT_EQ(summary.lost, 2u);
+    EXPECT_EQ(summary.transmitted, 1u);
+    EXPECT_GT(ions.lost_at[0], 0.0);
+    EXPECT_GE(std::abs(ions.x[0]), spec.quad_radius);  // position at the rod is kept
+    EXPECT_TRUE(std::isnan(ions.lost_at[2]));
+
+    // Lost ions are not advanced again
+    const double lost_at = ions.lost_at[0];
+    simulate_ions(spec, ions);
+    EXPECT_EQ(ions.lost_at[0], lost_at);
+}
+
+TEST(IonSimulationTest, ViscousDragDampsTheInvariant) {
+    IonSimulationSpec spec = spec_for(0.5, 0.0);
+    spec.periods = 50;
+    spec.collisions = CollisionModel::Viscous;
+    spec.gas.pressure = 5.0;
+    IonEnsemble ions;
+    ions.resize(1);
+    ions.mz[0] = 1000.0;
+    ions.x[0] = 1e-3;
+    const HillEquation hill(FourierWaveform{0.0, {1.0}, {}}, spec.steps_per_period);
+    const AcceptanceTable table(hill, 0.5, 0.0, 5e-3);
+    const double before = table.x().twiss[0].invariant(ions.x[0], ions.dx[0]);
+    simulate_ions(spec, ions);
+    const double after = table.x().twiss[0].invariant(ions.x[0], ions.dx[0]);
+    const double gamma = drag_rate(1000.0, 1, spec.gas);
+    EXPECT_NEAR(after / before, std::exp(-gamma * spec.periods / spec.frequency), 0.03);
+    EXPECT_LT(after, 0.9 * before);
+}
+
+TEST(IonSimulationTest, HardSphereCollisionsThermalize) {
+    IonSimulationSpec spec = spec_for(0.3, 0.0);
+    spec.periods = 150;
+    spec.collisions = CollisionModel::HardSphere;
+    spec.gas.pressure = 20.0;
+    spec.gas.mass = 4.0;
+    const std::size_t n = 1000;
+    IonEnsemble ions;
+    ions.resize(n);
+    const double mass = 1000.0 / (AVOGADRO_NUMBER * 1000);
+    const double scale = M_PI * spec.frequency;  // velocity per unit slope
+    const double launch = std::sqrt(2.0 * 0.5 * E_CHARGE / mass) / scale;  // 0.5 eV axial
+    for (std::size_t i = 0; i < n; ++i) {
+        ions.mz[i] = 1000.0;
+        ions.dz[i] = launch;
+    }
+    IonEnsemble copy = ions;
+
+    ThreadPool one(1);
+    ThreadPool four(4);
+    IonSimulationOptions options;
+    options.seed = 7;
+    options.pool = &one;
+    EXPECT_EQ(simulate_ions(spec, ions, options).transmitted, n);
+    options.pool = &four;
+    simulate_ions(spec, copy, options);
+    EXPECT_EQ(ions.dz, copy.dz);  // independent of the thread count
+
+    double energy = 0.0;
+    for (double dz : ions.dz) energy += 0.5 * mass * dz * dz * scale * scale;
+    energy /= n;
+    const double thermal = 0.5 * BOLTZMANN * spec.gas.temperature;
+    EXPECT_NEAR(energy, thermal, 0.15 * thermal);
+}
+
+TEST(IonSimulationTest, ResonantExcitationEjectsTheTargetMass) {
+    IonSimulationSpec spec = spec_for(0.4, 0.0);
+    spec.periods = 150;
+    spec.steps_per_period = 32;
+    IonEnsemble ions;
+    ions.resize(20);
+    for (std::size_t i = 0; i < ions.size(); ++i) {
+        ions.mz[i] = i % 2 == 0 ? 1000.0 : 1200.0;  // q = 0.4 and 0.333
+        ions.x[i] = 1e-5 * static_cast<double>(i % 5);
+        ions.y[i] = 1e-4;
+    }
+    const HillEquation hill(FourierWaveform{0.0, {1.0}, {}}, 64);
+    // Secular frequency beta f / 2 from the exact characteristic exponent
+    const double target = 0.5 * hill.beta(0.4, 0.0) * spec.frequency;
+    const double other = 0.5 * hill.beta(0.4 / 1.2, 0.0) * spec.frequency;
+    const EjectionMap map = sweep_excitation(spec, ions, {target, other}, {0.0, 20.0});
+    ASSERT_EQ(map.mz, (std::vector<double>{1000.0, 1200.0}));
+    ASSERT_EQ(map.efficiency.size(), 8u);
+    EXPECT_FALSE(map.cancelled);
+    for (std::size_t f = 0; f < 2; ++f) {
+        for (std::size_t m = 0; m < 2; ++m) {
+            EXPECT_EQ(map.efficiency[map.index(0, f, m)], 0.0);
+            EXPECT_TRUE(std::isnan(map.ejection_time[map.index(0, f, m)]));
+        }
+    }
+    // Each drive ejects only the species it is tuned to
+    EXPECT_EQ(map.efficiency[map.index(1, 0, 0)], 1.0);
+    EXPECT_EQ(map.efficiency[map.index(1, 0, 1)], 0.0);
+    EXPECT_EQ(map.efficiency[map.index(1, 1, 0)], 0.0);
+    EXPECT_EQ(map.efficiency[map.index(1, 1, 1)], 1.0);
+    const double run = spec.periods / spec.frequency;
+    EXPECT_GT(map.ejection_time[map.index(1, 0, 0)], 0.0);
+    EXPECT_LT(map.ejection_time[map.index(1, 0, 0)], run);
+    EXPECT_TRUE(std::all_of(ions.lost_at.begin(), ions.lost_at.end(),
+                            [](double xi) { return std::isnan(xi); }));  // input untouched
+
+    // The sweep agrees with a plain run at the same drive
+    spec.excitation.frequency = target;
+    spec.excitation.amplitude = 20.0;
+    IonEnsemble run_ions = ions;
+    const IonSimulationSummary summary = simulate_ions(spec, run_ions);
+    EXPECT_EQ(summary.lost, 10u);
+    double mean = 0.0;
+    for (std::size_t i = 0; i < ions.size(); i += 2) mean += run_ions.lost_at[i];
+    mean = mean / 10.0 * 2.0 / (2.0 * M_PI * spec.frequency);
+    EXPECT_NEAR(map.ejection_time[map.index(1, 0, 0)], mean, 1e-12);
+}
+
+TEST(IonSimulationTest, EntranceFringeFollowsTheRampedEquation) {
+    IonSimulationSpec spec = spec_for(0.7, 0.1);
+    spec.periods = 20;
+    spec.steps_per_period = 256;
+    spec.fringe.rf_length = 1.5;
+    spec.fringe.dc_length = 2.5;  // 18 fringe cycles, then 2 ideal ones
+    IonEnsemble ions;
+    ions.resize(1);
+    ions.mz[0] = 1000.0;
+    ions.x[0] = 2e-4;
+    ions.dy[0] = 1e-4;
+    ions.dz[0] = 1e-3;
+    IonEnsemble ideal = ions;
+    simulate_ions(spec, ions);
+
+    // Reference: RK4 on u'' + (a s_dc - 2 q s_rf cos 2xi) u = 0 with s = 1 - exp(-xi / (pi L))
+    const auto reference = [&](double sign, double u, double du) {
+        const auto k = [&](double xi) {
+            const double t = xi / M_PI;
+            return sign * (0.1 * (1.0 - std::exp(-t / 2.5)) -
+                           2.0 * 0.7 * (1.0 - std::exp(-t / 1.5)) * std::cos(2.0 * xi));
+        };
+        const int steps = 20 * 4096;
+        const double h = 20.0 * M_PI / steps;
+        for (int i = 0; i < steps; ++i) {
+            const double xi = i * h;
+            const double k1u = du, k1v = -k(xi) * u;
+            const double k2u = du + 0.5 * h * k1v, k2v = -k(xi + 0.5 * h) * (u + 0.5 * h * k1u);
+            const double k3u = du + 0.5 * h * k2v, k3v = -k(xi + 0.5 * h) * (u + 0.5 * h * k2u);
+            const double k4u = du + h * k3v, k4v = -k(xi + h) * (u + h * k3u);
+            u += h / 6.0 * (k1u + 2.0 * k2u + 2.0 * k3u + k4u);
+            du += h / 6.0 * (k1v + 2.0 * k2v + 2.0 * k3v + k4v);
+        }
+        return std::make_pair(u, du);
+    };
+    const auto x = reference(1.0, 2e-4, 0.0);
+    const auto y = reference(-1.0, 0.0, 1e-4);
+    EXPECT_NEAR(ions.x[0], x.first, 5e-7);
+    EXPECT_NEAR(ions.dx[0], x.second, 5e-7);
+    EXPECT_NEAR(ions.y[0], y.first, 5e-7);
+    EXPECT_NEAR(ions.dy[0], y.second, 5e-7);
+    EXPECT_NEAR(ions.z[0], 20.0 * M_PI * 1e-3, 1e-12);
+
+    // Against the ideal entrance, the fringe changes the exit state
+    IonSimulationSpec ideal_spec = spec;
+    ideal_spec.fringe = FringeField();
+    simulate_ions(ideal_spec, ideal);
+    EXPECT_GT(std::abs(ions.x[0] - ideal.x[0]), 1e-2 * 2e-4);
+
+    spec.fringe.dc_length = -1.0;
+    EXPECT_THROW(simulate_ions(spec, ions), std::invalid_argument);
+}
+
+TEST(IonSimulationTest, SpaceChargeDefocusesTheCloud) {
+    IonSimulationSpec spec = spec_for(0.3, 0.0);
+    spec.periods = 10;
+    spec.space_charge.update_periods = 3;  // epochs of 3, 3, 3 and 1 periods
+    IonEnsemble ions;
+    const std::size_t n = 600;  // three blocks
+    ions.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        // Equal-area rings of radius up to 1 mm
+        const double r = 1e-3 * std::sqrt((i / 20 + 0.5) / 30.0);
+        const double phi = 2.0 * M_PI * static_cast<double>(i % 20) / 20.0;
+        ions.mz[i] = 1000.0;
+        ions.x[i] = r * std::cos(phi);
+        ions.y[i] = r * std::sin(phi);
+    }
+    const auto rms_x = [](const IonEnsemble& e) {
+        double sum = 0.0;
+        for (double x : e.x) sum += x * x;
+        return std::sqrt(sum / e.x.size());
+    };
+    IonEnsemble bare = ions;
+    simulate_ions(spec, bare);
+
+    // A vanishing charge reproduces the bare run through the epochs
+    IonEnsemble faint = ions;
+    spec.space_charge.ions_per_particle = 1e-6;
+    simulate_ions(spec, faint);
+    for (std::size_t i = 0; i < n; i += 37) {
+        EXPECT_NEAR(faint.x[i], bare.x[i], 1e-9 * 1e-3);
+        EXPECT_NEAR(faint.dy[i], bare.dy[i], 1e-9 * 1e-3);
+    }
+
+    // 3e7 ions over 5 cm shift a by about -0.02: the cloud swells and the progress counts
+    // every epoch
+    IonEnsemble dense = ions;
+    spec.space_charge.ions_per_particle = 5e4;
+    std::size_t reports = 0;
+    IonSimulationOptions options;
+    options.progress = [&](std::uint64_t, std::uint64_t total) {
+        ++reports;
+        EXPECT_EQ(total, 12u);
+    };
+    const IonSimulationSummary summary = simulate_ions(spec, dense, options);
+    EXPECT_FALSE(summary.cancelled);
+    EXPECT_EQ(reports, 12u);
+    EXPECT_GT(rms_x(dense), 1.05 * rms_x(bare));
+
+    EXPECT_THROW(sweep_excitation(spec, ions, {1e5}, {1.0}), std::invalid_argument);
+    spec.space_charge.cloud_length = 0.0;
+    EXPECT_THROW(simulate_ions(spec, dense), std::invalid_argument);
+}
+
+TEST(IonSimulationTest, CollisionRatesAndValidation) {
+    BufferGas gas;
+    gas.pressure = 1.0;
+    const double rate = collision_rate(28.0, 1, gas);
+    const double n = 1.0 / (BOLTZMANN * 300.0);
+    const double reduced = 14.0 / (AVOGADRO_NUMBER * 1000);
+    EXPECT_NEAR(rate, n * 1e-18 * std::sqrt(8.0 * BOLTZMANN * 300.0 / (M_PI * reduced)),
+                1e-9 * rate);
+    EXPECT_NEAR(drag_rate(28.0, 1, gas), 0.5 * rate, 1e-9 * rate);
+    // Doubly charged m/z 14 is the same ion mass as singly charged 28
+    EXPECT_NEAR(collision_rate(14.0, 2, gas), rate, 1e-9 * rate);
+
+    IonEnsemble ions;
+    ions.resize(2);
+    ions.x.pop_back();
+    EXPECT_THROW(simulate_ions(IonSimulationSpec(), ions), std::invalid_argument);
+    ions.resize(2);
+    IonSimulationSpec spec;
+    spec.steps_per_period = 0;
+    EXPECT_THROW(simulate_ions(spec, ions), std::invalid_argument);
+}
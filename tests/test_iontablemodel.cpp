@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+#include "ions/IonTableModel.h"
+
+static int argc = 0;
+static char* argv[] = {nullptr};
+static QCoreApplication app(argc, argv);
+
+namespace {
+void waitForSort(const IonTableModel& model) {
+    QElapsedTimer timer;
+    timer.start();
+    while (model.isSorting() && timer.elapsed() < 5000) QCoreApplication::processEvents();
+}
+
+}  // namespace
+
+TEST(IonTableModelTest, LazyRowsMatchLibrary) {
+    IonTableModel model;
+    model.setIons({100.0, 500.0, 1000.0}, {1, 2, 1});
+    mathieu_lib::QuadrupoleParams params(1e6, 0.005, 0.0);
+    model.setOperatingPoint(500.0, 0.0, params);
+    ASSERT_EQ(model.rowCount(), 3);
+    double q = model.data(model.index(1, IonTableModel::QColumn)).toString().toDouble();
+    EXPECT_NEAR(q, mathieu_lib::mathieu_q_from_mz(500.0, params, {500.0})[0], 1e-3);
+    EXPECT_EQ(model.data(model.index(1, IonTableModel::ChargeColumn)).toInt(), 2);
+}
+
+TEST(IonTableModelTest, BackgroundSortByMz) {
+    IonTableModel model;
+    model.setIons({300.0, 100.0, 200.0}, {1, 1, 1});
+    model.sort(IonTableModel::MzColumn, Qt::DescendingOrder);
+    waitForSort(model);
+    ASSERT_FALSE(model.isSorting());
+    EXPECT_EQ(model.data(model.index(0, IonTableModel::MzColumn)).toString().toDouble(), 300.0);
+    EXPECT_EQ(model.data(model.index(2, IonTableModel::MzColumn)).toString().toDouble(), 100.0);
+}
+
+TEST(IonTableModelTest, BackgroundSortByMargin) {
+    IonTableModel model;
+    model.setIons({50.0, 150.0, 400.0, 2000.0}, {1, 1, 1, 1});
+    model.setOperatingPoint(300.0, 20.0, mathieu_lib::QuadrupoleParams(1e6, 0.005, 0.0));
+    model.sort(IonTableModel::DeltaEColumn, Qt::AscendingOrder);
+    waitForSort(model);
+    ASSERT_FALSE(model.isSorting());
+    double previous = -1e9;
+    for (int row = 0; row < model.rowCount(); ++row) {
+        double value =
+            model.data(model.index(row, IonTableModel::DeltaEColumn)).toString().toDouble();
+        EXPECT_GE(value, previous);
+        previous = value;
+    }
+}
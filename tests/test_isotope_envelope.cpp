@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "mathieu_lib/isotope_envelope.h"
+#include "mathieu_lib/mathieu.h"
+using namespace mathieu_lib;
+
+TEST(IsotopeEnvelopeTest, ParsesFormulas) {
+    const std::vector<ElementCount> glucose = parse_formula("C6H12O6");
+    ASSERT_EQ(glucose.size(), 3u);
+    EXPECT_EQ(glucose[0].symbol, "C");
+    EXPECT_EQ(glucose[0].count, 6);
+    EXPECT_EQ(glucose[2].symbol, "O");
+
+    // Groups multiply and repeated elements merge
+    const std::vector<ElementCount> salt = parse_formula("Ca(OH)2 H2O");
+    ASSERT_EQ(salt.size(), 3u);
+    EXPECT_EQ(salt[0].symbol, "Ca");
+    EXPECT_EQ(salt[1].symbol, "O");
+    EXPECT_EQ(salt[1].count, 3);
+    EXPECT_EQ(salt[2].count, 4);
+
+    EXPECT_THROW(parse_formula("Xx2"), std::invalid_argument);
+    EXPECT_THROW(parse_formula("C(H2"), std::invalid_argument);
+    EXPECT_THROW(parse_formula("c6"), std::invalid_argument);
+    EXPECT_THROW(parse_formula(""), std::invalid_argument);
+    // The limit applies to the combined count, not each number
+    EXPECT_EQ(parse_formula("(C1000)1000")[0].count, 1000000);
+    EXPECT_THROW(parse_formula("(C1000000)1000000"), std::invalid_argument);
+    EXPECT_THROW(parse_formula("(C1000)1000C"), std::invalid_argument);
+}
+
+TEST(IsotopeEnvelopeTest, SmallPatternsAreExact) {
+    // Cl2: binomial over 35Cl / 37Cl
+    const IsotopeEnvelope chlorine = isotope_envelope("Cl2");
+    ASSERT_EQ(chlorine.size(), 3u);
+    EXPECT_NEAR(chlorine.mass[0], 2 * 34.96885268, 1e-9);
+    EXPECT_NEAR(chlorine.abundance[0], 0.7576 * 0.7576, 1e-12);
+    EXPECT_NEAR(chlorine.abundance[1], 2 * 0.7576 * 0.2424, 1e-12);
+    EXPECT_NEAR(chlorine.abundance[2], 0.2424 * 0.2424, 1e-12);
+
+    // Glucose at nominal resolution: M+1 / M is the sum of single substitutions
+    IsotopeOptions nominal;
+    nominal.merge_width = 0.5;
+    const IsotopeEnvelope glucose = isotope_envelope("C6H12O6", nominal);
+    ASSERT_GE(glucose.size(), 3u);
+    EXPECT_NEAR(glucose.mass[0], 180.0633881, 1e-6);
+    const double mono = std::pow(0.9893, 6) * std::pow(0.999885, 12) * std::pow(0.99757, 6);
+    EXPECT_NEAR(glucose.abundance[0], mono, 1e-12);
+    const double m1 = 6 * 0.0107 / 0.9893 + 12 * 0.000115 / 0.999885 + 6 * 0.00038 / 0.99757;
+    EXPECT_NEAR(glucose.abundance[1] / glucose.abundance[0], m1, 1e-9);
+
+    // They lie within 3 mDa; at 0.1 mDa M+1 splits into its 13C, 17O and 2H lines
+    IsotopeOptions fine_options;
+    fine_options.merge_width = 1e-4;
+    const IsotopeEnvelope fine = isotope_envelope("C6H12O6", fine_options);
+    const auto m1_lines = std::count_if(fine.mass.begin(), fine.mass.end(), [&](double m) {
+        return std::abs(m - glucose.mass[0] - 1.0) < 0.5;
+    });
+    EXPECT_EQ(m1_lines, 3);
+    EXPECT_NEAR(fine.abundance[0], mono, 1e-12);
+}
+
+TEST(IsotopeEnvelopeTest, ProteinEnvelopeKeepsMassAndAbundance) {
+    // Human insulin; average mass from the standard atomic weights
+    const IsotopeEnvelope insulin = isotope_envelope("C257H383N65O77S6");
+    const double total = std::accumulate(insulin.abundance.begin(), insulin.abundance.end(), 0.0);
+    EXPECT_NEAR(total, 1.0, 1e-3);  // less the pruned tails
+    double mean = 0.0;
+    for (std::size_t i = 0; i < insulin.size(); ++i) mean += insulin.mass[i] * insulin.abundance[i];
+    mean /= total;
+    const double average =
+        257 * 12.0107 + 383 * 1.00794 + 65 * 14.0067 + 77 * 15.9994 + 6 * 32.065;
+    EXPECT_NEAR(mean, average, 0.05);
+    EXPECT_TRUE(std::is_sorted(insulin.mass.begin(), insulin.mass.end()));
+    // The monoisotopic peak is no longer the tallest at this size
+    EXPECT_NE(std::max_element(insulin.abundance.begin(), insulin.abundance.end()),
+              insulin.abundance.begin());
+}
+
+TEST(IsotopeEnvelopeTest, TransmissionAcrossChargeStates) {
+    const IsotopeEnvelope chlorine = isotope_envelope("Cl2");
+    const MassList list = envelope_mass_list(chlorine, {1, 2, -1});
+    ASSERT_EQ(list.size(), 9u);
+    EXPECT_NEAR(list.mz[0], chlorine.mass[0] + PROTON_MASS, 1e-12);
+    EXPECT_NEAR(list.mz[3], (chlorine.mass[0] + 2 * PROTON_MASS) / 2.0, 1e-12);
+    EXPECT_NEAR(list.mz[6], chlorine.mass[0] - PROTON_MASS, 1e-12);
+    EXPECT_EQ(list.charge_state[4], 2);
+    EXPECT_EQ(list.intensity[5], chlorine.abundance[2]);
+
+    // RF-only, with q = MAX_Q between the first two peaks of the singly charged envelope:
+    // the lighter monoisotopic peak sits above the cutoff and is lost, doubly charged ions
+    // are all lost
+    const QuadrupoleParams params(1e6, 5e-3, 1.0);
+    const double cutoff_mz = 0.5 * (list.mz[0] + list.mz[1]);
+    const double voltage_rf = 0.908 / mathieu_q_from_mz(1.0, params, {cutoff_mz})[0];
+    const std::vector<double> transmission =
+        envelope_transmission(chlorine, {1, 2}, voltage_rf, 0.0, params);
+    ASSERT_EQ(transmission.size(), 2u);
+    EXPECT_NEAR(transmission[0], 1.0 - 0.7576 * 0.7576, 1e-12);
+    EXPECT_EQ(transmission[1], 0.0);
+
+    EXPECT_THROW(envelope_mass_list(chlorine, {0}), std::invalid_argument);
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "mathieu_lib/mass_list.h"
+#include "mathieu_lib/mathieu.h"
+using namespace mathieu_lib;
+
+constexpr double EPSILON = 1e-9;
+
+TEST(MassListTest, ParsesColumnsAndSkipsHeaders) {
+    const std::string text =
+        "mz,charge,intensity\n"
+        "100.5,1,1000\r\n"
+        "# comment\n"
+        "\n"
+        "250.25\t2\t5e3\n"
+        "1.5e3 3\n";
+    MassList list = parse_mass_list(text.data(), text.size());
+    ASSERT_EQ(list.size(), 3u);
+    EXPECT_NEAR(list.mz[0], 100.5, EPSILON);
+    EXPECT_EQ(list.charge_state[1], 2);
+    EXPECT_NEAR(list.intensity[1], 5000.0, EPSILON);
+    EXPECT_NEAR(list.mz[2], 1500.0, EPSILON);
+    EXPECT_EQ(list.charge_state[2], 3);
+    EXPECT_NEAR(list.intensity[2], 1.0, EPSILON);  // default when the column is absent
+}
+
+TEST(MassListTest, ParallelChunksKeepFileOrder) {
+    std::string text;
+    for (int i = 1; i <= 5000; ++i)
+        text += std::to_string(i) + ".25," + std::to_string(i % 4 + 1) + "\n";
+    MassListImportOptions options;
+    options.chunk_bytes = 97;  // force many chunks that start mid-line
+    ThreadPool pool(4);
+    options.pool = &pool;
+    std::size_t last_progress = 0;
+    options.progress = [&](std::size_t done, std::size_t total) {
+        EXPECT_LE(done, total);
+        last_progress = done;
+    };
+    MassList list = parse_mass_list(text.data(), text.size(), options);
+    ASSERT_EQ(list.size(), 5000u);
+    for (int i = 0; i < 5000; ++i) {
+        EXPECT_NEAR(list.mz[i], (i + 1) + 0.25, EPSILON);
+        EXPECT_EQ(list.charge_state[i], (i + 1) % 4 + 1);
+    }
+    EXPECT_EQ(last_progress, text.size());
+}
+
+TEST(MassListTest, ImportFromMappedFileFeedsBatchKernels) {
+    const std::string path = ::testing::TempDir() + "mass_list_test.tsv";
+    {
+        std::ofstream out(path);
+        out << "500\t1\t10\n1000\t2\t20\n";
+    }
+    MassList list = import_mass_list(path);
+    std::remove(path.c_str());
+    ASSERT_EQ(list.size(), 2u);
+    QuadrupoleParams params(1e6, 0.005, 0.0);
+    std::vector<double> q(list.size());
+    mathieu_q_from_mz(1000.0, params, list.mz.data(), list.size(), q.data());
+    EXPECT_NEAR(q[0], 2.0 * q[1], EPSILON);
+}
+
+TEST(MassListTest, CancelThrows) {
+    std::string text(1 << 16, '\n');
+    std::atomic<bool> cancel{true};
+    MassListImportOptions options;
+    options.cancel = &cancel;
+    EXPECT_THROW(parse_mass_list(text.data(), text.size(), options), ImportCancelled);
+}
+
+TEST(MassListTest, MissingFileThrows) {
+    EXPECT_THROW(import_mass_list("/nonexistent/mass_list.csv"), std::runtime_error);
+}
@@ -82,6 +82,34 @@ TEST(MathieuTest, NegativeInputs) {
     EXPECT_LT(mathieu_lib::mathieu_a(-500.0, -1, params), 0.0);
 }
 
+// 3D Paul trap
+TEST(MathieuTest, IdealPaulTrapMatchesQuadrupoleScaling) {
+    // r0^2 = 2 z0^2: q_z equals the quadrupole q for the same r0 and a_z = -a
+    const double r0 = 0.01;
+    mathieu_lib::PaulTrapParams trap(1e6, r0, r0 / std::sqrt(2.0), 0.5);
+    mathieu_lib::QuadrupoleParams quad(1e6, r0, 0.5);
+    EXPECT_NEAR(mathieu_lib::mathieu_q(1000.0, 1, trap), mathieu_lib::mathieu_q(1000.0, 1, quad),
+                1e-12);
+    EXPECT_NEAR(mathieu_lib::mathieu_a(50.0, 1, trap), -mathieu_lib::mathieu_a(50.0, 1, quad),
+                1e-12);
+}
+
+TEST(MathieuTest, PaulTrapMzInvertsQ) {
+    mathieu_lib::PaulTrapParams trap(1.1e6, 0.01, 0.0078, 0.609);  // 609 Da
+    const double q = mathieu_lib::mathieu_q(1500.0, 1, trap);
+    EXPECT_NEAR(mathieu_lib::mz(1500.0, 1, trap, q), 609.0, 1e-9);
+
+    const double mzs[] = {609.0, 1218.0};
+    double qs[2];
+    double as[2];
+    mathieu_lib::mathieu_q_from_mz(1500.0, trap, mzs, 2, qs);
+    mathieu_lib::mathieu_a_from_mz(20.0, trap, mzs, 2, as);
+    EXPECT_NEAR(qs[0], q, 1e-12);
+    EXPECT_NEAR(qs[1], q / 2, 1e-12);
+    EXPECT_NEAR(as[0], mathieu_lib::mathieu_a(20.0, 1, trap), 1e-12);
+    EXPECT_LT(as[0], 0.0);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include <cmath>
+#include <limits>
 #include <vector>
 
 #ifndef M_PI
@@ -103,6 +104,47 @@ TEST(MathieuVectorTest, SecularFrequencyVector) {
     EXPECT_GT(result[1], 0.0);
 }
 
+TEST(MathieuVectorTest, MathieuQAFromMzBroadcast) {
+    QuadrupoleParams params(1e6, 0.01, 0.0);
+    std::vector<double> mzs{100.0, 500.0, 1500.0};
+    auto q = mathieu_q_from_mz(1000.0, params, mzs);
+    auto a = mathieu_a_from_mz(50.0, params, mzs);
+    ASSERT_EQ(q.size(), mzs.size());
+    ASSERT_EQ(a.size(), mzs.size());
+    for (size_t i = 0; i < mzs.size(); ++i) {
+        // Same ion expressed through the per-ion kernels (molar mass in kg/mol)
+        for (int z : {1, 3}) {
+            QuadrupoleParams ion(1e6, 0.01, mzs[i] * z / 1000.0);
+            EXPECT_NEAR(q[i], mathieu_q(1000.0, z, ion), 1e-12);
+            EXPECT_NEAR(a[i], mathieu_a(50.0, z, ion), 1e-12);
+        }
+        EXPECT_NEAR(mz(1000.0, 1, params, q[i]), mzs[i], 1e-9);
+    }
+}
+
+TEST(MathieuVectorTest, FloatKernelsWithinFewUlpOfDouble) {
+    const QuadrupoleParams params(1.1e6, 0.005, 0.0);
+    std::vector<double> mzs;
+    for (double mz = 20.0; mz < 20000.0; mz *= 1.013) mzs.push_back(mz);
+    const std::vector<float> mzs_f(mzs.begin(), mzs.end());
+    std::vector<double> q(mzs.size()), a(mzs.size());
+    std::vector<float> q_f(mzs.size()), a_f(mzs.size());
+    mathieu_q_from_mz(750.0, params, mzs.data(), mzs.size(), q.data());
+    mathieu_a_from_mz(40.0, params, mzs.data(), mzs.size(), a.data());
+    mathieu_q_from_mz(750.0, params, mzs_f.data(), mzs_f.size(), q_f.data());
+    mathieu_a_from_mz(40.0, params, mzs_f.data(), mzs_f.size(), a_f.data());
+    // One rounding each for the input, the instrument factor and the division
+    const double bound = 3 * std::numeric_limits<float>::epsilon();
+    for (std::size_t i = 0; i < mzs.size(); ++i) {
+        EXPECT_LE(std::abs(q_f[i] - q[i]), bound * q[i]) << mzs[i];
+        EXPECT_LE(std::abs(a_f[i] - a[i]), bound * a[i]) << mzs[i];
+        const double b = beta(q[i]);
+        EXPECT_LE(std::abs(beta(q_f[i]) - b), 2 * bound * b);
+        const double f = secular_frequency(1.1e6, q[i]);
+        EXPECT_LE(std::abs(secular_frequency(1.1e6f, q_f[i]) - f), 3 * bound * f);
+    }
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
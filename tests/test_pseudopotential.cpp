@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "mathieu_lib/hill_equation.h"
+#include "mathieu_lib/pseudopotential.h"
+using namespace mathieu_lib;
+
+TEST(PseudopotentialTest, DehmeltLimitAtLowQ) {
+    const QuadrupoleParams params(1e6, 0.005, 0.5);
+    const double voltage_rf = 40.0;
+    const double voltage_dc = 0.01;
+    const double q = mathieu_q(voltage_rf, 1, params);
+    ASSERT_LT(q, 0.1);
+    const Pseudopotential well = pseudopotential(voltage_rf, voltage_dc, 1, params);
+    EXPECT_NEAR(well.depth_x, q * voltage_rf / 8.0 + voltage_dc, 1e-2 * well.depth_x);
+    EXPECT_NEAR(well.depth_y, q * voltage_rf / 8.0 - voltage_dc, 1e-2 * well.depth_y);
+    EXPECT_DOUBLE_EQ(well.adiabaticity, q);
+    EXPECT_DOUBLE_EQ(well.max_energy, well.depth_y);
+    // Doubly charged: half the m/z, twice q, the same depth per charge times z in energy
+    const Pseudopotential doubly = pseudopotential(voltage_rf, voltage_dc, 2, params);
+    EXPECT_NEAR(doubly.adiabaticity, 2.0 * q, 1e-12);
+    EXPECT_NEAR(doubly.max_energy, 2.0 * doubly.depth_y, 1e-12);
+}
+
+TEST(PseudopotentialTest, NegativeIonsSeeThePositiveWellMirrored) {
+    const QuadrupoleParams params(1e6, 0.005, 0.5);
+    const Pseudopotential cation = pseudopotential(40.0, 0.01, 1, params);
+    const Pseudopotential anion = pseudopotential(40.0, 0.01, -1, params);
+    // The DC focuses the other direction; depths and energy stay positive
+    EXPECT_GT(anion.depth_x, 0.0);
+    EXPECT_DOUBLE_EQ(anion.depth_x, cation.depth_y);
+    EXPECT_DOUBLE_EQ(anion.depth_y, cation.depth_x);
+    EXPECT_DOUBLE_EQ(anion.adiabaticity, cation.adiabaticity);
+    EXPECT_DOUBLE_EQ(anion.max_energy, cation.max_energy);
+    const Pseudopotential doubly = pseudopotential(40.0, 0.0, -2, params);
+    EXPECT_GT(doubly.max_energy, 0.0);
+    EXPECT_NEAR(doubly.max_energy, 2.0 * doubly.depth_x, 1e-12);
+}
+
+TEST(PseudopotentialTest, BetaSquaredMatchesFloquetExponent) {
+    FourierWaveform cosine;
+    cosine.cosines = {1.0};
+    const HillEquation hill(cosine);
+    for (double q : {0.1, 0.2, 0.3}) {
+        for (double a : {0.0, 0.01, 0.02}) {
+            const double exact = hill.beta(q, a);
+            EXPECT_NEAR(adiabatic_beta_squared(q, a), exact * exact, 5e-4) << q << " " << a;
+        }
+    }
+    EXPECT_LT(adiabatic_beta_squared(0.1, -0.1), 0.0);
+}
+
+TEST(PseudopotentialTest, BatchMatchesScalar) {
+    const double voltage_rf = 300.0;
+    const double voltage_dc = 0.5;
+    const std::vector<double> mzs = {50.0, 150.0, 500.0, 1500.0, 3000.0};
+    const QuadrupoleParams params(1e6, 0.005, 0.0);
+    const std::vector<double> depths = well_depth_from_mz(voltage_rf, voltage_dc, params, mzs);
+    std::vector<float> mzs_f(mzs.begin(), mzs.end());
+    std::vector<float> depths_f(mzs.size());
+    well_depth_from_mz(voltage_rf, voltage_dc, params, mzs_f.data(), mzs_f.size(),
+                       depths_f.data());
+    ASSERT_EQ(depths.size(), mzs.size());
+    for (std::size_t i = 0; i < mzs.size(); ++i) {
+        const QuadrupoleParams ion(1e6, 0.005, mzs[i] / 1000.0);
+        const Pseudopotential well = pseudopotential(voltage_rf, voltage_dc, 1, ion);
+        const double expected = std::min(well.depth_x, well.depth_y);
+        EXPECT_NEAR(depths[i], expected, 1e-9 * (1.0 + expected)) << mzs[i];
+        EXPECT_NEAR(depths_f[i], expected, 1e-4 * (1.0 + expected)) << mzs[i];
+    }
+    // The lightest ion is past q = 0.908 and must report no well
+    EXPECT_EQ(depths.front(), 0.0);
+    EXPECT_GT(depths.back(), 0.0);
+}
+
+TEST(PseudopotentialTest, MultipoleReducesToQuadrupole) {
+    const double q = 0.2;
+    const double voltage_rf = 100.0;
+    const MultipolePseudopotential quad = multipole_pseudopotential(2, voltage_rf, q, 1.0);
+    EXPECT_DOUBLE_EQ(quad.depth, q * voltage_rf / 8.0);
+    EXPECT_DOUBLE_EQ(quad.adiabaticity, q);
+    // A 22-pole is nearly field-free inside half the radius
+    const MultipolePseudopotential ring = multipole_pseudopotential(11, voltage_rf, q, 0.5);
+    EXPECT_LT(ring.depth, 1e-3 * quad.depth);
+    EXPECT_THROW(multipole_pseudopotential(1, voltage_rf, q, 1.0), std::invalid_argument);
+    EXPECT_THROW(pseudopotential(voltage_rf, 0.0, 0, QuadrupoleParams(1e6, 0.005, 0.1)),
+                 std::invalid_argument);
+}
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "mathieu_lib/mapped_file.h"
+#include "mathieu_lib/result_file.h"
+using namespace mathieu_lib;
+
+namespace {
+
+auto temp_path(const std::string& name) -> std::string { return ::testing::TempDir() + name; }
+
+auto test_columns() -> std::vector<ColumnSpec> {
+    return {{"mz", ColumnType::Float64},
+            {"charge", ColumnType::Int32},
+            {"stable", ColumnType::UInt8}};
+}
+
+}  // namespace
+
+TEST(ResultFileTest, RoundTripAcrossChunks) {
+    const std::string path = temp_path("result_roundtrip.trb");
+    {
+        ResultFileWriter writer(path, test_columns());
+        std::vector<double> mz = {100.0, 250.5, 75.25};
+        std::vector<std::int32_t> charge = {1, 2, 3};
+        std::vector<std::uint8_t> stable = {1, 0, 1};
+        writer.write_chunk({mz.data(), charge.data(), stable.data()}, 3);
+        std::vector<double> mz2 = {1000.0};
+        std::vector<std::int32_t> charge2 = {4};
+        std::vector<std::uint8_t> stable2 = {0};
+        writer.write_chunk({mz2.data(), charge2.data(), stable2.data()}, 1);
+        EXPECT_EQ(writer.rows_written(), 4u);
+    }
+    ResultFileReader reader(path);
+    EXPECT_EQ(reader.major_version(), RESULT_FILE_MAJOR_VERSION);
+    EXPECT_TRUE(reader.has_statistics());
+    ASSERT_EQ(reader.row_count(), 4u);
+    ASSERT_EQ(reader.chunk_count(), 2u);
+    ASSERT_EQ(reader.columns().size(), 3u);
+    EXPECT_EQ(reader.columns()[1].name, "charge");
+    EXPECT_EQ(reader.find_column("stable"), 2);
+    EXPECT_EQ(reader.find_column("missing"), -1);
+
+    const double* mz = reader.column_data<double>(0, 0);
+    EXPECT_DOUBLE_EQ(mz[1], 250.5);
+    EXPECT_EQ(reader.column_data<std::int32_t>(1, 1)[0], 4);
+    EXPECT_THROW(reader.column_data<double>(1, 0), std::invalid_argument);
+
+    EXPECT_EQ(reader.read_f64("mz"), (std::vector<double>{100.0, 250.5, 75.25, 1000.0}));
+    EXPECT_EQ(reader.read_i32("charge"), (std::vector<int>{1, 2, 3, 4}));
+    EXPECT_DOUBLE_EQ(reader.chunk(0).columns[0].min, 75.25);
+    EXPECT_DOUBLE_EQ(reader.chunk(0).columns[0].max, 250.5);
+    EXPECT_EQ(reader.chunk(1).first_row, 3u);
+    std::remove(path.c_str());
+}
+
+TEST(ResultFileTest, StatisticsCanBeDisabled) {
+    const std::string path = temp_path("result_nostats.trb");
+    {
+        ResultFileWriter writer(path, {{"q", ColumnType::Float64}}, false);
+        std::vector<double> q = {0.1, 0.2};
+        writer.write_chunk({q.data()}, q.size());
+    }
+    ResultFileReader reader(path);
+    EXPECT_FALSE(reader.has_statistics());
+    EXPECT_TRUE(std::isnan(reader.chunk(0).columns[0].min));
+    std::remove(path.c_str());
+}
+
+TEST(ResultFileTest, EmptyFileHasNoChunks) {
+    const std::string path = temp_path("result_empty.trb");
+    { ResultFileWriter writer(path, test_columns()); }
+    ResultFileReader reader(path);
+    EXPECT_EQ(reader.row_count(), 0u);
+    EXPECT_EQ(reader.chunk_count(), 0u);
+    EXPECT_TRUE(reader.read_f64("mz").empty());
+    std::remove(path.c_str());
+}
+
+TEST(ResultFileTest, RejectsCorruptFiles) {
+    const std::string path = temp_path("result_corrupt.trb");
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "mz,charge\n100,1\n";
+    }
+    EXPECT_THROW(ResultFileReader reader(path), std::runtime_error);
+
+    {
+        ResultFileWriter writer(path, test_columns());
+    }
+    {
+        // Bump the major version in place
+        std::fstream patch(path, std::ios::in | std::ios::out | std::ios::binary);
+        patch.seekp(8);
+        const char major[2] = {99, 0};
+        patch.write(major, 2);
+    }
+    EXPECT_THROW(ResultFileReader reader(path), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(ResultFileTest, RejectsRowCountThatWrapsTheByteSize) {
+    const std::string path = temp_path("result_wrapping_rows.trb");
+    std::uint64_t footer_offset = 0;
+    {
+        ResultFileWriter writer(path, {{"x", ColumnType::Float64}});
+        const double x = 1.0;
+        writer.write_chunk({&x}, 1);
+        writer.close();
+        std::ifstream in(path, std::ios::binary);
+        in.seekg(40);
+        in.read(reinterpret_cast<char*>(&footer_offset), sizeof(footer_offset));
+    }
+    {
+        // 2^61 rows of 8 bytes is 2^64, which wraps to 0; patch the header and chunk counts
+        const std::uint64_t rows = std::uint64_t(1) << 61;
+        std::fstream patch(path, std::ios::in | std::ios::out | std::ios::binary);
+        patch.seekp(24);
+        patch.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
+        // column count, type, name length, "x", chunk count, first row
+        patch.seekp(static_cast<std::streamoff>(footer_offset + 4 + 4 + 4 + 1 + 8 + 8));
+        patch.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
+    }
+    EXPECT_THROW(ResultFileReader reader(path), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(ResultFileTest, PreallocatedFileFilledInPlace) {
+    const std::string path = temp_path("result_prealloc.trb");
+    const std::vector<ColumnSpec> columns = test_columns();
+    const ResultFileLayout layout = create_preallocated_result_file(path, columns, 5);
+    EXPECT_EQ(layout.column_offsets, result_file_layout(columns, 5).column_offsets);
+    EXPECT_EQ(layout.column_offsets[1], RESULT_FILE_HEADER_SIZE + 5 * sizeof(double));
+    EXPECT_EQ(layout.column_offsets[2] % 8, 0u);
+    {
+        MappedFile file(path, MappedFile::Access::ReadWrite);
+        ASSERT_EQ(file.size(), layout.file_size);
+        // Two writers filling disjoint row ranges
+        const double mz_low[] = {1.0, 2.0};
+        const double mz_high[] = {3.0, 4.0, 5.0};
+        std::memcpy(file.mutable_data() + layout.column_offsets[0], mz_low, sizeof(mz_low));
+        std::memcpy(file.mutable_data() + layout.column_offsets[0] + 2 * sizeof(double), mz_high,
+                    sizeof(mz_high));
+        const std::int32_t charge = 7;
+        std::memcpy(file.mutable_data() + layout.column_offsets[1] + 4 * sizeof(charge), &charge,
+                    sizeof(charge));
+    }
+    ResultFileReader reader(path);
+    EXPECT_FALSE(reader.has_statistics());
+    ASSERT_EQ(reader.chunk_count(), 1u);
+    EXPECT_EQ(reader.read_f64("mz"), (std::vector<double>{1.0, 2.0, 3.0, 4.0, 5.0}));
+    EXPECT_EQ(reader.read_i32("charge"), (std::vector<int>{0, 0, 0, 0, 7}));
+    std::remove(path.c_str());
+}
+
+TEST(ResultFileTest, ReadOnlyMappingRejectsWrites) {
+    const std::string path = temp_path("result_readonly.trb");
+    { ResultFileWriter writer(path, test_columns()); }
+    MappedFile file(path);
+    EXPECT_FALSE(file.writable());
+    EXPECT_THROW(file.mutable_data(), std::invalid_argument);
+    std::remove(path.c_str());
+}
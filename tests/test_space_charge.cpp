@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "Constants.h"
+#include "mathieu_lib/mathieu.h"
+#include "mathieu_lib/space_charge.h"
+#include "mathieu_lib/stability.h"
+using namespace mathieu_lib;
+
+namespace {
+
+const QuadrupoleParams PARAMS(1e6, 5e-3, 1.0);  // molar mass in kg/mol: m/z 1000
+
+// Line charge of `ions` singly charged ions over `length`
+auto line_charge(double ions, double length) -> double { return ions * E_CHARGE / length; }
+
+}  // namespace
+
+TEST(SpaceChargeTest, CloudGradients) {
+    IonCloud cloud;
+    cloud.ions = 1e6;
+    cloud.size_x = cloud.size_y = 1e-3;
+    // Uniform round cloud: E_r = rho r / (2 eps0)
+    const double rho = line_charge(1e6, cloud.length) / (M_PI * 1e-6);
+    const SpaceChargeGradient uniform = space_charge_gradient(cloud);
+    EXPECT_NEAR(uniform.x, rho / (2.0 * EPSILON_0), 1e-9 * uniform.x);
+    EXPECT_DOUBLE_EQ(uniform.x, uniform.y);
+
+    // The rms-equivalent of a Gaussian of width sigma is the uniform cloud of radius 2 sigma
+    IonCloud gaussian = cloud;
+    gaussian.profile = CloudProfile::Gaussian;
+    gaussian.size_x = gaussian.size_y = 0.5e-3;
+    EXPECT_NEAR(space_charge_gradient(gaussian).x, uniform.x, 1e-9 * uniform.x);
+
+    // A flat cloud defocuses more across its narrow side; populations add
+    IonCloud flat = cloud;
+    flat.size_y = 0.25e-3;
+    const SpaceChargeGradient g = space_charge_gradient(flat);
+    EXPECT_NEAR(g.y / g.x, 4.0, 1e-12);
+    const SpaceChargeGradient both = space_charge_gradient(std::vector<IonCloud>{cloud, flat});
+    EXPECT_NEAR(both.x, uniform.x + g.x, 1e-9 * both.x);
+
+    cloud.length = 0.0;
+    EXPECT_THROW(space_charge_gradient(cloud), std::invalid_argument);
+}
+
+TEST(SpaceChargeTest, ShiftsMoveIonsOffTheApex) {
+    // m/z 1000 just inside the apex of the first stability region
+    const double voltage_rf = 0.7 / mathieu_q(1.0, 1, PARAMS);
+    const double voltage_dc = 0.228 / mathieu_a(1.0, 1, PARAMS);
+    const std::vector<double> mzs = {1000.0, 1000.0, 2000.0};
+    const SpaceChargeColumns bare =
+        space_charge_qa_from_mz(voltage_rf, voltage_dc, PARAMS, SpaceChargeGradient(), mzs);
+    EXPECT_NEAR(bare.q[0], 0.7, 1e-12);
+    EXPECT_NEAR(bare.a_x[0], 0.228, 1e-12);
+    EXPECT_EQ(bare.a_x, bare.a_y);
+    EXPECT_EQ(bare.stability[0], StabilityClass::Both);
+
+    IonCloud cloud;
+    cloud.ions = 5e7;
+    const SpaceChargeGradient gradient = space_charge_gradient(cloud);
+    const SpaceChargeColumns shifted =
+        space_charge_qa_from_mz(voltage_rf, voltage_dc, PARAMS, gradient, mzs);
+    // delta = 4 z e G / (m Omega^2)
+    const double omega_val = omega(PARAMS.frequency);
+    const double delta = 4.0 * E_CHARGE * gradient.x /
+                         (particle_mass(1.0) * omega_val * omega_val);
+    EXPECT_GT(delta, 0.01);
+    EXPECT_EQ(shifted.q, bare.q);
+    EXPECT_NEAR(shifted.a_x[0], 0.228 - delta, 1e-12);
+    EXPECT_NEAR(shifted.a_y[0], 0.228 + delta, 1e-12);
+    EXPECT_NEAR(shifted.a_y[2] - bare.a_y[2], delta / 2.0, 1e-12);  // delta goes as z / m
+    // Pushed past the y boundary above the apex
+    EXPECT_EQ(shifted.stability[0], StabilityClass::X);
+    EXPECT_EQ(shifted.stability[0], merge_stability(classify_stability(0.7, 0.228 - delta),
+                                                    classify_stability(0.7, 0.228 + delta)));
+
+    std::vector<float> mzs_f(mzs.begin(), mzs.end());
+    std::vector<StabilityClass> classes(mzs.size());
+    classify_space_charge_from_mz(voltage_rf, voltage_dc, PARAMS, gradient, mzs_f.data(),
+                                  mzs_f.size(), classes.data());
+    EXPECT_EQ(classes, shifted.stability);
+}
+
+TEST(SpaceChargeTest, GridFieldOfUniformCloud) {
+    SpaceChargeGrid grid(5e-3, 63);
+    const double radius = 2e-3;
+    const double lambda = 1e-10;  // C/m
+    // Equal-area rings of equally spaced charges
+    const int rings = 100;
+    const int per_ring = 200;
+    const double charge = lambda / (rings * per_ring);
+    grid.clear();
+    for (int k = 0; k < rings; ++k) {
+        const double r = radius * std::sqrt((k + 0.5) / rings);
+        for (int m = 0; m < per_ring; ++m) {
+            const double phi = 2.0 * M_PI * (m + 0.5 * (k % 2)) / per_ring;
+            grid.deposit(r * std::cos(phi), r * std::sin(phi), charge);
+        }
+    }
+    grid.solve();
+
+    const double gradient = lambda / (2.0 * M_PI * EPSILON_0 * radius * radius);
+    const std::vector<double> x = {1e-3, 0.0, -0.6e-3, 0.0};
+    const std::vector<double> y = {0.0, 1e-3, 0.0, 0.0};
+    std::vector<double> ex(x.size());
+    std::vector<double> ey(x.size());
+    grid.field(x.data(), y.data(), x.size(), ex.data(), ey.data());
+    EXPECT_NEAR(ex[0], gradient * 1e-3, 0.03 * gradient * 1e-3);
+    EXPECT_NEAR(ey[1], gradient * 1e-3, 0.03 * gradient * 1e-3);
+    EXPECT_NEAR(ex[2], -gradient * 0.6e-3, 0.03 * gradient * 0.6e-3);
+    EXPECT_NEAR(ex[3], 0.0, 1e-3 * gradient * 1e-3);
+    EXPECT_NEAR(ey[0], 0.0, 1e-3 * gradient * 1e-3);
+
+    EXPECT_THROW(SpaceChargeGrid(5e-3, 1), std::invalid_argument);
+}
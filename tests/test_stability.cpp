@@ -0,0 +1,399 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "mathieu_lib/boundary_lut.h"
+#include "mathieu_lib/characteristic.h"
+#include "mathieu_lib/mathieu.h"
+#include "mathieu_lib/stability.h"
+#include "mathieu_lib/stability_map.h"
+#include "mathieu_lib/stability_regions.h"
+using namespace mathieu_lib;
+
+TEST(StabilityTest, UpperBoundaryApexAndEdges) {
+    EXPECT_NEAR(upper_boundary(0.0), 0.0, 1e-12);
+    EXPECT_NEAR(upper_boundary(0.706), 0.2369, 1e-3);  // apex of the first region
+    EXPECT_LT(upper_boundary(0.3), upper_boundary(0.706));
+    EXPECT_LT(upper_boundary(MAX_Q), upper_boundary(0.706));
+}
+
+TEST(StabilityTest, IsStable) {
+    EXPECT_TRUE(is_stable(0.5, 0.0));
+    EXPECT_TRUE(is_stable(0.706, 0.2));
+    EXPECT_FALSE(is_stable(0.706, 0.25));
+    EXPECT_FALSE(is_stable(0.95, 0.0));  // beyond the q cutoff
+    EXPECT_FALSE(is_stable(0.5, -0.01));
+}
+
+TEST(StabilityTest, NearestBoundaryPointLiesOnCurve) {
+    for (double q : {0.3, 0.6, 0.706, 0.85}) {
+        for (double a : {0.0, 0.1, 0.3}) {
+            auto [q_b, a_b] = nearest_boundary_point(q, a);
+            EXPECT_NEAR(a_b, upper_boundary(q_b), 1e-9);
+            EXPECT_LE(std::hypot(q_b - q, a_b - a), std::abs(upper_boundary(q) - a) + 1e-4);
+        }
+    }
+}
+
+TEST(StabilityTest, NearestBoundaryPointOfFarOrNonFiniteQ) {
+    const double inf = std::numeric_limits<double>::infinity();
+    for (double q : {1e20, -1e20, inf, -inf}) {
+        const auto [q_b, a_b] = nearest_boundary_point(q, 0.1);
+        EXPECT_GE(q_b, 0.0) << q;
+        EXPECT_LE(q_b, MAX_Q) << q;
+        EXPECT_NEAR(a_b, upper_boundary(q_b), 1e-9) << q;
+    }
+    EXPECT_TRUE(std::isnan(nearest_boundary_point(std::nan(""), 0.1).first));
+}
+
+TEST(StabilityTest, BoundaryMarginsConsistent) {
+    const BoundaryMargins inside = boundary_margins(0.5, 0.05);
+    EXPECT_TRUE(inside.stable);
+    EXPECT_NEAR(inside.delta_a, inside.a_boundary - 0.05, 1e-12);
+    EXPECT_NEAR(inside.delta_e, std::hypot(inside.q_boundary - 0.5, inside.a_boundary - 0.05),
+                1e-12);
+    EXPECT_NEAR(inside.delta_q, std::abs(inside.q_boundary - 0.5), 1e-12);
+
+    const BoundaryMargins outside = boundary_margins(0.706, 0.3);
+    EXPECT_FALSE(outside.stable);
+    EXPECT_LT(outside.delta_a, 0.0);
+}
+
+TEST(StabilityTest, FloatBoundaryTracksDouble) {
+    for (int i = 0; i <= 2000; ++i) {
+        const double q = 0.95 * i / 2000;
+        EXPECT_NEAR(upper_boundary(static_cast<float>(q)), upper_boundary(q), 2e-7) << q;
+    }
+}
+
+TEST(StabilityTest, BatchClassifierMatchesScalar) {
+    std::vector<double> qs, as;
+    for (int i = 0; i <= 120; ++i)
+        for (int j = 0; j <= 60; ++j) {
+            qs.push_back(-0.02 + 0.95 * i / 120);
+            as.push_back(-0.01 + 0.27 * j / 60);
+        }
+    std::vector<std::uint8_t> stable(qs.size()), stable_f(qs.size());
+    is_stable(qs.data(), as.data(), qs.size(), stable.data());
+    const std::vector<float> qs_f(qs.begin(), qs.end()), as_f(as.begin(), as.end());
+    is_stable(qs_f.data(), as_f.data(), qs_f.size(), stable_f.data());
+    for (std::size_t i = 0; i < qs.size(); ++i) {
+        EXPECT_EQ(stable[i] != 0, is_stable(qs[i], as[i])) << qs[i] << "," << as[i];
+        // float may only disagree within its rounding of the boundary
+        if (stable_f[i] != stable[i]) {
+            EXPECT_LT(std::abs(as[i] - upper_boundary(qs[i])), 1e-6);
+        }
+    }
+}
+
+TEST(StabilityTest, BatchHandlesNonFiniteInputs) {
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::nan("");
+    const std::vector<double> qs = {nan, inf, -inf, 0.5, 0.5, 0.5, nan};
+    const std::vector<double> as = {0.0, 0.0, 0.0, nan, inf, -inf, nan};
+    const std::vector<float> qs_f(qs.begin(), qs.end()), as_f(as.begin(), as.end());
+    std::vector<std::uint8_t> stable(qs.size(), 1), stable_f(qs.size(), 1), trap(qs.size(), 1);
+    is_stable(qs.data(), as.data(), qs.size(), stable.data());
+    is_stable(qs_f.data(), as_f.data(), qs_f.size(), stable_f.data());
+    is_stable<double, PaulTrap3D>(qs.data(), as.data(), qs.size(), trap.data());
+    std::vector<StabilityClass> classes(qs.size());
+    classify_stability(qs.data(), as.data(), qs.size(), classes.data());
+    for (std::size_t i = 0; i < qs.size(); ++i) {
+        EXPECT_EQ(stable[i], 0) << qs[i] << "," << as[i];
+        EXPECT_EQ(stable_f[i], 0) << qs[i] << "," << as[i];
+        EXPECT_EQ(trap[i], 0) << qs[i] << "," << as[i];
+        EXPECT_EQ(stable[i] != 0, is_stable(qs[i], as[i]));
+        EXPECT_EQ(classes[i], classify_stability(qs[i], as[i]));
+    }
+    // The table lookup itself stays in range
+    EXPECT_EQ(boundary_lut_upper(nan), boundary_lut_upper(0.0));
+    EXPECT_EQ(boundary_lut_upper(inf), boundary_lut_upper(MAX_Q));
+    EXPECT_EQ(boundary_lut_upper(-inf), boundary_lut_upper(0.0));
+}
+
+TEST(StabilityTest, ClassifiesAgainstAllFourBoundaries) {
+    EXPECT_EQ(classify_stability(0.5, 0.0), StabilityClass::Both);
+    EXPECT_EQ(classify_stability(0.706, 0.2), StabilityClass::Both);
+    EXPECT_EQ(classify_stability(0.706, -0.2), StabilityClass::Both);  // mirrored lower half
+    // Above -a_0 (beta_y = 0) y is lost; below -b_1 (beta_y = 1) x is lost on the mirror side
+    EXPECT_EQ(classify_stability(0.3, 0.1), StabilityClass::X);
+    EXPECT_EQ(classify_stability(0.3, -0.1), StabilityClass::Y);
+    // Past MAX_Q b_1 < 0, so the bands separate and the q axis is unstable in both
+    EXPECT_EQ(classify_stability(1.2, 0.0), StabilityClass::None);
+    const double b1 = characteristic_b(1, 1.2);
+    EXPECT_EQ(classify_stability(1.2, b1 - 0.01), StabilityClass::X);
+    EXPECT_EQ(classify_stability(1.2, 0.01 - b1), StabilityClass::Y);
+    // Far outside every band and for NaN
+    EXPECT_EQ(classify_stability(0.5, 2.0), StabilityClass::None);
+    EXPECT_EQ(classify_stability(std::nan(""), 0.0), StabilityClass::None);
+    // Only |q| matters
+    EXPECT_EQ(classify_stability(-0.3, 0.1), StabilityClass::X);
+}
+
+TEST(StabilityTest, NonFiniteOrHugeQClassifiesAsNone) {
+    const double inf = std::numeric_limits<double>::infinity();
+    for (double q : {inf, -inf, 1e20, -1e20}) {
+        EXPECT_EQ(classify_stability(q, 0.0), StabilityClass::None) << q;
+        EXPECT_EQ((classify_stability<double, PaulTrap3D>(q, 0.0)), StabilityClass::None) << q;
+        EXPECT_EQ(classify_stability(static_cast<float>(q), 0.0f), StabilityClass::None) << q;
+    }
+}
+
+TEST(StabilityTest, ClassifierAgreesWithIsStable) {
+    for (int i = 0; i <= 200; ++i) {
+        for (int j = 0; j <= 60; ++j) {
+            const double q = 0.95 * i / 200;
+            const double a = 0.26 * j / 60;
+            ASSERT_EQ(classify_stability(q, a) == StabilityClass::Both, is_stable(q, a))
+                << q << " " << a;
+        }
+    }
+}
+
+TEST(StabilityTest, BatchClassifierMatchesScalarClassifier) {
+    std::vector<double> qs;
+    std::vector<double> as;
+    for (int i = 0; i <= 150; ++i) {
+        for (int j = 0; j <= 40; ++j) {
+            qs.push_back(-0.2 + 1.6 * i / 150);
+            as.push_back(-0.6 + 1.2 * j / 40);
+        }
+    }
+    qs.push_back(std::nan(""));
+    as.push_back(0.0);
+    std::vector<float> qf(qs.begin(), qs.end());
+    std::vector<float> af(as.begin(), as.end());
+    std::vector<StabilityClass> out(qs.size());
+    std::vector<StabilityClass> out_f(qs.size());
+    classify_stability(qs.data(), as.data(), qs.size(), out.data());
+    classify_stability(qf.data(), af.data(), qf.size(), out_f.data());
+    for (std::size_t i = 0; i < qs.size(); ++i) {
+        ASSERT_EQ(out[i], classify_stability(qs[i], as[i])) << qs[i] << " " << as[i];
+        ASSERT_EQ(out_f[i], classify_stability(qf[i], af[i])) << qf[i] << " " << af[i];
+    }
+}
+
+TEST(PaulTrapStabilityTest, BoundariesMatchExactCurves) {
+    for (int i = 0; i <= 400; ++i) {
+        const double q = PaulTrap3D::FIRST_REGION_Q_MAX * i / 400;
+        const double upper = std::min(characteristic_b(1, q), -2.0 * characteristic_a(0, q / 2));
+        const double lower = std::max(characteristic_a(0, q), -2.0 * characteristic_b(1, q / 2));
+        EXPECT_NEAR((upper_boundary<double, PaulTrap3D>(q)), upper, 1e-12) << q;
+        EXPECT_NEAR((lower_boundary<double, PaulTrap3D>(q)), lower, 1e-12) << q;
+    }
+    // Landmarks of the (q_z, a_z) diagram: apex, a_z = 0 crossing and the closing tip
+    EXPECT_NEAR((upper_boundary<double, PaulTrap3D>(0.781)), 0.150, 1e-3);
+    EXPECT_NEAR((upper_boundary<double, PaulTrap3D>(MAX_Q)), 0.0, 1e-3);
+    const double tip = PaulTrap3D::FIRST_REGION_Q_MAX;
+    EXPECT_NEAR((upper_boundary<double, PaulTrap3D>(tip)), -0.54397, 1e-5);
+    EXPECT_NEAR((upper_boundary<double, PaulTrap3D>(tip)),
+                (lower_boundary<double, PaulTrap3D>(tip)), 1e-9);
+}
+
+TEST(PaulTrapStabilityTest, IsStable) {
+    EXPECT_TRUE((is_stable<double, PaulTrap3D>(0.5, 0.0)));
+    EXPECT_TRUE((is_stable<double, PaulTrap3D>(0.781, 0.14)));
+    EXPECT_TRUE((is_stable<double, PaulTrap3D>(1.2, -0.5)));  // beyond MAX_Q at negative a_z
+    EXPECT_FALSE((is_stable<double, PaulTrap3D>(0.781, 0.16)));
+    EXPECT_FALSE((is_stable<double, PaulTrap3D>(0.5, 0.1)));  // radially unstable
+    EXPECT_FALSE((is_stable<double, PaulTrap3D>(1.4, -0.55)));
+    // Radial motion sees (q_r, a_r) = (-q_z / 2, -a_z / 2)
+    const auto [q_r, a_r] = secondary_mathieu_parameters<PaulTrap3D>(0.6, -0.1);
+    EXPECT_DOUBLE_EQ(q_r, -0.3);
+    EXPECT_DOUBLE_EQ(a_r, 0.05);
+    EXPECT_EQ((classify_stability<double, PaulTrap3D>(0.6, -0.1)), StabilityClass::Both);
+    EXPECT_EQ((classify_stability<double, PaulTrap3D>(0.5, 0.1)), StabilityClass::X);
+    EXPECT_EQ((classify_stability<double, PaulTrap3D>(0.5, -0.2)), StabilityClass::Y);
+}
+
+TEST(PaulTrapStabilityTest, ClassifierAndBatchAgreeWithIsStable) {
+    std::vector<double> qs;
+    std::vector<double> as;
+    for (int i = 0; i <= 200; ++i) {
+        for (int j = 0; j <= 80; ++j) {
+            qs.push_back(-0.1 + 1.6 * i / 200);
+            as.push_back(-0.8 + 1.0 * j / 80);
+        }
+    }
+    qs.push_back(std::nan(""));
+    as.push_back(0.0);
+    std::vector<float> qf(qs.begin(), qs.end());
+    std::vector<float> af(as.begin(), as.end());
+    std::vector<std::uint8_t> stable(qs.size());
+    std::vector<std::uint8_t> stable_f(qs.size());
+    std::vector<StabilityClass> classes(qs.size());
+    is_stable<double, PaulTrap3D>(qs.data(), as.data(), qs.size(), stable.data());
+    is_stable<float, PaulTrap3D>(qf.data(), af.data(), qf.size(), stable_f.data());
+    classify_stability<double, PaulTrap3D>(qs.data(), as.data(), qs.size(), classes.data());
+    for (std::size_t i = 0; i < qs.size(); ++i) {
+        const double q = qs[i];
+        const double a = as[i];
+        ASSERT_EQ(stable[i] != 0, (is_stable<double, PaulTrap3D>(q, a))) << q << " " << a;
+        ASSERT_EQ(stable_f[i] != 0, (is_stable<float, PaulTrap3D>(qf[i], af[i]))) << q << " " << a;
+        ASSERT_EQ(classes[i], (classify_stability<double, PaulTrap3D>(q, a))) << q << " " << a;
+        if (q >= 0.0 && q <= PaulTrap3D::FIRST_REGION_Q_MAX) {
+            ASSERT_EQ(classes[i] == StabilityClass::Both, stable[i] != 0) << q << " " << a;
+        }
+    }
+}
+
+// The tables and the interpolation are usable in constant expressions
+static_assert(boundary_lut_upper(0.0) == 0.0);
+static_assert(boundary_lut_upper(0.706) > 0.236 && boundary_lut_upper(0.706) < 0.238);
+
+TEST(BoundaryLutTest, InterpolationMatchesExactCurves) {
+    for (int i = 0; i <= 997; ++i) {
+        const double q = MAX_Q * i / 997.0;  // mostly between grid nodes
+        double minus_a0 = 0.0;
+        double b1 = 0.0;
+        boundary_lut_curves(q, minus_a0, b1);
+        ASSERT_NEAR(minus_a0, -characteristic_a(0, q), 1e-13) << q;
+        ASSERT_NEAR(b1, characteristic_b(1, q), 1e-13) << q;
+        ASSERT_NEAR(upper_boundary(q),
+                    std::max(0.0, std::min(-characteristic_a(0, q), characteristic_b(1, q))),
+                    1e-13)
+            << q;
+    }
+}
+
+TEST(BoundaryLutTest, DerivativeTablesMatchFiniteDifferences) {
+    const double h = 1e-5;
+    for (int i = 5; i < BOUNDARY_LUT_SEGMENTS; i += 97) {
+        const double q = BOUNDARY_LUT_STEP * i;
+        const BoundaryNode& node = BOUNDARY_LUT[i];
+        EXPECT_NEAR(node.minus_a0_dq,
+                    -(characteristic_a(0, q + h) - characteristic_a(0, q - h)) / (2 * h), 1e-8);
+        EXPECT_NEAR(node.b1_dq, (characteristic_b(1, q + h) - characteristic_b(1, q - h)) / (2 * h),
+                    1e-8);
+    }
+}
+
+TEST(StabilityMapTest, CellsMatchBoundaryMargins) {
+    const StabilityMapSpec spec{0.0, 0.95, 41, -0.02, 0.26, 23};
+    ThreadPool pool(3);
+    StabilityMapOptions options;
+    options.band_rows = 4;
+    options.pool = &pool;
+    const StabilityMap map = rasterize_stability(spec, options);
+    ASSERT_TRUE(map.complete);
+    ASSERT_EQ(map.margin.size(), 41u * 23u);
+    for (std::size_t row = 0; row < spec.a_cells; ++row) {
+        for (std::size_t column = 0; column < spec.q_cells; ++column) {
+            const double q = spec.cell_q(column);
+            const double a = spec.cell_a(row);
+            const BoundaryMargins margins = boundary_margins(q, a);
+            EXPECT_EQ(!std::signbit(map.at(column, row)), margins.stable) << q << "," << a;
+            EXPECT_DOUBLE_EQ(std::abs(map.at(column, row)), margins.delta_e);
+        }
+    }
+    EXPECT_DOUBLE_EQ(spec.cell_q(40), 0.95);
+    EXPECT_DOUBLE_EQ(spec.cell_a(22), 0.26);
+}
+
+TEST(StabilityMapTest, StreamsEveryBandOnce) {
+    const StabilityMapSpec spec{0.0, MAX_Q, 16, 0.0, 0.25, 37};
+    ThreadPool pool(4);
+    StabilityMapOptions options;
+    options.band_rows = 5;
+    options.pool = &pool;
+    std::vector<int> seen(spec.a_cells, 0);
+    std::vector<std::uint64_t> reports;
+    options.on_rows = [&](std::size_t first_row, std::size_t rows, const double* margins) {
+        for (std::size_t row = first_row; row < first_row + rows; ++row) ++seen[row];
+        EXPECT_FALSE(std::isnan(margins[rows * spec.q_cells - 1]));
+    };
+    options.progress = [&](std::uint64_t done, std::uint64_t total) {
+        EXPECT_EQ(total, spec.a_cells);
+        reports.push_back(done);
+    };
+    rasterize_stability(spec, options);
+    for (int count : seen) EXPECT_EQ(count, 1);
+    ASSERT_EQ(reports.size(), 8u);  // ceil(37 / 5) bands
+    for (std::size_t i = 1; i < reports.size(); ++i) EXPECT_GT(reports[i], reports[i - 1]);
+    EXPECT_EQ(reports.back(), spec.a_cells);
+}
+
+TEST(StabilityMapTest, CancelLeavesMapIncomplete) {
+    std::atomic<bool> cancel{false};
+    StabilityMapOptions options;
+    options.band_rows = 1;
+    options.cancel = &cancel;
+    options.on_rows = [&](std::size_t, std::size_t, const double*) { cancel = true; };
+    const StabilityMap map = rasterize_stability({0.0, MAX_Q, 8, 0.0, 0.25, 256}, options);
+    EXPECT_FALSE(map.complete);
+    EXPECT_TRUE(std::any_of(map.margin.begin(), map.margin.end(),
+                            [](double value) { return std::isnan(value); }));
+}
+
+TEST(StabilityMapTest, RejectsEmptyOrReversedGrid) {
+    EXPECT_THROW(rasterize_stability({0.0, 1.0, 0, 0.0, 0.2, 4}), std::invalid_argument);
+    EXPECT_THROW(rasterize_stability({1.0, 0.0, 4, 0.0, 0.2, 4}), std::invalid_argument);
+}
+
+TEST(StabilityRegionsTest, FirstRegionMatchesClassifier) {
+    StabilityRegionCache cache(1.0, 201);
+    const auto region = cache.region({0, 0});
+    ASSERT_TRUE(region);
+    ASSERT_EQ(region->spans.size(), 1u);
+    const RegionSpan& span = region->spans.front();
+    EXPECT_NEAR(span.q.front(), 0.0, 1e-12);
+    EXPECT_NEAR(span.q.back(), 0.908046, 1e-5);  // tip where b_1 reaches zero
+    for (std::size_t i = 0; i < span.q.size(); ++i) {
+        EXPECT_NEAR(span.a_upper[i], upper_boundary(std::min(span.q[i], MAX_Q)), 1e-4);
+        EXPECT_NEAR(span.a_lower[i], -span.a_upper[i], 1e-12);  // mirror symmetric
+    }
+}
+
+TEST(StabilityRegionsTest, EnumeratesHigherRegions) {
+    StabilityRegionCache cache(10.0, 1001);
+    const auto regions = cache.regions(2);
+    std::vector<std::pair<int, int>> ids;
+    for (const auto& region : regions) ids.emplace_back(region->id.x_order, region->id.y_order);
+    // Below q = 10 the islands are I, the two mirror pairs along the band edges and the
+    // classic second region (1, 1) near q = 7.5, a = 0
+    const std::vector<std::pair<int, int>> expected = {{0, 0}, {0, 1}, {0, 2}, {1, 0},
+                                                       {1, 1}, {2, 0}};
+    EXPECT_EQ(ids, expected);
+    for (const auto& region : regions) {
+        if (region->id == RegionId{1, 1}) {
+            const RegionSpan& span = region->spans.front();
+            EXPECT_GT(span.q.front(), 7.5);
+            EXPECT_LT(span.q.back(), 7.6);
+            const std::size_t mid = span.q.size() / 2;
+            const double q = span.q[mid];
+            const double a = 0.5 * (span.a_lower[mid] + span.a_upper[mid]);
+            const RegionId located = locate_stability_region(q, a, 3);
+            EXPECT_EQ(located.x_order, 1);
+            EXPECT_EQ(located.y_order, 1);
+        }
+    }
+    // Every region is kept, including the empty ones, and served from the cache afterwards
+    EXPECT_EQ(cache.cached_count(), 9u);
+    EXPECT_EQ(cache.region({1, 1}), regions[4]);
+}
+
+TEST(StabilityRegionsTest, LocatesBands) {
+    EXPECT_EQ(locate_stability_region(0.5, 0.1), (RegionId{0, 0}));
+    const RegionId x_only = locate_stability_region(0.3, 0.1, 2);
+    EXPECT_EQ(x_only.x_order, 0);
+    EXPECT_EQ(x_only.y_order, -1);
+    // On the q = 0 axis band r holds r^2 <= a <= (r+1)^2
+    EXPECT_EQ(locate_stability_region(0.0, 2.0, 3).x_order, 1);
+    EXPECT_EQ(locate_stability_region(0.0, 2.0, 0).x_order, -1);  // above max_order
+}
+
+TEST(StabilityRegionsTest, CancelledRegionsAreNotCached) {
+    StabilityRegionCache cache(5.0, 400);
+    std::atomic<bool> cancel{true};
+    StabilityRegionOptions options;
+    options.cancel = &cancel;
+    EXPECT_EQ(cache.region({0, 0}, options), nullptr);
+    EXPECT_TRUE(cache.regions(2, options).empty());
+    EXPECT_EQ(cache.cached_count(), 0u);
+    EXPECT_THROW(cache.region({-1, 0}), std::invalid_argument);
+    EXPECT_THROW(StabilityRegionCache(0.0, 10), std::invalid_argument);
+}
@@ -96,3 +96,33 @@ TEST(StabilityCalculatorTest, NormalizedStabilityMargin) {
     double margin = normalizedStabilityMargin(a, a_b, q, q_b);
     EXPECT_GE(margin, 0.0);
 }
+
+TEST(StabilityCalculatorTest, NearestBoundaryPointMatchesDenseSearch) {
+    const double points[][2] = {{0.1, 0.2}, {0.5, 0.1}, {0.7, 0.23}, {0.85, 0.05}, {0.3, 0.0}};
+    for (const auto& p : points) {
+        double q = p[0], a = p[1];
+        double best = 1e9;
+        for (double q_b = 0.0; q_b <= mathieu_lib::MAX_Q; q_b += 1e-6) {
+            double a_b = calculateUpperBoundary(q_b);
+            best = std::min(best, qSqrt((q - q_b) * (q - q_b) + (a - a_b) * (a - a_b)));
+        }
+        EXPECT_NEAR(euclideanDistance(a, q), best, 1e-6);
+    }
+}
+
+TEST(StabilityCalculatorTest, EvaluatePoint) {
+    PointMetrics inside = evaluatePoint(0.5, 0.1);
+    EXPECT_TRUE(inside.stable);
+    EXPECT_NEAR(inside.delta_a, inside.a_boundary - 0.1, 1e-12);
+    EXPECT_NEAR(inside.delta_e, euclideanDistance(0.1, 0.5), 1e-12);
+
+    EXPECT_TRUE(inside.stable_x);
+    EXPECT_TRUE(inside.stable_y);
+
+    PointMetrics outside = evaluatePoint(0.5, calculateUpperBoundary(0.5) + 0.05);
+    EXPECT_FALSE(outside.stable);
+    EXPECT_LT(outside.delta_a, 0.0);
+    EXPECT_TRUE(outside.stable_x);  // above beta_y = 0 only y is lost
+    EXPECT_FALSE(outside.stable_y);
+    EXPECT_FALSE(isStable(0.95, 0.0));
+}
@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "mathieu_lib/mathieu.h"
+#include "mathieu_lib/result_file.h"
+#include "mathieu_lib/sweep.h"
+using namespace mathieu_lib;
+
+namespace {
+
+auto small_spec() -> SweepSpec {
+    SweepSpec spec;
+    spec.frequency = {0.9e6, 1.1e6};
+    spec.quad_radius = {0.005};
+    spec.voltage_rf = {200.0, 400.0, 800.0};
+    spec.voltage_dc = {0.0, 10.0};
+    spec.charge_state = {1, 2};
+    spec.mass = {100.0, 250.0, 500.0, 1000.0, 2000.0};
+    return spec;
+}
+
+auto fresh_directory(const std::string& name) -> std::string {
+    const std::string dir = ::testing::TempDir() + name;
+    std::filesystem::remove_all(dir);
+    return dir;
+}
+
+}  // namespace
+
+TEST(SweepTest, RangeMatchesScalarKernels) {
+    const SweepSpec spec = small_spec();
+    ASSERT_EQ(spec.point_count(), 120u);
+    const SweepColumns columns = compute_sweep_range(spec, 7, 50);  // starts mid mass run
+    for (std::size_t i = 0; i < 50; ++i) {
+        const QuadrupoleParams params(columns.frequency[i], columns.quad_radius[i],
+                                      columns.mass[i]);
+        const double mass_per_charge = columns.mass[i] / columns.charge_state[i];
+        EXPECT_DOUBLE_EQ(columns.mz[i], mass_per_charge);
+        EXPECT_NEAR(columns.q[i],
+                    mathieu_q_from_mz(columns.voltage_rf[i], params, {mass_per_charge})[0],
+                    1e-12);
+        EXPECT_NEAR(columns.a[i],
+                    mathieu_a_from_mz(columns.voltage_dc[i], params, {mass_per_charge})[0],
+                    1e-12);
+    }
+    // Point 7 = frequency[0], voltage_rf[0], voltage_dc[0], charge_state[1], mass[2]
+    EXPECT_DOUBLE_EQ(columns.mass[0], 500.0);
+    EXPECT_EQ(columns.charge_state[0], 2);
+    EXPECT_THROW(compute_sweep_range(spec, 100, 21), std::invalid_argument);
+}
+
+TEST(SweepTest, ChunkCountRoundsUpWithoutWrapping) {
+    const SweepSpec spec = small_spec();
+    EXPECT_EQ(sweep_chunk_count(spec, 50), 3u);
+    EXPECT_EQ(sweep_chunk_count(spec, 120), 1u);
+    EXPECT_EQ(sweep_chunk_count(spec, std::numeric_limits<std::uint64_t>::max()), 1u);
+    EXPECT_THROW(sweep_chunk_count(spec, 0), std::invalid_argument);
+}
+
+TEST(SweepTest, ResumeSkipsFinishedChunks) {
+    const std::string dir = fresh_directory("sweep_resume");
+    const SweepSpec spec = small_spec();
+    SweepOptions options;
+    options.chunk_points = 16;
+    ThreadPool pool(3);
+    options.pool = &pool;
+    SweepSummary first = run_sweep(spec, dir, options);
+    EXPECT_EQ(first.total_chunks, 8u);
+    EXPECT_EQ(first.computed_chunks, 8u);
+    EXPECT_FALSE(first.cancelled);
+
+    std::filesystem::remove(sweep_chunk_path(dir, 2));
+    std::filesystem::remove(sweep_chunk_path(dir, 7));
+    SweepSummary second = run_sweep(spec, dir, options);
+    EXPECT_EQ(second.skipped_chunks, 6u);
+    EXPECT_EQ(second.computed_chunks, 2u);
+
+    std::uint64_t rows = 0;
+    for (std::size_t chunk = 0; chunk < second.total_chunks; ++chunk) {
+        ResultFileReader reader(sweep_chunk_path(dir, chunk));
+        rows += reader.row_count();
+    }
+    EXPECT_EQ(rows, spec.point_count());
+    ResultFileReader last(sweep_chunk_path(dir, 7));
+    EXPECT_EQ(last.row_count(), 120u - 7 * 16);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(SweepTest, DifferentSweepInSameDirectoryThrows) {
+    const std::string dir = fresh_directory("sweep_mismatch");
+    SweepOptions options;
+    options.chunk_points = 64;
+    run_sweep(small_spec(), dir, options);
+    SweepSpec other = small_spec();
+    other.voltage_rf.push_back(1600.0);
+    EXPECT_THROW(run_sweep(other, dir, options), std::runtime_error);
+    options.chunk_points = 32;
+    EXPECT_THROW(run_sweep(small_spec(), dir, options), std::runtime_error);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(SweepTest, StreamsChunksAsTheyLand) {
+    const std::string dir = fresh_directory("sweep_stream");
+    const SweepSpec spec = small_spec();
+    SweepOptions options;
+    options.chunk_points = 16;
+    ThreadPool pool(3);
+    options.pool = &pool;
+    std::vector<int> seen(spec.point_count(), 0);
+    std::uint64_t last_done = 0;
+    options.on_chunk = [&](std::uint64_t first, const SweepColumns& results) {
+        const SweepColumns expected = compute_sweep_range(spec, first, results.mass.size());
+        EXPECT_EQ(results.q, expected.q);
+        for (std::size_t i = 0; i < results.mass.size(); ++i) ++seen[first + i];
+    };
+    options.progress = [&](std::uint64_t done, std::uint64_t total) {
+        EXPECT_EQ(total, 8u);
+        EXPECT_GE(done, last_done);
+        last_done = done;
+    };
+    run_sweep(spec, dir, options);
+    for (int count : seen) EXPECT_EQ(count, 1);
+    EXPECT_EQ(last_done, 8u);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(SweepTest, CancelKeepsNothingHalfWritten) {
+    const std::string dir = fresh_directory("sweep_cancel");
+    std::atomic<bool> cancel{true};
+    SweepOptions options;
+    options.chunk_points = 16;
+    options.cancel = &cancel;
+    SweepSummary summary = run_sweep(small_spec(), dir, options);
+    EXPECT_TRUE(summary.cancelled);
+    EXPECT_EQ(summary.computed_chunks, 0u);
+    for (const auto& entry : std::filesystem::directory_iterator(dir))
+        EXPECT_NE(entry.path().extension(), ".tmp");
+    std::filesystem::remove_all(dir);
+}
+
+TEST(SweepTest, ShardsFillPreallocatedFile) {
+    const std::string path = ::testing::TempDir() + "sweep_shards.trb";
+    const SweepSpec spec = small_spec();
+    create_preallocated_result_file(path, sweep_result_columns(), spec.point_count());
+    {
+        MappedFile file(path, MappedFile::Access::ReadWrite);
+        std::uint64_t covered = 0;
+        for (unsigned shard = 0; shard < 7; ++shard) {
+            const SweepShard slice = sweep_shard(spec.point_count(), shard, 7);
+            EXPECT_EQ(slice.first, covered);
+            covered += slice.count;
+            std::uint64_t reported = 0;
+            write_sweep_range(spec, slice.first, slice.count, file,
+                              [&reported](std::uint64_t done) { reported = done; }, 5);
+            EXPECT_EQ(reported, slice.count);
+        }
+        EXPECT_EQ(covered, spec.point_count());
+    }
+    ResultFileReader reader(path);
+    const SweepColumns expected = compute_sweep_range(spec, 0, spec.point_count());
+    EXPECT_EQ(reader.read_f64("q"), expected.q);
+    EXPECT_EQ(reader.read_f64("delta_e"), expected.delta_e);
+    EXPECT_EQ(reader.read_i32("charge"),
+              std::vector<int>(expected.charge_state.begin(), expected.charge_state.end()));
+    EXPECT_THROW(sweep_shard(10, 3, 3), std::invalid_argument);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "mathieu_lib/thread_pool.h"
+using namespace mathieu_lib;
+
+TEST(ThreadPoolTest, ParallelForVisitsEveryIndexOnce) {
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> hits(100000);
+    const bool completed =
+        pool.parallel_for(0, hits.size(), [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) ++hits[i];
+        });
+    EXPECT_TRUE(completed);
+    for (const auto& hit : hits) ASSERT_EQ(hit.load(), 1);
+}
+
+TEST(ThreadPoolTest, RespectsExplicitGrain) {
+    ThreadPool pool(3);
+    std::atomic<std::size_t> largest{0};
+    ParallelForOptions options;
+    options.grain = 7;
+    pool.parallel_for(10, 1000, [&](std::size_t first, std::size_t last) {
+        std::size_t size = last - first;
+        std::size_t seen = largest.load();
+        while (size > seen && !largest.compare_exchange_weak(seen, size)) {
+        }
+    }, options);
+    EXPECT_LE(largest.load(), 7u);
+}
+
+TEST(ThreadPoolTest, SkewedWorkIsShared) {
+    ThreadPool pool(4);
+    std::vector<std::thread::id> owner(64);
+    // Later indices are far more expensive, so one thread cannot keep the whole tail
+    pool.parallel_for(0, owner.size(), [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            volatile double sink = 0;
+            for (std::size_t k = 0; k < i * 20000; ++k) sink = sink + 1.0;
+            owner[i] = std::this_thread::get_id();
+        }
+    }, ParallelForOptions{1, nullptr});
+    std::vector<std::thread::id> distinct(owner.begin() + 32, owner.end());
+    std::sort(distinct.begin(), distinct.end());
+    distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+    EXPECT_GT(distinct.size(), 1u);
+}
+
+TEST(ThreadPoolTest, NestedLoopsComplete) {
+    ThreadPool pool(2);
+    std::atomic<long> total{0};
+    pool.parallel_for(0, 16, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i)
+            pool.parallel_for(0, 1000, [&](std::size_t a, std::size_t b) {
+                total += static_cast<long>(b - a);
+            });
+    }, ParallelForOptions{1, nullptr});
+    EXPECT_EQ(total.load(), 16000);
+}
+
+TEST(ThreadPoolTest, ExceptionsPropagate) {
+    ThreadPool pool(4);
+    EXPECT_THROW(pool.parallel_for(0, 1000,
+                                   [](std::size_t first, std::size_t last) {
+                                       if (first <= 500 && 500 < last)
+                                           throw std::runtime_error("boom");
+                                   }),
+                 std::runtime_error);
+    // The pool is still usable afterwards
+    EXPECT_EQ(pool.async([]() { return 42; }).get(), 42);
+}
+
+TEST(ThreadPoolTest, CancellationStopsEarly) {
+    ThreadPool pool(2);
+    CancellationToken token;
+    std::atomic<std::size_t> processed{0};
+    ParallelForOptions options;
+    options.grain = 1;
+    options.cancel = token.flag();
+    const bool completed = pool.parallel_for(0, 100000, [&](std::size_t first, std::size_t last) {
+        processed += last - first;
+        if (processed > 100)
+            token.cancel();
+    }, options);
+    EXPECT_FALSE(completed);
+    EXPECT_LT(processed.load(), 100000u);
+    token.reset();
+    EXPECT_FALSE(token.cancelled());
+}
+
+TEST(ThreadPoolTest, GlobalPoolIsShared) {
+    ThreadPool& pool = ThreadPool::global();
+    EXPECT_EQ(&pool, &ThreadPool::global());
+    EXPECT_GE(pool.thread_count(), 1u);
+    EXPECT_FALSE(ThreadPool::set_global_thread_count(3));  // already running
+    std::vector<int> values(1000);
+    std::iota(values.begin(), values.end(), 0);
+    std::atomic<long> sum{0};
+    pool.parallel_for(0, values.size(), [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) sum += values[i];
+    });
+    EXPECT_EQ(sum.load(), 999 * 1000 / 2);
+}
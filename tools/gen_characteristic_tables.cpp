@@ -0,0 +1,128 @@
+/**
+ * @file gen_characteristic_tables.cpp
+ * @brief Generates mathieu_lib/include/mathieu_lib/characteristic_tables.h.
+ *
+ * Fits a_0(q) and b_1(q) on [0, q_max] with piecewise Chebyshev interpolants through the
+ * Chebyshev nodes of each piece, using the exact Sturm-bisection solver, then measures the
+ * worst error on a dense grid and records it in the generated header. Fails if the error
+ * exceeds the requested bound.
+ *
+ * Usage: gen_characteristic_tables OUTPUT [q_max pieces degree bound]
+ * The defaults, 16 16 15 1e-13, reproduce the checked-in tables.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+#include "mathieu_lib/characteristic.h"
+
+namespace {
+
+constexpr int CHECK_POINTS = 200000;
+
+struct Table {
+    std::vector<std::vector<double>> pieces;
+    double max_error = 0.0;
+};
+
+auto fit(const std::function<double(double)>& exact, double q_max, int pieces, int degree)
+    -> Table {
+    const double pi = std::acos(-1.0);
+    const int nodes = degree + 1;
+    const double width = q_max / pieces;
+    Table table;
+    for (int p = 0; p < pieces; ++p) {
+        std::vector<double> values(nodes);
+        for (int k = 0; k < nodes; ++k) {
+            const double t = std::cos(pi * (k + 0.5) / nodes);
+            values[k] = exact(width * (p + 0.5 * (t + 1.0)));
+        }
+        std::vector<double> c(nodes);
+        for (int j = 0; j < nodes; ++j) {
+            double sum = 0.0;
+            for (int k = 0; k < nodes; ++k) sum += values[k] * std::cos(pi * j * (k + 0.5) / nodes);
+            c[j] = (j == 0 ? 1.0 : 2.0) * sum / nodes;
+        }
+        table.pieces.push_back(c);
+    }
+    for (int i = 0; i <= CHECK_POINTS; ++i) {
+        const double q = q_max * i / CHECK_POINTS;
+        const int p = std::min(static_cast<int>(q / width), pieces - 1);
+        const double t = 2.0 * (q - width * p) / width - 1.0;
+        double b1 = 0.0, b2 = 0.0;
+        for (int j = degree; j >= 1; --j) {
+            const double b0 = 2.0 * t * b1 - b2 + table.pieces[p][j];
+            b2 = b1;
+            b1 = b0;
+        }
+        const double value = t * b1 - b2 + table.pieces[p][0];
+        table.max_error = std::max(table.max_error, std::abs(value - exact(q)));
+    }
+    return table;
+}
+
+void write_table(std::FILE* out, const char* name, const Table& table) {
+    std::fprintf(out, "constexpr double %s[CHEBYSHEV_PIECES][CHEBYSHEV_DEGREE + 1] = {\n", name);
+    for (const auto& piece : table.pieces) {
+        std::fprintf(out, "    {");
+        for (std::size_t j = 0; j < piece.size(); ++j)
+            std::fprintf(out, "%s%.17g", j == 0 ? "" : (j % 3 == 0 ? ",\n     " : ", "), piece[j]);
+        std::fprintf(out, "},\n");
+    }
+    std::fprintf(out, "};\n");
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr,
+                     "Usage: gen_characteristic_tables OUTPUT [q_max pieces degree bound]\n");
+        return 1;
+    }
+    const double q_max = argc > 2 ? std::atof(argv[2]) : 16.0;
+    const int pieces = argc > 3 ? std::atoi(argv[3]) : 16;
+    const int degree = argc > 4 ? std::atoi(argv[4]) : 15;
+    const double bound = argc > 5 ? std::atof(argv[5]) : 1e-13;
+
+    const Table a0 = fit([](double q) { return mathieu_lib::characteristic_a(0, q); }, q_max,
+                         pieces, degree);
+    const Table b1 = fit([](double q) { return mathieu_lib::characteristic_b(1, q); }, q_max,
+                         pieces, degree);
+    std::fprintf(stderr, "a0 max error %.3g, b1 max error %.3g\n", a0.max_error, b1.max_error);
+    if (a0.max_error > bound || b1.max_error > bound) {
+        std::fprintf(stderr, "Error exceeds the bound %.3g; use more pieces or a higher degree\n",
+                     bound);
+        return 1;
+    }
+
+    std::FILE* out = std::fopen(argv[1], "w");
+    if (!out) {
+        std::perror(argv[1]);
+        return 1;
+    }
+    std::fprintf(out,
+                 "#pragma once\n\n"
+                 "// Generated by tools/gen_characteristic_tables from the exact Sturm-bisection\n"
+                 "// solver (characteristic_a/characteristic_b); do not edit by hand.\n"
+                 "//\n"
+                 "// Piecewise Chebyshev series of a_0(q) and b_1(q) on [0, CHEBYSHEV_Q_MAX], one\n"
+                 "// row per piece of equal width, evaluated on t in [-1, 1] across the piece.\n"
+                 "// Max abs error over %d points: a_0 %.2g, b_1 %.2g (bound %.2g).\n\n"
+                 "namespace mathieu_lib {\n\n"
+                 "constexpr double CHEBYSHEV_Q_MAX = %.17g;\n"
+                 "constexpr int CHEBYSHEV_PIECES = %d;\n"
+                 "constexpr int CHEBYSHEV_DEGREE = %d;\n"
+                 "constexpr double CHEBYSHEV_ERROR_BOUND = %.2g;\n\n",
+                 CHECK_POINTS + 1, a0.max_error, b1.max_error, bound, q_max, pieces, degree,
+                 bound);
+    write_table(out, "CHEBYSHEV_A0", a0);
+    std::fprintf(out, "\n");
+    write_table(out, "CHEBYSHEV_B1", b1);
+    std::fprintf(out, "\n}  // namespace mathieu_lib\n");
+    std::fclose(out);
+    return 0;
+}